@@ -0,0 +1,172 @@
+/**
+ * CacheSystem benchmark: sharded index-linked LRU vs. the previous single
+ * mutex shared_ptr LRU, cache-aside workload on 1-8 threads.
+ *
+ *   g++ -O2 -std=c++17 -pthread -Iinclude bench/cache_system_bench.cpp src/cache_system.cpp src/disk_cache.cpp src/cache_policy.cpp src/cache_trace.cpp
+ *   ./a.out [ops_per_thread] [max_threads]
+ *
+ * Each thread draws keys from a Zipf(0.99) distribution over 4x the cache
+ * capacity, calls get(), and put()s the value on a miss.
+ */
+
+#include "cache_system.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+// The cache as it was before this change: shared_ptr-linked LRU nodes, one
+// mutex, std::string keys.
+class SharedPtrCacheSystem {
+public:
+    explicit SharedPtrCacheSystem(size_t max_size) : max_size_(max_size) {
+        head_ = std::make_shared<CacheNode>();
+        tail_ = std::make_shared<CacheNode>();
+        head_->next = tail_;
+        tail_->prev = head_;
+    }
+
+    bool get(const std::string& key, std::string& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_map_.find(key);
+        if (it == cache_map_.end()) {
+            misses_++;
+            return false;
+        }
+        auto node = it->second;
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->next = head_->next;
+        node->prev = head_;
+        head_->next->prev = node;
+        head_->next = node;
+        value = node->value;
+        hits_++;
+        return true;
+    }
+
+    void put(const std::string& key, const std::string& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_map_.find(key);
+        if (it != cache_map_.end()) {
+            it->second->value = value;
+            it->second->timestamp = std::chrono::high_resolution_clock::now();
+            return;
+        }
+        if (cache_map_.size() >= max_size_) {
+            auto lru = tail_->prev;
+            lru->prev->next = tail_;
+            tail_->prev = lru->prev;
+            cache_map_.erase(lru->key);
+        }
+        auto node = std::make_shared<CacheNode>();
+        node->key = key;
+        node->value = value;
+        node->timestamp = std::chrono::high_resolution_clock::now();
+        node->next = head_->next;
+        node->prev = head_;
+        head_->next->prev = node;
+        head_->next = node;
+        cache_map_[key] = node;
+    }
+
+    double get_hit_rate() const {
+        uint64_t total = hits_ + misses_;
+        if (total == 0) return 0.0;
+        return static_cast<double>(hits_) / total;
+    }
+
+private:
+    struct CacheNode {
+        std::string key;
+        std::string value;
+        std::chrono::high_resolution_clock::time_point timestamp;
+        std::shared_ptr<CacheNode> prev;
+        std::shared_ptr<CacheNode> next;
+    };
+
+    size_t max_size_;
+    std::unordered_map<std::string, std::shared_ptr<CacheNode>> cache_map_;
+    std::shared_ptr<CacheNode> head_;
+    std::shared_ptr<CacheNode> tail_;
+    std::mutex mutex_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+constexpr size_t CAPACITY = 1000;
+constexpr size_t KEY_SPACE = CAPACITY * 4;
+
+std::vector<uint32_t> zipf_stream(size_t count, uint32_t seed) {
+    std::vector<double> cdf(KEY_SPACE);
+    double sum = 0.0;
+    for (size_t i = 0; i < KEY_SPACE; ++i) {
+        sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.99);
+        cdf[i] = sum;
+    }
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<uint32_t> stream(count);
+    for (auto& key : stream) {
+        key = static_cast<uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+    }
+    return stream;
+}
+
+template<typename Cache>
+double run(Cache& cache, const std::vector<std::string>& keys, const std::vector<std::vector<uint32_t>>& streams,
+           size_t threads) {
+    const std::string payload(64, 'x');
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::string value;
+            for (uint32_t key : streams[t]) {
+                if (!cache.get(keys[key], value)) {
+                    cache.put(keys[key], payload);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t ops = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 500000;
+    const size_t max_threads = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 8;
+
+    std::vector<std::string> keys(KEY_SPACE);
+    for (size_t i = 0; i < KEY_SPACE; ++i) keys[i] = "assets/textures/character_" + std::to_string(i) + ".dds";
+    std::vector<std::vector<uint32_t>> streams;
+    for (size_t t = 0; t < max_threads; ++t) streams.push_back(zipf_stream(ops, static_cast<uint32_t>(t + 1)));
+
+    std::printf("capacity %zu, key space %zu, %zu ops/thread\n", CAPACITY, KEY_SPACE, ops);
+    std::printf("%-8s %14s %14s %9s %9s %8s\n", "threads", "old ops/s", "new ops/s", "old hit", "new hit", "speedup");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        SharedPtrCacheSystem old_cache(CAPACITY);
+        CacheSystem new_cache(CAPACITY);
+        const double old_s = run(old_cache, keys, streams, threads);
+        const double new_s = run(new_cache, keys, streams, threads);
+        const double total = static_cast<double>(ops * threads);
+        std::printf("%-8zu %14.0f %14.0f %8.1f%% %8.1f%% %7.2fx\n", threads, total / old_s, total / new_s,
+                    old_cache.get_hit_rate() * 100.0, new_cache.get_hit_rate() * 100.0, old_s / new_s);
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * ECS iteration benchmark: archetype chunks vs. the previous per-entity
+ * std::unordered_map<std::string, void*> component layout.
+ *
+ *   g++ -O2 -std=c++17 -pthread -Iinclude bench/ecs_bench.cpp src/ecs.cpp src/slab_allocator.cpp
+ *   ./a.out [frames]
+ *
+ * Every entity has a transform; half also have a velocity and a quarter a
+ * combat state, interleaved so the old layout cannot skip ahead. Each frame
+ * integrates position += velocity * dt over the entities that have a
+ * velocity, then drains health over those with combat state: the old path
+ * looks both up by name on every entity, the ECS runs cached queries.
+ */
+
+#include "ecs.h"
+#include "performance_engine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+struct CombatComponent {
+    static constexpr ComponentId COMPONENT_ID = 2;
+
+    float health;
+    uint32_t state;
+};
+
+// Entity as it was before this change.
+struct MapEntity {
+    uint32_t id = 0;
+    Transform transform;
+    bool active = true;
+    uint32_t type = 0;
+    std::unordered_map<std::string, void*> components;
+};
+
+struct MapWorld {
+    std::vector<MapEntity> entities;
+    std::vector<std::unique_ptr<Vector3D>> velocities;
+    std::vector<std::unique_ptr<CombatComponent>> combat;
+
+    explicit MapWorld(size_t count) {
+        entities.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            entities[i].id = static_cast<uint32_t>(i);
+            if (i % 2 == 0) {
+                velocities.push_back(std::make_unique<Vector3D>(1.0f, 0.5f, 0.25f));
+                entities[i].components["velocity"] = velocities.back().get();
+            }
+            if (i % 4 == 0) {
+                combat.push_back(std::make_unique<CombatComponent>(CombatComponent{100.0f, 0}));
+                entities[i].components["combat"] = combat.back().get();
+            }
+        }
+    }
+
+    void frame(float dt) {
+        for (MapEntity& entity : entities) {
+            if (!entity.active) continue;
+            auto it = entity.components.find("velocity");
+            if (it != entity.components.end()) {
+                const Vector3D& velocity = *static_cast<Vector3D*>(it->second);
+                entity.transform.position = entity.transform.position + velocity * dt;
+            }
+        }
+        for (MapEntity& entity : entities) {
+            auto it = entity.components.find("combat");
+            if (it != entity.components.end()) static_cast<CombatComponent*>(it->second)->health -= dt;
+        }
+    }
+
+    float checksum() const {
+        float sum = 0.0f;
+        for (const MapEntity& entity : entities) sum += entity.transform.position.x;
+        return sum;
+    }
+};
+
+struct EcsBenchWorld {
+    EcsWorld world;
+
+    explicit EcsBenchWorld(size_t count) : world(count) {
+        for (size_t i = 0; i < count; ++i) {
+            Entity entity;
+            entity.id = static_cast<uint32_t>(i);
+            entity.active = true;
+            const SlotHandle handle = world.create(entity);
+            if (i % 2 == 0) world.add(handle, VelocityComponent{Vector3D(1.0f, 0.5f, 0.25f)});
+            if (i % 4 == 0) world.add(handle, CombatComponent{100.0f, 0});
+        }
+    }
+
+    void frame(float dt) {
+        world.each<Entity, VelocityComponent>([dt](Entity& entity, VelocityComponent& velocity) {
+            if (entity.active) entity.transform.position = entity.transform.position + velocity.linear * dt;
+        });
+        world.each<CombatComponent>([dt](CombatComponent& combat) { combat.health -= dt; });
+    }
+
+    float checksum() {
+        float sum = 0.0f;
+        world.each<Entity>([&sum](const Entity& entity) { sum += entity.transform.position.x; });
+        return sum;
+    }
+};
+
+template<typename World>
+double time_frames(World& world, size_t frames) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames; ++i) world.frame(1.0f / 60.0f);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200;
+
+    std::printf("%-10s %14s %14s %10s %12s\n", "entities", "map us/frame", "ecs us/frame", "speedup", "archetypes");
+    for (size_t count : {MAX_ENTITIES, MAX_ENTITIES * 10}) {
+        MapWorld map_world(count);
+        EcsBenchWorld ecs_world(count);
+        const double map_us = time_frames(map_world, frames);
+        const double ecs_us = time_frames(ecs_world, frames);
+        if (map_world.checksum() != ecs_world.checksum()) {
+            std::printf("checksum mismatch\n");
+            return 1;
+        }
+        std::printf("%-10zu %14.1f %14.1f %9.1fx %12zu\n", count, map_us, ecs_us, map_us / ecs_us,
+                    ecs_world.world.get_archetype_count());
+    }
+    return 0;
+}
@@ -0,0 +1,250 @@
+/**
+ * Motion input benchmark: a compiled MotionAutomaton vs. matching every
+ * command on its own each frame.
+ *
+ *   g++ -O2 -std=c++17 -Iinclude bench/motion_input_bench.cpp src/motion_input.cpp
+ *   ./a.out [frames]
+ *
+ * Move lists of 24 to 240 commands are built from the usual motions
+ * (quarter and half circles, dragon punches, doubled motions, 360s, dashes,
+ * back and down charges) times every button, strength and chord. A player
+ * alternates between performing random commands, a few frames on each
+ * step, and walking, jumping and pressing normals. Rows report the states
+ * and transitions the automaton built and its table size, the time to
+ * compile the list, the cost per input frame and the share of frames that
+ * had to work out a new transition, first on a fresh automaton and then on
+ * new input against the table the first pass left, the cost per frame of a
+ * matcher that tests every step of every command, and how many commands
+ * fired. Both must fire the same command on every frame.
+ */
+
+#include "motion_input.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+const char* const MOTIONS[] = {
+    "236", "214", "623", "421", "41236", "63214", "236236", "214214", "[4]6", "[2]8",
+    "656", "454", "28", "2369", "63214789", "6321478", "4123", "3214", "1236", "6236",
+    "4136", "2626", "4646", "6246", "2323", "[4]64", "[2]82", "22", "88", "8426",
+};
+const char* const BUTTONS[] = {"LP", "MP", "HP", "LK", "MK", "HK", "LP+LK", "HP+HK"};
+constexpr uint16_t NO_AGE = UINT16_MAX;
+
+// Progress through each command kept separately: every step of every
+// command is tested against every frame, and the ages of matched prefixes
+// kept per command.
+class NaiveMatcher {
+public:
+    explicit NaiveMatcher(const std::vector<MotionCommand>& commands) : commands_(commands) {
+        for (const MotionCommand& command : commands_) {
+            ages_.emplace_back(command.steps.size(), NO_AGE);
+            for (const MotionStep& step : command.steps) {
+                if (step.charge_frames) charges_.push_back({step.directions, step.charge_frames, 0});
+                matches_.push_back(false);
+                fulls_.push_back(false);
+            }
+        }
+    }
+
+    uint32_t step(const MotionInput& input) {
+        static const uint8_t mirrored[10] = {5, 3, 2, 1, 6, 5, 4, 9, 8, 7};
+        const uint8_t direction = input.facing_left ? mirrored[input.direction] : input.direction;
+        const uint8_t pressed = input.buttons & ~held_;
+        held_ = input.buttons;
+        for (Charge& charge : charges_) {
+            charge.held = (charge.directions & motion_direction(direction)) ? charge.held + 1 : 0;
+        }
+
+        // What every step makes of this frame. A new direction is a new
+        // input, and so is a press or a charge filling or emptying.
+        bool changed = first_ || pressed || direction != direction_;
+        first_ = false;
+        direction_ = direction;
+        size_t index = 0, charge = 0;
+        for (const MotionCommand& command : commands_) {
+            for (const MotionStep& step : command.steps) {
+                const bool stick = step.directions & motion_direction(direction);
+                const bool full = !step.charge_frames || charges_[charge++].held >= step.charge_frames;
+                changed |= fulls_[index] != full;
+                fulls_[index] = full;
+                matches_[index++] = stick && full &&
+                                    (!step.buttons || ((pressed & step.buttons) &&
+                                                       (!step.chord || (held_ & step.buttons) == step.buttons)));
+            }
+        }
+        if (!changed) {
+            if (held_frames_ >= MOTION_TIMEOUT_FRAMES || ++held_frames_ != MOTION_TIMEOUT_FRAMES) {
+                return NO_MOTION_COMMAND;
+            }
+            for (std::vector<uint16_t>& ages : ages_) {
+                for (uint16_t& age : ages) age = age == 0 ? 0 : NO_AGE;
+            }
+            return NO_MOTION_COMMAND;
+        }
+        held_frames_ = 1;
+
+        uint32_t fired = NO_MOTION_COMMAND;
+        index = 0;
+        for (size_t c = 0; c < commands_.size(); ++c) {
+            const std::vector<MotionStep>& steps = commands_[c].steps;
+            std::vector<uint16_t>& ages = ages_[c];
+            for (size_t s = steps.size(); s-- > 0;) {
+                const uint16_t old = ages[s];
+                const bool after = s == 0 || (ages[s - 1] != NO_AGE && ages[s - 1] + 1 <= steps[s].window);
+                const uint32_t expiry = s + 1 < steps.size() ? steps[s + 1].window : 1;
+                ages[s] = old != NO_AGE && old + 1u <= expiry ? old + 1 : NO_AGE;
+                if (!after || !matches_[index + s]) continue;
+                ages[s] = 0;
+                if (s + 1 == steps.size() && old != 0 && outranks(c, fired)) fired = static_cast<uint32_t>(c);
+            }
+            index += steps.size();
+        }
+        return fired;
+    }
+
+private:
+    struct Charge {
+        uint16_t directions;
+        uint8_t frames;
+        uint32_t held;
+    };
+
+    bool outranks(size_t a, uint32_t b) const {
+        if (b == NO_MOTION_COMMAND) return true;
+        if (commands_[a].priority != commands_[b].priority) return commands_[a].priority > commands_[b].priority;
+        return commands_[a].steps.size() > commands_[b].steps.size();
+    }
+
+    std::vector<MotionCommand> commands_;
+    std::vector<std::vector<uint16_t>> ages_;
+    std::vector<Charge> charges_;
+    std::vector<bool> matches_;
+    std::vector<bool> fulls_;
+    bool first_ = true;
+    uint8_t direction_ = 0;
+    uint16_t held_frames_ = 0;
+    uint8_t held_ = 0;
+};
+
+// Frames that perform random commands from the list, with mashing between.
+std::vector<MotionInput> make_inputs(const std::vector<MotionCommand>& commands, size_t frames, std::mt19937& rng) {
+    std::vector<MotionInput> inputs;
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(commands.size()) - 1);
+    std::uniform_int_distribution<int> hold(1, 4);
+    std::uniform_int_distribution<int> direction(1, 9);
+    std::uniform_int_distribution<int> button(0, 5);
+    std::bernoulli_distribution perform(0.3), press(0.3), turn(0.05);
+    bool facing_left = false;
+    while (inputs.size() < frames) {
+        if (turn(rng)) facing_left = !facing_left;
+        if (!perform(rng)) {
+            // Walking, crouching, jumping and normals between specials
+            MotionInput input;
+            input.direction = static_cast<uint8_t>(direction(rng));
+            input.facing_left = facing_left;
+            if (press(rng)) {
+                input.buttons = static_cast<uint8_t>(1u << button(rng));
+                inputs.push_back(input);
+                input.buttons = 0;
+            }
+            for (int i = hold(rng) * 3; i > 0; --i) inputs.push_back(input);
+            continue;
+        }
+        for (const MotionStep& step : commands[pick(rng)].steps) {
+            uint8_t numpad = 1;
+            while (!(step.directions & motion_direction(numpad))) ++numpad;
+            // Mirrored on screen when facing left
+            if (facing_left && numpad % 3 == 1) numpad = static_cast<uint8_t>(numpad + 2);
+            else if (facing_left && numpad % 3 == 0) numpad = static_cast<uint8_t>(numpad - 2);
+            MotionInput input;
+            input.direction = numpad;
+            input.facing_left = facing_left;
+            int frames_held = step.charge_frames ? step.charge_frames + hold(rng) : hold(rng);
+            if (step.buttons) {
+                // Release first so the press is new
+                inputs.push_back(input);
+                input.buttons = step.buttons & static_cast<uint8_t>(step.chord ? 0x3F : step.buttons & -step.buttons);
+                frames_held = 1;
+            }
+            for (int i = 0; i < frames_held; ++i) inputs.push_back(input);
+        }
+    }
+    inputs.resize(frames);
+    return inputs;
+}
+
+double ms_between(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::mt19937 rng(50);
+
+    std::vector<MotionCommand> all;
+    for (const char* motion : MOTIONS) {
+        for (const char* button : BUTTONS) {
+            const std::string notation = std::string(motion) + (motion[0] == '[' ? "+" : "") + button;
+            all.push_back(parse_motion_command(static_cast<uint32_t>(all.size()), notation));
+        }
+    }
+
+    std::printf("%-8s %7s %7s %8s %10s %8s %7s %8s %7s %9s %8s %6s\n", "commands", "states", "trans", "table KB",
+                "compile ms", "cold ns", "miss %", "warm ns", "miss %", "naive ns", "speedup", "fired");
+    for (size_t count : {size_t(24), size_t(96), size_t(240)}) {
+        // Spread over the motions, so small lists still have every kind
+        std::vector<MotionCommand> commands;
+        for (size_t i = 0; i < count; ++i) commands.push_back(all[i * all.size() / count]);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        MotionAutomaton automaton(commands);
+        const auto t1 = std::chrono::steady_clock::now();
+
+        // The first pass builds the table as it goes; the second plays new
+        // input against what the first left
+        double dfa_ms[2] = {}, naive_ms = 0.0;
+        uint64_t expansions[2] = {};
+        size_t fired = 0;
+        std::vector<uint32_t> recognized(frames);
+        for (int pass = 0; pass < 2; ++pass) {
+            const std::vector<MotionInput> inputs = make_inputs(commands, frames, rng);
+            const uint64_t expansions_before = automaton.get_stats().expansions;
+            MotionReader reader;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames; ++i) recognized[i] = automaton.step(reader, inputs[i]);
+            dfa_ms[pass] = ms_between(start, std::chrono::steady_clock::now());
+            expansions[pass] = automaton.get_stats().expansions - expansions_before;
+
+            NaiveMatcher naive(commands);
+            const auto naive_start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames; ++i) {
+                const uint32_t expected = naive.step(inputs[i]);
+                if (recognized[i] != expected) {
+                    std::printf("mismatch at frame %zu: %u vs %u\n", i, recognized[i], expected);
+                    return 1;
+                }
+                fired += expected != NO_MOTION_COMMAND;
+            }
+            naive_ms += ms_between(naive_start, std::chrono::steady_clock::now());
+        }
+        naive_ms /= 2;
+
+        const MotionAutomaton::Stats stats = automaton.get_stats();
+        std::printf("%-8zu %7zu %7zu %8.0f %10.2f %8.1f %7.2f %8.1f %7.2f %9.1f %7.1fx %6zu\n", count, stats.states,
+                    stats.transitions, stats.table_bytes / 1024.0, ms_between(t0, t1), 1e6 * dfa_ms[0] / frames,
+                    100.0 * expansions[0] / frames, 1e6 * dfa_ms[1] / frames, 100.0 * expansions[1] / frames,
+                    1e6 * naive_ms / frames, naive_ms / dfa_ms[1], fired);
+    }
+    return 0;
+}
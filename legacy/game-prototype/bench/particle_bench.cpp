@@ -0,0 +1,177 @@
+/**
+ * Particle benchmark: SoA ParticleSystem update vs. an array-of-structs
+ * particle loop with erase-based removal and a per-frame position copy.
+ *
+ *   g++ -O2 -std=c++17 -pthread -Iinclude bench/particle_bench.cpp src/particle_system.cpp \
+ *       src/batch_math.cpp src/thread_pool.cpp src/memory_pool.cpp
+ *   ./a.out [frames]
+ *
+ * Emitters are tuned so the live count holds near the target (spawn rate
+ * = target / lifetime, with lifetime jitter so particles die every frame).
+ * Each row reports emit/simulate/compact time per frame, million particle
+ * updates per second and heap allocations per frame after warm-up. The AoS
+ * column is the same simulation over a vector of structs, removing dead
+ * particles with erase(remove_if) and copying positions into a
+ * std::vector<Vector3D> for the renderer, as draw_particles() used to take.
+ * 1 thread runs without a pool.
+ */
+
+#include "particle_system.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+
+constexpr float DT = 1.0f / 60.0f;
+constexpr size_t EMITTERS = 64;
+constexpr float LIFETIME = 2.0f;
+constexpr float LIFETIME_SPREAD = 0.5f;
+
+ParticleEmitterDesc emitter_desc(size_t index, size_t target) {
+    ParticleEmitterDesc desc;
+    desc.position[0] = static_cast<float>(index % 8) * 10.0f;
+    desc.position[2] = static_cast<float>(index / 8) * 10.0f;
+    desc.velocity[1] = 5.0f;
+    desc.velocity_spread[0] = desc.velocity_spread[1] = desc.velocity_spread[2] = 2.0f;
+    desc.start_color[0] = 1.0f; desc.start_color[1] = 0.6f; desc.start_color[2] = 0.1f;
+    desc.end_color[0] = 0.2f; desc.end_color[1] = 0.2f; desc.end_color[2] = 0.2f; desc.end_color[3] = 0.0f;
+    desc.lifetime = LIFETIME;
+    desc.lifetime_spread = LIFETIME_SPREAD;
+    desc.rate = static_cast<float>(target) / EMITTERS / LIFETIME;
+    return desc;
+}
+
+// The AoS baseline: one struct per particle, the same math per element.
+struct AosParticle {
+    float position[3];
+    float velocity[3];
+    float color[4];
+    float fade[4];
+    float life;
+    float gravity_scale;
+};
+
+struct Vec3 {
+    float x, y, z;
+};
+
+struct AosSystem {
+    std::vector<AosParticle> particles;
+    std::vector<float> pending;
+    std::mt19937 rng{1};
+    size_t drawn = 0;
+
+    void update(const std::vector<ParticleEmitterDesc>& emitters) {
+        std::uniform_real_distribution<float> jitter(-1.0f, 1.0f);
+        pending.resize(emitters.size());
+        for (size_t e = 0; e < emitters.size(); ++e) {
+            const ParticleEmitterDesc& desc = emitters[e];
+            pending[e] += desc.rate * DT;
+            for (; pending[e] >= 1.0f; pending[e] -= 1.0f) {
+                AosParticle p;
+                const float lifetime = desc.lifetime + desc.lifetime_spread * jitter(rng);
+                for (int axis = 0; axis < 3; ++axis) {
+                    p.position[axis] = desc.position[axis];
+                    p.velocity[axis] = desc.velocity[axis] + desc.velocity_spread[axis] * jitter(rng);
+                }
+                for (int c = 0; c < 4; ++c) {
+                    p.color[c] = desc.start_color[c];
+                    p.fade[c] = (desc.end_color[c] - desc.start_color[c]) / lifetime;
+                }
+                p.life = lifetime;
+                p.gravity_scale = desc.gravity_scale;
+                particles.push_back(p);
+            }
+        }
+        for (AosParticle& p : particles) {
+            p.velocity[1] += -9.81f * DT * p.gravity_scale;
+            for (int axis = 0; axis < 3; ++axis) p.position[axis] += p.velocity[axis] * DT;
+            for (int c = 0; c < 4; ++c) p.color[c] += p.fade[c] * DT;
+            p.life -= DT;
+        }
+        particles.erase(std::remove_if(particles.begin(), particles.end(),
+                                       [](const AosParticle& p) { return p.life <= 0.0f; }),
+                        particles.end());
+        std::vector<Vec3> render_positions;
+        for (const AosParticle& p : particles) {
+            render_positions.push_back(Vec3{p.position[0], p.position[1], p.position[2]});
+        }
+        drawn += render_positions.size();
+    }
+};
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    const size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 300;
+    const size_t warmup = static_cast<size_t>((LIFETIME + LIFETIME_SPREAD) / DT) + 1;
+    const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%-8s %-7s %9s %9s %11s %10s %10s %10s %12s %10s %10s\n", "target", "threads", "alive", "emit us",
+                "simulate us", "compact us", "total us", "Mpart/s", "allocs/frame", "aos us", "speedup");
+    for (size_t target : {size_t(50000), size_t(500000)}) {
+        std::vector<ParticleEmitterDesc> descs;
+        for (size_t e = 0; e < EMITTERS; ++e) descs.push_back(emitter_desc(e, target));
+
+        AosSystem aos;
+        for (size_t frame = 0; frame < warmup; ++frame) aos.update(descs);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t frame = 0; frame < frames; ++frame) aos.update(descs);
+        const double aos_us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        for (size_t threads : {size_t(1), hw}) {
+            std::unique_ptr<ThreadPool> pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+            ParticleSystem particles(target * 2);
+            particles.set_thread_pool(pool.get());
+            for (const ParticleEmitterDesc& desc : descs) particles.add_emitter(desc);
+            for (size_t frame = 0; frame < warmup; ++frame) particles.update(DT);
+
+            double emit_us = 0.0, simulate_us = 0.0, compact_us = 0.0;
+            size_t alive = 0;
+            const size_t allocations_before = g_allocations.load();
+            start = std::chrono::steady_clock::now();
+            for (size_t frame = 0; frame < frames; ++frame) {
+                particles.update(DT);
+                const ParticleRenderData render = particles.get_render_data();
+                alive += render.count;
+                const ParticleSystem::Stats& stats = particles.get_stats();
+                emit_us += stats.emit_us;
+                simulate_us += stats.simulate_us;
+                compact_us += stats.compact_us;
+            }
+            const double total_us =
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+            const double allocations = static_cast<double>(g_allocations.load() - allocations_before) / frames;
+
+            std::printf("%-8zu %-7zu %9zu %9.1f %11.1f %10.1f %10.1f %10.1f %12.2f %10.1f %9.1fx\n", target, threads,
+                        alive / frames, emit_us / frames, simulate_us / frames, compact_us / frames, total_us,
+                        alive / frames / total_us, allocations, aos_us, aos_us / total_us);
+            if (hw == 1) break;
+        }
+    }
+    return 0;
+}
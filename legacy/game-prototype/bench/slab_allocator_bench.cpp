@@ -0,0 +1,169 @@
+/**
+ * SlabAllocator benchmark against malloc/free on engine churn patterns.
+ *
+ *   g++ -O2 -std=c++17 -pthread -Iinclude bench/slab_allocator_bench.cpp src/slab_allocator.cpp
+ *   ./a.out [rounds]
+ *
+ * entity   - MAX_ENTITIES live objects with mixed component sizes (32B-2KB);
+ *            each round destroys and respawns a random 10%.
+ * particle - 50k live 64B particles in a FIFO ring; each round expires and
+ *            re-emits 5k of them.
+ * handoff  - one thread allocates 64B events, another frees them (the
+ *            cross-thread free path).
+ */
+
+#include "slab_allocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+constexpr size_t ENTITIES = 10000;
+constexpr size_t PARTICLES = 50000;
+constexpr size_t EMIT_PER_ROUND = 5000;
+
+struct MallocBackend {
+    void* allocate(size_t size) { return std::malloc(size); }
+    void deallocate(void* ptr, size_t) { std::free(ptr); }
+    void sample() {}
+    const char* name() const { return "malloc"; }
+};
+
+struct SlabBackend {
+    SlabAllocator slab;
+    void* allocate(size_t size) { return slab.allocate(size); }
+    void deallocate(void* ptr, size_t size) { slab.deallocate(ptr, size); }
+    void sample() { slab.get_stats(); } // what PerformanceEngine does once per frame
+    const char* name() const { return "slab"; }
+};
+
+uint32_t next_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+size_t component_size(uint32_t r) {
+    static const size_t sizes[] = {32, 48, 64, 96, 128, 256, 512, 2048};
+    return sizes[r % 8];
+}
+
+template<typename Backend>
+double entity_churn(Backend& backend, size_t rounds) {
+    std::vector<void*> objects(ENTITIES);
+    std::vector<size_t> sizes(ENTITIES);
+    uint32_t rng = 7;
+    for (size_t i = 0; i < ENTITIES; ++i) {
+        sizes[i] = component_size(next_random(rng));
+        objects[i] = backend.allocate(sizes[i]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t ops = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t n = 0; n < ENTITIES / 10; ++n) {
+            const size_t i = next_random(rng) % ENTITIES;
+            backend.deallocate(objects[i], sizes[i]);
+            sizes[i] = component_size(next_random(rng));
+            objects[i] = backend.allocate(sizes[i]);
+            static_cast<char*>(objects[i])[0] = 1;
+            ++ops;
+        }
+        backend.sample();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t i = 0; i < ENTITIES; ++i) backend.deallocate(objects[i], sizes[i]);
+    return ops / seconds / 1e6;
+}
+
+template<typename Backend>
+double particle_churn(Backend& backend, size_t rounds) {
+    constexpr size_t PARTICLE_SIZE = 64;
+    std::vector<void*> ring(PARTICLES);
+    for (auto& p : ring) p = backend.allocate(PARTICLE_SIZE);
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t cursor = 0;
+    size_t ops = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t n = 0; n < EMIT_PER_ROUND; ++n) {
+            backend.deallocate(ring[cursor], PARTICLE_SIZE);
+            ring[cursor] = backend.allocate(PARTICLE_SIZE);
+            static_cast<char*>(ring[cursor])[0] = 1;
+            cursor = (cursor + 1) % PARTICLES;
+            ++ops;
+        }
+        backend.sample();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto p : ring) backend.deallocate(p, PARTICLE_SIZE);
+    return ops / seconds / 1e6;
+}
+
+template<typename Backend>
+double handoff(Backend& backend, size_t rounds) {
+    constexpr size_t EVENT_SIZE = 64;
+    constexpr size_t RING = 4096;
+    std::vector<std::atomic<void*>> ring(RING);
+    for (auto& slot : ring) slot.store(nullptr);
+    const size_t total = rounds * EMIT_PER_ROUND;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        for (size_t i = 0; i < total; ++i) {
+            std::atomic<void*>& slot = ring[i % RING];
+            void* p;
+            while ((p = slot.exchange(nullptr, std::memory_order_acquire)) == nullptr) std::this_thread::yield();
+            backend.deallocate(p, EVENT_SIZE);
+        }
+    });
+    for (size_t i = 0; i < total; ++i) {
+        void* p = backend.allocate(EVENT_SIZE);
+        std::atomic<void*>& slot = ring[i % RING];
+        while (slot.load(std::memory_order_relaxed) != nullptr) std::this_thread::yield();
+        slot.store(p, std::memory_order_release);
+    }
+    consumer.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t rounds = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 200;
+
+    MallocBackend malloc_backend;
+    SlabBackend slab_backend;
+
+    std::printf("%-10s %14s %14s %8s\n", "pattern", "malloc Mops/s", "slab Mops/s", "speedup");
+    const double em = entity_churn(malloc_backend, rounds);
+    const double es = entity_churn(slab_backend, rounds);
+    std::printf("%-10s %14.2f %14.2f %7.2fx\n", "entity", em, es, es / em);
+    const double pm = particle_churn(malloc_backend, rounds);
+    const double ps = particle_churn(slab_backend, rounds);
+    std::printf("%-10s %14.2f %14.2f %7.2fx\n", "particle", pm, ps, ps / pm);
+    const double hm = handoff(malloc_backend, rounds);
+    const double hs = handoff(slab_backend, rounds);
+    std::printf("%-10s %14.2f %14.2f %7.2fx\n", "handoff", hm, hs, hs / hm);
+
+    std::printf("\n%-8s %14s %14s %14s\n", "class", "live_bytes", "peak_bytes", "reserved");
+    for (const auto& size_class : slab_backend.slab.get_stats()) {
+        if (size_class.reserved_bytes == 0) continue;
+        std::printf("%-8u %14llu %14llu %14llu\n", size_class.block_size,
+                    static_cast<unsigned long long>(size_class.live_bytes),
+                    static_cast<unsigned long long>(size_class.peak_bytes),
+                    static_cast<unsigned long long>(size_class.reserved_bytes));
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * Entity storage benchmark: generational SlotMap vs. the previous
+ * vector + find_if + free-id queue layout, churning at MAX_ENTITIES.
+ *
+ *   g++ -O2 -std=c++17 -pthread -Iinclude bench/slot_map_bench.cpp
+ *   ./a.out [rounds]
+ *
+ * Both stores start with MAX_ENTITIES live entities. Each round destroys a
+ * random 10% and creates as many, then looks up 1000 random live ids and
+ * iterates every live entity once. The old layout reuses ids but keeps
+ * appending, so its vector grows every round; the report includes its final
+ * size and how many lookups of destroyed ids still returned an entity.
+ */
+
+#include "performance_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+constexpr size_t LOOKUPS_PER_ROUND = 1000;
+
+// The entity store as it was before this change.
+class VectorEntityStore {
+public:
+    uint32_t create() {
+        uint32_t id;
+        if (!free_ids_.empty()) {
+            id = free_ids_.front();
+            free_ids_.pop();
+        } else {
+            id = next_id_++;
+        }
+        Entity entity;
+        entity.id = id;
+        entity.active = true;
+        entities_.push_back(entity);
+        return id;
+    }
+
+    void destroy(uint32_t id) {
+        auto it = std::find_if(entities_.begin(), entities_.end(), [id](const Entity& e) { return e.id == id; });
+        if (it != entities_.end()) {
+            it->active = false;
+            free_ids_.push(id);
+        }
+    }
+
+    Entity* get(uint32_t id) {
+        auto it = std::find_if(entities_.begin(), entities_.end(), [id](const Entity& e) { return e.id == id; });
+        return it != entities_.end() ? &*it : nullptr;
+    }
+
+    template<typename F>
+    void for_each(F f) {
+        for (auto& entity : entities_) {
+            if (entity.active) f(entity);
+        }
+    }
+
+    size_t storage_size() const { return entities_.size(); }
+
+private:
+    std::vector<Entity> entities_;
+    std::queue<uint32_t> free_ids_;
+    uint32_t next_id_ = 1;
+};
+
+class SlotMapEntityStore {
+public:
+    SlotMapEntityStore() : entities_(MAX_ENTITIES) {}
+
+    uint32_t create() {
+        const SlotHandle handle = entities_.emplace();
+        Entity* entity = entities_.get(handle);
+        entity->id = handle;
+        entity->active = true;
+        return handle;
+    }
+
+    void destroy(uint32_t id) { entities_.erase(id); }
+    Entity* get(uint32_t id) { return entities_.get(id); }
+
+    template<typename F>
+    void for_each(F f) {
+        for (auto& entity : entities_) f(entity);
+    }
+
+    size_t storage_size() const { return entities_.slot_count(); }
+
+private:
+    SlotMap<Entity> entities_;
+};
+
+struct Result {
+    double churn_ns;      // per create or destroy
+    double lookup_ns;
+    double iterate_ns;    // per live entity
+    size_t storage;
+    size_t stale_hits;
+};
+
+template<typename Store>
+Result run(size_t rounds) {
+    Store store;
+    std::mt19937 rng(42);
+    std::vector<uint32_t> live;
+    live.reserve(MAX_ENTITIES);
+    for (size_t i = 0; i < MAX_ENTITIES; ++i) live.push_back(store.create());
+
+    const size_t churn = MAX_ENTITIES / 10;
+    std::vector<uint32_t> destroyed;
+    double churn_s = 0.0;
+    double lookup_s = 0.0;
+    double iterate_s = 0.0;
+    uint64_t checksum = 0;
+    size_t stale_hits = 0;
+
+    for (size_t round = 0; round < rounds; ++round) {
+        std::shuffle(live.begin(), live.end(), rng);
+        destroyed.assign(live.end() - churn, live.end());
+        live.resize(live.size() - churn);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t id : destroyed) store.destroy(id);
+        for (size_t i = 0; i < churn; ++i) live.push_back(store.create());
+        auto end = std::chrono::steady_clock::now();
+        churn_s += std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < LOOKUPS_PER_ROUND; ++i) {
+            Entity* entity = store.get(live[rng() % live.size()]);
+            checksum += entity != nullptr ? entity->id : 0;
+        }
+        end = std::chrono::steady_clock::now();
+        lookup_s += std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        store.for_each([&](Entity& entity) { checksum += entity.id; });
+        end = std::chrono::steady_clock::now();
+        iterate_s += std::chrono::duration<double>(end - start).count();
+
+        // A destroyed id must not resolve to anything, even after reuse.
+        for (size_t i = 0; i < 16; ++i) {
+            if (store.get(destroyed[i]) != nullptr) ++stale_hits;
+        }
+    }
+
+    if (checksum == 42) std::printf(" ");
+    return Result{churn_s * 1e9 / (rounds * churn * 2), lookup_s * 1e9 / (rounds * LOOKUPS_PER_ROUND),
+                  iterate_s * 1e9 / (rounds * MAX_ENTITIES), store.storage_size(), stale_hits};
+}
+
+void print(const char* name, const Result& result) {
+    std::printf("%-10s %12.1f %12.1f %14.2f %12zu %12zu\n", name, result.churn_ns, result.lookup_ns,
+                result.iterate_ns, result.storage, result.stale_hits);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50;
+
+    std::printf("%zu entities, %zu rounds of 10%% churn\n\n", MAX_ENTITIES, rounds);
+    std::printf("%-10s %12s %12s %14s %12s %12s\n", "store", "churn ns/op", "lookup ns", "iterate ns/ent", "storage", "stale hits");
+    print("vector", run<VectorEntityStore>(rounds));
+    print("slot map", run<SlotMapEntityStore>(rounds));
+    return 0;
+}
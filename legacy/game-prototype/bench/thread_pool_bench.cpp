@@ -0,0 +1,219 @@
+/**
+ * ThreadPool benchmark: work-stealing pool vs. the previous single-queue
+ * std::function pool, on fine-grained (~1us) tasks.
+ *
+ *   g++ -O2 -std=c++17 -pthread -Iinclude bench/thread_pool_bench.cpp src/thread_pool.cpp src/memory_pool.cpp
+ *   ./a.out [tasks] [threads]
+ *
+ * external - the main thread submits every task and waits for all of them.
+ * nested   - one task fans out all others from inside a worker, the pattern
+ *            a frame job graph produces.
+ *
+ * Before timing, every task submitted through each path (external, nested
+ * from several workers at once, enqueue) must run exactly once; the run
+ * exits non-zero otherwise.
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <vector>
+
+using namespace AnimeAggressors;
+
+namespace {
+
+// The pool as it was before work stealing: one std::queue of std::function
+// behind one mutex and condition variable.
+class QueueThreadPool {
+public:
+    explicit QueueThreadPool(size_t thread_count) : stop_(false) {
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers_.emplace_back([this] {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(queue_mutex_);
+                        condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                        if (stop_ && tasks_.empty()) return;
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~QueueThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    template<typename F>
+    auto enqueue(F&& f) -> std::future<std::invoke_result_t<F>> {
+        using return_type = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(f));
+        std::future<return_type> res = task->get_future();
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            tasks_.emplace([task] { (*task)(); });
+        }
+        condition_.notify_one();
+        return res;
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex queue_mutex_;
+    std::condition_variable condition_;
+    bool stop_;
+};
+
+void spin_for(std::chrono::nanoseconds duration) {
+    const auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+constexpr auto TASK_COST = std::chrono::microseconds(1);
+
+template<typename Fn>
+double seconds_for(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double queue_external(QueueThreadPool& pool, size_t tasks) {
+    return seconds_for([&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(tasks);
+        for (size_t i = 0; i < tasks; ++i) futures.push_back(pool.enqueue([] { spin_for(TASK_COST); }));
+        for (auto& f : futures) f.get();
+    });
+}
+
+double queue_nested(QueueThreadPool& pool, size_t tasks) {
+    return seconds_for([&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(tasks);
+        pool.enqueue([&] {
+            for (size_t i = 0; i < tasks; ++i) futures.push_back(pool.enqueue([] { spin_for(TASK_COST); }));
+        }).get();
+        for (auto& f : futures) f.get();
+    });
+}
+
+double stealing_external(ThreadPool& pool, size_t tasks) {
+    return seconds_for([&] {
+        TaskGroup group;
+        for (size_t i = 0; i < tasks; ++i) pool.submit(group, [] { spin_for(TASK_COST); });
+        pool.wait(group);
+    });
+}
+
+double stealing_nested(ThreadPool& pool, size_t tasks) {
+    return seconds_for([&] {
+        TaskGroup root;
+        pool.submit(root, [&pool, tasks] {
+            TaskGroup children;
+            for (size_t i = 0; i < tasks; ++i) pool.submit(children, [] { spin_for(TASK_COST); });
+            pool.wait(children);
+        });
+        pool.wait(root);
+    });
+}
+
+// Submits `tasks` tasks, each bumping its own counter: a third from this
+// thread, a third fanned out by several workers at once into nested groups,
+// and the rest through enqueue(). Every other task carries a capture too
+// big for Task's inline storage. Returns how many counters are not 1.
+size_t check_exactly_once(ThreadPool& pool, size_t tasks, size_t threads) {
+    std::unique_ptr<std::atomic<uint32_t>[]> runs(new std::atomic<uint32_t>[tasks]());
+    const auto submit_one = [&runs](ThreadPool& p, TaskGroup& group, size_t i) {
+        if (i % 2 == 0) {
+            p.submit(group, [&runs, i] { runs[i].fetch_add(1, std::memory_order_relaxed); });
+        } else {
+            char padding[Task::INLINE_SIZE] = {};
+            p.submit(group, [&runs, i, padding] {
+                runs[i].fetch_add(1u + static_cast<uint32_t>(padding[0]), std::memory_order_relaxed);
+            });
+        }
+    };
+
+    const size_t external_end = tasks / 3;
+    const size_t nested_end = 2 * tasks / 3;
+    TaskGroup root;
+    for (size_t i = 0; i < external_end; ++i) submit_one(pool, root, i);
+
+    const size_t producers = threads * 2;
+    for (size_t p = 0; p < producers; ++p) {
+        const size_t begin = external_end + (nested_end - external_end) * p / producers;
+        const size_t end = external_end + (nested_end - external_end) * (p + 1) / producers;
+        pool.submit(root, [&pool, &submit_one, begin, end] {
+            TaskGroup children;
+            for (size_t i = begin; i < end; ++i) submit_one(pool, children, i);
+            pool.wait(children);
+        });
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(tasks - nested_end);
+    for (size_t i = nested_end; i < tasks; ++i) {
+        futures.push_back(pool.enqueue([&runs, i] { runs[i].fetch_add(1, std::memory_order_relaxed); }));
+    }
+    pool.wait(root);
+    for (auto& f : futures) f.get();
+
+    size_t wrong = 0;
+    for (size_t i = 0; i < tasks; ++i) {
+        if (runs[i].load(std::memory_order_relaxed) != 1) ++wrong;
+    }
+    return wrong;
+}
+
+void report(const char* name, size_t tasks, size_t threads, double queue_s, double stealing_s) {
+    // Overhead per task beyond the ideal 1us / threads.
+    const double ideal = tasks * 1e-6 / threads;
+    std::printf("%-9s %14.0f %14.0f %12.2f %12.2f %7.2fx\n", name, tasks / queue_s, tasks / stealing_s,
+                (queue_s - ideal) * 1e9 / tasks, (stealing_s - ideal) * 1e9 / tasks, queue_s / stealing_s);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t tasks = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 200000;
+    const size_t threads = argc > 2 ? static_cast<size_t>(std::atoll(argv[2]))
+                                    : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    QueueThreadPool queue_pool(threads);
+    ThreadPool stealing_pool(threads);
+
+    const size_t wrong = check_exactly_once(stealing_pool, tasks, threads);
+    if (wrong != 0) {
+        std::fprintf(stderr, "ThreadPool check failed: %zu of %zu tasks did not run exactly once\n", wrong, tasks);
+        return 1;
+    }
+    std::printf("ThreadPool check: %zu tasks each ran exactly once\n", tasks);
+
+    std::printf("%zu tasks x ~1us on %zu threads\n", tasks, threads);
+    std::printf("%-9s %14s %14s %12s %12s %8s\n", "pattern", "queue tasks/s", "steal tasks/s", "queue ns/op",
+                "steal ns/op", "speedup");
+    report("external", tasks, threads, queue_external(queue_pool, tasks), stealing_external(stealing_pool, tasks));
+    report("nested", tasks, threads, queue_nested(queue_pool, tasks), stealing_nested(stealing_pool, tasks));
+    return 0;
+}
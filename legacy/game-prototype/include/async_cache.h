@@ -0,0 +1,72 @@
+/**
+ * Anime Aggressors Performance Engine - Async asset cache
+ * Loads misses on the ThreadPool and coalesces concurrent requests per key
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "cache_system.h"
+#include "thread_pool.h"
+
+namespace AnimeAggressors {
+
+// Read-through front end for a CacheSystem.
+//
+// get_or_load() answers hits immediately. On a miss, the first caller's
+// loader runs on the ThreadPool and every caller that asks for the same key
+// before it finishes shares that one load's future, so a burst of entities
+// spawning with the same texture reads it once. Finished loads are put()
+// into the cache, whose byte budget then decides what stays resident. A
+// loader that throws fails every waiter's future and nothing is cached.
+//
+// Don't block a pool worker on a returned future while the pool is busy:
+// the load may be queued behind the waiting task.
+class AsyncCache {
+public:
+    using Loader = std::function<std::string()>;
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t loads;       // loader invocations
+        uint64_t coalesced;   // misses that joined a load already in flight
+        uint64_t failures;    // loads whose loader threw
+    };
+
+    AsyncCache(CacheSystem& cache, ThreadPool& pool);
+    // Waits for loads still in flight.
+    ~AsyncCache();
+
+    AsyncCache(const AsyncCache&) = delete;
+    AsyncCache& operator=(const AsyncCache&) = delete;
+
+    std::shared_future<std::string> get_or_load(std::string_view key, Loader loader);
+
+    size_t get_in_flight() const;
+    Stats get_stats() const;
+
+private:
+    CacheSystem& cache_;
+    ThreadPool& pool_;
+    TaskGroup loads_;
+
+    mutable std::mutex in_flight_mutex_;
+    std::unordered_map<std::string, std::shared_future<std::string>> in_flight_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> loads_started_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> failures_{0};
+
+    void finish_load(const std::string& key);
+};
+
+} // namespace AnimeAggressors
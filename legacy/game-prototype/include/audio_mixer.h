@@ -0,0 +1,267 @@
+/**
+ * Anime Aggressors Performance Engine - Audio mixer
+ * Voice pool mixed on a real-time thread, fed through a lock-free command ring
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+namespace AnimeAggressors {
+
+constexpr uint32_t AUDIO_SAMPLE_RATE = 48000;
+constexpr size_t AUDIO_BLOCK_FRAMES = 480;         // 10 ms
+constexpr size_t AUDIO_CHANNELS = 2;               // interleaved left, right
+constexpr size_t AUDIO_COMMAND_CAPACITY = 4096;
+constexpr float AUDIO_REFERENCE_DISTANCE = 1.0f;   // full volume inside this distance
+constexpr float AUDIO_AUDIBLE_GAIN = 1e-4f;        // -80 dB; quieter voices are never mixed
+constexpr uint8_t AUDIO_PRIORITY_DEFAULT = 128;
+
+enum AudioBus : uint8_t {
+    AUDIO_BUS_SFX = 0,
+    AUDIO_BUS_MUSIC,
+    AUDIO_BUS_COUNT,
+};
+
+// A playing voice: slot index in the low 16 bits, generation in the high 16.
+// Stale handles are ignored. 0 is never issued.
+using SoundHandle = uint32_t;
+constexpr SoundHandle NO_SOUND = 0;
+
+// Mono samples at AUDIO_SAMPLE_RATE. The mixer reads them from its thread,
+// so they must stay unchanged and alive while any voice plays them.
+struct AudioClip {
+    const float* samples;
+    size_t frames;
+};
+
+struct VoiceParams {
+    AudioBus bus = AUDIO_BUS_SFX;
+    float gain = 1.0f;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    bool positional = true;     // attenuate and pan from the listener; else centred
+    bool loop = false;
+    uint8_t priority = AUDIO_PRIORITY_DEFAULT;    // higher stays audible first
+};
+
+// Where mixed blocks go: an audio device, or one of the sinks below.
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    // `frames` interleaved stereo frames. Called from the mixer thread.
+    virtual void write(const float* samples, size_t frames) = 0;
+};
+
+// Discards blocks, counting them, so the mixer runs without a device.
+class NullAudioSink : public AudioSink {
+public:
+    void write(const float* samples, size_t frames) override;
+
+    uint64_t get_frames() const { return frames_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> frames_{0};
+};
+
+// Writes a 32-bit float stereo WAV file; the header's sizes are filled in
+// when the sink is destroyed. Throws std::runtime_error if the file cannot
+// be created.
+class WavFileAudioSink : public AudioSink {
+public:
+    explicit WavFileAudioSink(const std::string& path);
+    ~WavFileAudioSink() override;
+
+    WavFileAudioSink(const WavFileAudioSink&) = delete;
+    WavFileAudioSink& operator=(const WavFileAudioSink&) = delete;
+
+    void write(const float* samples, size_t frames) override;
+
+    uint64_t get_frames() const { return frames_; }
+
+private:
+    std::FILE* file_;
+    uint64_t frames_;
+};
+
+// Fixed pool of voices mixed a block at a time.
+//
+// The game thread owns handles: play() takes a slot from a free list and
+// every request, including play() itself, becomes a command on an SPSC
+// ring, so the mixer thread never locks or allocates. Each block it drains
+// the ring, then adds every voice into its bus's planar left and right
+// buffers with one batch_multiply_add per channel and clip segment, folding
+// distance attenuation and equal-power pan into the two gains. The buses
+// are summed with their gain times the master gain, clamped to [-1, 1] and
+// interleaved for the sink. Voices that finish, or are stopped, go back on
+// a second ring, and update() returns their slots to the free list;
+// generations keep stale handles from reaching a reused voice.
+//
+// Only the loudest set_max_real_voices() voices are mixed. Each block every
+// voice is scored by priority, then by its gain after distance attenuation
+// and bus gain, and nth_element picks the real ones; the rest are virtual,
+// costing one playhead step per block, so they carry on in time and come
+// back where they would have been. A voice changing sides fades in or out
+// over one block so the switch does not click. Voices under
+// AUDIO_AUDIBLE_GAIN are always virtual.
+//
+// Game-side calls come from one thread at a time. mix_block() is the mixer
+// thread's work, and may be called directly while no thread is running.
+class AudioMixer {
+public:
+    struct Stats {
+        uint64_t blocks = 0;
+        uint64_t late_blocks = 0;         // a paced thread missed its deadline
+        uint64_t dropped_commands = 0;    // the command ring was full
+        uint32_t real_voices = 0;         // mixed in the last block
+        uint32_t virtual_voices = 0;      // only advanced in the last block
+        double last_block_us = 0.0;
+        double max_block_us = 0.0;
+        double average_block_us = 0.0;
+    };
+
+    // Throws std::invalid_argument unless 0 < max_voices <= 65536.
+    explicit AudioMixer(size_t max_voices);
+    ~AudioMixer();
+
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    // Game thread. play() returns NO_SOUND when every voice is taken, the
+    // clip is empty, or the command ring is full.
+    SoundHandle play(const AudioClip& clip, const VoiceParams& params);
+    void stop(SoundHandle sound);
+    void set_voice_position(SoundHandle sound, const float position[3]);
+    void set_voice_gain(SoundHandle sound, float gain);
+    // `forward` and `up` need not be unit length; right is forward x up.
+    void set_listener(const float position[3], const float forward[3], const float up[3]);
+    void set_bus_gain(AudioBus bus, float gain);
+    void set_master_gain(float gain);
+    // Defaults to max_voices(), mixing everything.
+    void set_max_real_voices(size_t count);
+    // Reclaims the slots of voices the mixer has finished.
+    void update();
+    // True from play() until update() sees the voice finish.
+    bool is_playing(SoundHandle sound) const;
+    size_t playing_count() const { return max_voices_ - free_slots_.size(); }
+    size_t max_voices() const { return max_voices_; }
+
+    // Mixes one block into `out` (AUDIO_BLOCK_FRAMES interleaved frames).
+    void mix_block(float* out);
+
+    // Runs mix_block() on a thread, writing to `sink` until stop_thread().
+    // Paced, it mixes a block every 10 ms; otherwise as fast as it can.
+    // Restarts the thread if one is running.
+    void start_thread(AudioSink& sink, bool paced = true);
+    void stop_thread();
+    bool thread_running() const { return thread_.joinable(); }
+
+    // Safe from any thread.
+    Stats get_stats() const;
+
+private:
+    enum CommandType : uint8_t {
+        COMMAND_PLAY,
+        COMMAND_STOP,
+        COMMAND_SET_POSITION,
+        COMMAND_SET_GAIN,
+        COMMAND_SET_LISTENER,
+        COMMAND_SET_BUS_GAIN,
+        COMMAND_SET_MASTER_GAIN,
+        COMMAND_SET_MAX_REAL_VOICES,
+    };
+
+    struct Command {
+        CommandType type;
+        uint8_t bus;
+        uint8_t priority;
+        bool positional;
+        bool loop;
+        SoundHandle sound;
+        const float* samples;
+        uint32_t frames;      // or the real voice limit
+        float gain;
+        float vectors[9];     // position, or listener position, forward, up
+    };
+
+    enum VoiceState : uint8_t {
+        VOICE_NEW,            // not yet heard, so it starts without a fade
+        VOICE_REAL,
+        VOICE_VIRTUAL,
+    };
+
+    struct Voice {
+        SoundHandle sound;    // NO_SOUND when free
+        const float* samples;
+        uint32_t frames;
+        uint32_t cursor;
+        uint32_t active;      // index in active_
+        float gain;
+        float position[3];
+        float attenuated;     // this block's gain after distance attenuation
+        float pan;            // -1 left to 1 right
+        uint8_t bus;
+        uint8_t priority;
+        uint8_t state;
+        bool real;            // chosen for this block
+        bool positional;
+        bool loop;
+    };
+
+    struct RankedVoice {
+        uint64_t score;       // priority, then audibility as float bits
+        uint32_t slot;
+    };
+
+    // Game thread
+    size_t max_voices_;
+    std::vector<uint16_t> generations_;   // odd while the slot is taken
+    std::vector<uint16_t> free_slots_;
+    SpscRing<Command> commands_;
+    SpscRing<SoundHandle> finished_;
+
+    // Mixer thread
+    std::vector<Voice> voices_;
+    std::vector<uint32_t> active_;
+    std::vector<RankedVoice> ranked_;
+    size_t max_real_voices_;
+    float listener_position_[3];
+    float listener_right_[3];
+    float bus_gains_[AUDIO_BUS_COUNT];
+    float master_gain_;
+    std::vector<float> bus_buffers_;      // per bus, left then right
+    std::vector<float> mix_buffer_;       // left then right
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> blocks_;
+    std::atomic<uint64_t> late_blocks_;
+    std::atomic<uint64_t> total_block_ns_;
+    std::atomic<uint64_t> last_block_ns_;
+    std::atomic<uint64_t> max_block_ns_;
+    std::atomic<uint32_t> real_voices_;
+    std::atomic<uint32_t> virtual_voices_;
+    std::atomic<uint64_t> dropped_commands_;
+
+    bool push(const Command& command);
+    void apply(const Command& command);
+    void finish(uint32_t slot);
+    // Sets each voice's gains and picks the real ones. Returns how many.
+    size_t choose_real_voices();
+    // Adds the voice to its bus, its gain scaled from `fade_from` to
+    // `fade_to` over the block; false once a one-shot voice has ended.
+    bool mix_voice(Voice& voice, float fade_from, float fade_to);
+    // Moves the playhead a block without mixing; false once it has ended.
+    static bool skip_voice(Voice& voice);
+    void run(AudioSink& sink, bool paced);
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,133 @@
+/**
+ * Anime Aggressors Performance Engine - Batch vector math
+ * SoA float-stream kernels with SSE2/AVX2/NEON paths and runtime dispatch
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace AnimeAggressors {
+
+enum class SimdIsa {
+    SCALAR,
+    SSE2,
+    AVX2,   // AVX2 + FMA
+    NEON,
+};
+
+const char* simd_isa_name(SimdIsa isa);
+bool simd_isa_supported(SimdIsa isa);
+// Best ISA this CPU supports; what the kernels use unless overridden.
+SimdIsa detect_simd_isa();
+SimdIsa get_batch_math_isa();
+// Forces a kernel set, e.g. to compare paths in a benchmark. Throws
+// std::invalid_argument if the CPU (or this build) lacks it.
+void set_batch_math_isa(SimdIsa isa);
+
+// Three parallel float arrays, one per axis (structure of arrays).
+struct Vec3SoA {
+    float* x;
+    float* y;
+    float* z;
+};
+
+struct ConstVec3SoA {
+    const float* x;
+    const float* y;
+    const float* z;
+
+    ConstVec3SoA(const float* x, const float* y, const float* z) : x(x), y(y), z(z) {}
+    ConstVec3SoA(const Vec3SoA& v) : x(v.x), y(v.y), z(v.z) {}
+};
+
+struct QuatSoA {
+    float* x;
+    float* y;
+    float* z;
+    float* w;
+};
+
+struct ConstQuatSoA {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* w;
+
+    ConstQuatSoA(const float* x, const float* y, const float* z, const float* w) : x(x), y(y), z(z), w(w) {}
+    ConstQuatSoA(const QuatSoA& q) : x(q.x), y(q.y), z(q.z), w(q.w) {}
+};
+
+struct TransformSoA {
+    Vec3SoA position;
+    Vec3SoA scale;
+    QuatSoA rotation;
+};
+
+struct ConstTransformSoA {
+    ConstVec3SoA position;
+    ConstVec3SoA scale;
+    ConstQuatSoA rotation;
+
+    ConstTransformSoA(const ConstVec3SoA& position, const ConstVec3SoA& scale, const ConstQuatSoA& rotation)
+        : position(position), scale(scale), rotation(rotation) {}
+    ConstTransformSoA(const TransformSoA& t) : position(t.position), scale(t.scale), rotation(t.rotation) {}
+};
+
+struct Bounds3 {
+    float min[3];
+    float max[3];
+};
+
+// normal . p + distance >= 0 on the inner side; normals need not be unit
+// length, but distances then scale with them.
+struct Plane {
+    float normal[3];
+    float distance;
+};
+
+// Element-wise kernels over `count` elements. Streams need no particular
+// alignment, and an output may be the same stream as an input (but must not
+// partially overlap one). Results match the scalar Vector3D/Quaternion math
+// up to float rounding (AVX2 fuses multiply-adds).
+
+// out = a + b
+void batch_add(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, size_t count);
+// out = a * s
+void batch_scale(Vec3SoA out, ConstVec3SoA a, float s, size_t count);
+// out = a + b * s, e.g. position += velocity * dt
+void batch_multiply_add(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float s, size_t count);
+// out = a / |a|, or zero where |a| == 0
+void batch_normalize(Vec3SoA out, ConstVec3SoA a, size_t count);
+// out = a + (b - a) * t
+void batch_lerp(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float t, size_t count);
+// Per-axis clamp to [bounds.min, bounds.max].
+void batch_clamp(Vec3SoA out, ConstVec3SoA a, const Bounds3& bounds, size_t count);
+// out = q * v * conj(q) for unit quaternions q.
+void batch_quat_rotate(Vec3SoA out, ConstQuatSoA q, ConstVec3SoA v, size_t count);
+// World transform of `child` under `parent`: scale multiplies, rotations
+// compose (parent * child), and position = parent.position +
+// rotate(parent.rotation, parent.scale * child.position).
+void batch_transform_compose(TransformSoA out, ConstTransformSoA parent, ConstTransformSoA child, size_t count);
+
+// Scalar streams (timers, lifetimes, 1D velocities).
+// out = a + s
+void batch_add(float* out, const float* a, float s, size_t count);
+// out = a + b * s
+void batch_multiply_add(float* out, const float* a, const float* b, float s, size_t count);
+
+// Culling.
+// out = min over planes of (n . center + d + |n| . extent): the deepest
+// penetration of each box (center +/- extent) into the planes' inner sides.
+// Negative means the box lies wholly outside at least one plane, so for a
+// frustum, out >= 0 is "possibly visible". Boxes with a negative extent
+// never pass.
+void batch_plane_distance(float* out, const Plane* planes, size_t plane_count, ConstVec3SoA center,
+                          ConstVec3SoA extent, size_t count);
+
+// Single vectors, for setup code around the kernels.
+// Scales `v` to unit length. Returns false, leaving `v` alone, when it has
+// no direction.
+bool normalize3(float v[3]);
+
+} // namespace AnimeAggressors
@@ -0,0 +1,49 @@
+/**
+ * Anime Aggressors Performance Engine - Cache eviction policies
+ * LRU, CLOCK, W-TinyLFU and ARC over CacheSystem node indices
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AnimeAggressors {
+
+enum class CachePolicyType {
+    LRU,
+    CLOCK,
+    TINY_LFU,   // W-TinyLFU: 1% LRU window, SLRU main, count-min admission
+    ARC,
+};
+
+const char* cache_policy_name(CachePolicyType type);
+
+// Eviction order for one CacheSystem shard.
+//
+// The shard owns keys and values; a policy only sees node indices in
+// [0, capacity) plus the 64-bit key hash, and keeps its own bookkeeping in
+// arrays indexed by node. Every call happens under the shard mutex.
+class CachePolicy {
+public:
+    virtual ~CachePolicy() = default;
+
+    // Every get() and put(), hit or miss. Frequency-based policies count it.
+    virtual void on_access(uint64_t hash) { (void)hash; }
+    virtual void on_hit(uint32_t node) = 0;
+    // `node` now holds the key with `hash`, either in a fresh slot or in the
+    // slot select_victim() just vacated.
+    virtual void on_insert(uint32_t node, uint64_t hash) = 0;
+    virtual void on_remove(uint32_t node) = 0;
+    // Called when the shard must make room for a new key (`incoming_hash`):
+    // it is full, or the cache is over its byte budget, possibly several
+    // times for the same key. Budget trimming with no incoming key passes 0.
+    // Returns the resident node to drop and forgets it.
+    virtual uint32_t select_victim(uint64_t incoming_hash) = 0;
+    virtual void clear() = 0;
+};
+
+std::unique_ptr<CachePolicy> make_cache_policy(CachePolicyType type, uint32_t capacity);
+
+} // namespace AnimeAggressors
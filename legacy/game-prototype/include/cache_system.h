@@ -0,0 +1,137 @@
+/**
+ * Anime Aggressors Performance Engine - Sharded key/value cache
+ * Node arena with pluggable eviction, lock-striped segments, string_view keys
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cache_policy.h"
+
+namespace AnimeAggressors {
+
+class CacheTrace;
+class DiskCache;
+
+constexpr size_t CACHE_SIZE = 1000;
+constexpr size_t CACHE_SHARDS = 16;
+constexpr size_t CACHE_MAX_BYTES = 64 * 1024 * 1024;
+
+// String key/value cache with a selectable eviction policy (LRU by default).
+//
+// Keys are hashed once and split across a power-of-two number of shards,
+// each with its own mutex, so callers touching different keys rarely
+// contend. Within a shard, entries live in a node arena and the eviction
+// policy tracks them by 32-bit index rather than by pointer; a get() touches
+// no reference counts, and a put() that replaces an evicted entry reuses its
+// node (and its string capacity) without allocating. The key index is an
+// open-addressing table of node indices probed with the caller's
+// std::string_view, so lookups never build a std::string.
+//
+// Each shard holds max_size / shard_count entries and runs its own policy
+// instance, so eviction decisions are per shard. Independently of the entry
+// count, the cache keeps the total key + value bytes under max_bytes: a put()
+// evicts from its own shard first and, if the total is still over budget,
+// trims other shards round-robin. A single entry larger than max_bytes is
+// not cached.
+//
+// An optional DiskCache second tier receives every put() (write-through) and
+// answers memory misses; entries found there are promoted back into memory.
+// Both tiers are written, and promotions read, under the key's shard lock,
+// so they never disagree about a key's value. Disk I/O then holds that
+// shard, but only on puts and memory misses.
+// get_hit_rate() reports the memory tier only.
+class CacheSystem {
+public:
+    CacheSystem(size_t max_size = CACHE_SIZE, size_t shard_count = CACHE_SHARDS,
+                CachePolicyType policy = CachePolicyType::LRU, size_t max_bytes = CACHE_MAX_BYTES);
+    ~CacheSystem();
+
+    CacheSystem(const CacheSystem&) = delete;
+    CacheSystem& operator=(const CacheSystem&) = delete;
+
+    bool get(std::string_view key, std::string& value);
+    void put(std::string_view key, std::string_view value);
+    void remove(std::string_view key);
+    void clear();
+    size_t size() const;
+    double get_hit_rate() const;
+
+    size_t get_shard_count() const;
+    size_t get_capacity() const;
+    size_t get_bytes() const;
+    size_t get_byte_budget() const;
+    CachePolicyType get_policy() const;
+
+    // Records every get/put/remove into `trace` until set_trace(nullptr).
+    void set_trace(CacheTrace* trace);
+    // Attaches (or with nullptr detaches) a persistent tier that must outlive
+    // the attachment.
+    void set_disk_tier(DiskCache* tier);
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Node {
+        std::string key;
+        std::string value;
+        uint64_t hash;
+        uint32_t next_free;
+    };
+
+    struct Slot {
+        uint32_t node;   // NIL when empty
+        uint32_t hash;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::vector<Node> nodes;     // grows to capacity, then recycles
+        std::vector<Slot> slots;     // linear probing, power-of-two size
+        std::unique_ptr<CachePolicy> policy;
+        uint32_t capacity = 0;
+        uint32_t count = 0;
+        uint32_t free_head = NIL;
+        size_t bytes = 0;
+        // Written under the shard mutex, read lock-free by get_hit_rate().
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+
+        size_t find_slot(std::string_view key, uint32_t hash) const;
+        void erase_slot(size_t slot);
+        void insert_slot(uint32_t node, uint32_t hash);
+        uint32_t acquire_node();
+        void release_node(uint32_t node);
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_count_;
+    uint32_t shard_shift_;
+    size_t capacity_;
+    size_t max_bytes_;
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> trim_cursor_{0};
+    CachePolicyType policy_;
+    std::atomic<CacheTrace*> trace_{nullptr};
+    std::atomic<DiskCache*> disk_tier_{nullptr};
+
+    static uint64_t hash_key(std::string_view key);
+    Shard& shard_for(uint64_t hash) const;
+    // put() into memory only; expects shard.mutex held.
+    void store_locked(Shard& shard, uint64_t hash, std::string_view key, std::string_view value);
+    // Both expect shard.mutex held. drop_entry() frees the entry in `slot`
+    // once the policy has already forgotten it.
+    void evict_one(Shard& shard, uint64_t incoming_hash);
+    void drop_entry(Shard& shard, size_t slot);
+    void trim_to_budget();
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,72 @@
+/**
+ * Anime Aggressors Performance Engine - Cache trace recording and replay
+ * Captures CacheSystem key streams and replays them under each eviction policy
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cache_policy.h"
+#include "cache_system.h"
+
+namespace AnimeAggressors {
+
+enum class CacheOp : uint8_t {
+    GET,
+    PUT,
+    REMOVE,
+};
+
+// Ordered log of cache operations. Keys are interned, so a long trace costs
+// one small event per operation. record() is thread-safe; the accessors and
+// save() expect recording to have stopped.
+//
+// File format: one operation per line, "G <key>", "P <value_size> <key>" or
+// "R <key>", where the key runs to the end of the line.
+class CacheTrace {
+public:
+    struct Event {
+        CacheOp op;
+        uint32_t key;          // index into keys()
+        uint32_t value_size;   // PUT only
+    };
+
+    void record(CacheOp op, std::string_view key, size_t value_size = 0);
+    void clear();
+
+    size_t size() const;
+    const std::vector<Event>& events() const;
+    const std::vector<std::string>& keys() const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    std::vector<std::string> keys_;
+    std::unordered_map<std::string, uint32_t> key_ids_;
+
+    uint32_t intern(std::string_view key);
+};
+
+struct CacheReplayResult {
+    CachePolicyType policy;
+    uint64_t operations;
+    double hit_rate;      // CacheSystem::get_hit_rate() after the replay
+    double ns_per_op;
+};
+
+// Runs `trace` single-threaded through a fresh CacheSystem with the given
+// policy. PUT values are filled with the recorded size.
+CacheReplayResult replay_cache_trace(const CacheTrace& trace, CachePolicyType policy, size_t capacity,
+                                     size_t shard_count = CACHE_SHARDS);
+
+} // namespace AnimeAggressors
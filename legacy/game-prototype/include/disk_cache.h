@@ -0,0 +1,149 @@
+/**
+ * Anime Aggressors Performance Engine - Persistent disk cache tier
+ * Append-only memory-mapped blob log with a compact startup index (POSIX)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace AnimeAggressors {
+
+constexpr size_t DISK_CACHE_MAX_BYTES = 256 * 1024 * 1024;
+constexpr size_t DISK_CACHE_COMPACT_PERCENT = 75;   // of max_bytes kept by automatic compaction
+
+// On-disk key/value store that survives restarts.
+//
+// Values are content-addressed: each distinct value is appended once to
+// `<directory>/cache.dat` as a blob record named by its 64-bit content hash,
+// and a key record maps the key to that hash, so re-putting identical data
+// under the same key writes nothing and identical values under different
+// keys share one blob. The file is memory-mapped. read() hands a view into
+// the mapping to a callback while the lock is held, which is as close to
+// zero-copy as a cache that compacts and remaps can safely get; get() is
+// read() into a std::string. No view outlives the lock, so compaction never
+// pulls the mapping out from under a reader.
+//
+// `<directory>/cache.idx` holds a sorted table of blob and key locations,
+// written by flush() and the destructor, so opening the cache reads one
+// small file instead of scanning the log. The index names the log it was
+// written for by the id in the log's header, which every compaction renews,
+// and each entry must match the record header it points at, so a stale or
+// damaged index is ignored and the log scanned instead. Records appended
+// after the last flush are recovered by scanning only the tail; a torn
+// final record is cut off.
+//
+// The log only grows until it is compacted: rewritten keeping the most
+// recently used keys that fit. put() compacts once the log passes max_bytes,
+// down to DISK_CACHE_COMPACT_PERCENT of it so the next few puts don't
+// compact again, and so does opening a cache that is already over budget.
+// A value that alone would exceed that is not stored, and any older value
+// for its key is dropped. The mapping grows by doubling as the log does,
+// and is replaced rather than stacked.
+//
+// Hashes are FNV-1a over 64-bit words, stable across runs on platforms of
+// the same endianness. Throws std::runtime_error when the directory cannot
+// be used.
+class DiskCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t blobs_written;
+        uint64_t blobs_deduplicated;
+        uint64_t values_rejected;   // too large to survive compaction
+        uint64_t file_bytes;
+    };
+
+    explicit DiskCache(const std::string& directory, size_t max_bytes = DISK_CACHE_MAX_BYTES);
+    ~DiskCache();
+
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+
+    bool get(std::string_view key, std::string& value);
+    // Calls reader(value) with a view into the mapping and returns true, or
+    // returns false on a miss. The view is valid only during the call, and
+    // reader must not call back into this cache.
+    template<typename Reader>
+    bool read(std::string_view key, Reader&& reader) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string_view value;
+        if (!find_locked(key, value)) return false;
+        reader(value);
+        return true;
+    }
+    void put(std::string_view key, std::string_view value);
+    bool contains(std::string_view key) const;
+
+    // Persists the index so the next open skips the log scan.
+    void flush();
+    // Rewrites the log with the most recently used keys whose values fit in
+    // max_bytes.
+    void compact();
+
+    size_t size() const;
+    Stats get_stats() const;
+
+    static uint64_t hash_bytes(std::string_view bytes);
+
+private:
+    struct BlobEntry {
+        uint64_t offset;   // payload offset in cache.dat
+        uint64_t size;
+    };
+
+    struct KeyEntry {
+        uint64_t content_hash;
+        uint64_t key_offset;
+        uint32_t key_size;
+        uint32_t last_used;
+    };
+
+    struct Mapping {
+        void* address;
+        size_t length;
+    };
+
+    std::string directory_;
+    size_t max_bytes_;
+    int fd_;
+    uint64_t file_size_;
+    uint64_t file_id_;     // from the log's header; the index must carry the same
+
+    // May run past the end of the file; only bytes below file_size_ are read.
+    mutable Mapping mapping_;
+
+    std::unordered_map<uint64_t, BlobEntry> blobs_;   // by content hash
+    std::unordered_map<uint64_t, KeyEntry> keys_;     // by key hash
+    uint32_t use_clock_;
+
+    mutable std::mutex mutex_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t blobs_written_;
+    uint64_t blobs_deduplicated_;
+    uint64_t values_rejected_;
+
+    std::string data_path() const;
+    std::string index_path() const;
+
+    void open_data_file();
+    void close_data_file();
+    bool load_index();
+    void scan_log(uint64_t from);
+    void write_index();
+    const char* map_range(uint64_t offset, uint64_t size) const;
+    uint64_t append_record(uint32_t type, uint64_t content_hash, std::string_view payload);
+    bool key_matches(const KeyEntry& entry, std::string_view key) const;
+    // Looks the key up and counts the hit or miss; expects mutex_ held.
+    bool find_locked(std::string_view key, std::string_view& value);
+    void compact_locked(uint64_t budget);
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,292 @@
+/**
+ * Anime Aggressors Performance Engine - Archetype entity component system
+ * Compile-time component ids, SoA chunk storage and cached queries
+ */
+
+#pragma once
+
+#include "slot_map.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace AnimeAggressors {
+
+class SlabAllocator;
+
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+
+constexpr size_t MAX_COMPONENTS = 64;
+constexpr size_t ECS_CHUNK_BYTES = 16 * 1024;
+
+// A component is any nothrow-movable type that declares its id:
+//
+//   struct VelocityComponent {
+//       static constexpr ComponentId COMPONENT_ID = 1;
+//       Vector3D linear;
+//   };
+//
+// Ids are fixed at compile time, so masks and column lookups need no
+// registration or hashing. Two types claiming the same id are caught the
+// first time the second one is stored.
+template<typename T>
+constexpr ComponentId component_id_of() {
+    static_assert(T::COMPONENT_ID < MAX_COMPONENTS, "COMPONENT_ID must be below MAX_COMPONENTS");
+    return T::COMPONENT_ID;
+}
+
+template<typename... Ts>
+constexpr ComponentMask component_mask() {
+    return (ComponentMask{0} | ... | (ComponentMask{1} << component_id_of<Ts>()));
+}
+
+// Type-erased operations the world needs to move and destroy components
+// without knowing their type.
+struct ComponentInfo {
+    size_t size;
+    size_t alignment;
+    void (*move_construct)(void* destination, void* source);
+    void (*destroy)(void* object);
+};
+
+template<typename T>
+const ComponentInfo& component_info() {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "components must be nothrow move constructible");
+    static const ComponentInfo info{
+        sizeof(T),
+        alignof(T),
+        [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+        [](void* object) { static_cast<T*>(object)->~T(); },
+    };
+    return info;
+}
+
+// All entities with exactly one set of components.
+//
+// Rows are packed into fixed-size chunks; inside a chunk each component has
+// its own 64-byte-aligned array (structure of arrays), followed by nothing
+// but the next column, so a query walks each array linearly. Rows stay dense:
+// removing one moves the archetype's last row into the hole. One empty chunk
+// is kept past the last row so churn around a boundary does not allocate;
+// any further ones go back to the allocator, where another archetype can
+// take them.
+class EcsArchetype {
+public:
+    // Chunks come from `allocator`, or aligned ::operator new without one.
+    EcsArchetype(ComponentMask mask, const std::array<const ComponentInfo*, MAX_COMPONENTS>& infos,
+                 SlabAllocator* allocator = nullptr);
+    ~EcsArchetype();
+
+    EcsArchetype(const EcsArchetype&) = delete;
+    EcsArchetype& operator=(const EcsArchetype&) = delete;
+
+    ComponentMask get_mask() const { return mask_; }
+    uint32_t size() const { return size_; }
+    uint32_t get_chunk_capacity() const { return chunk_capacity_; }
+    size_t get_chunk_count() const { return (size_ + chunk_capacity_ - 1) / chunk_capacity_; }
+    uint32_t get_chunk_rows(size_t chunk) const {
+        const uint32_t first = static_cast<uint32_t>(chunk) * chunk_capacity_;
+        return size_ - first < chunk_capacity_ ? size_ - first : chunk_capacity_;
+    }
+
+    bool has(ComponentId id) const { return (mask_ >> id) & 1u; }
+
+    // Column base for one chunk; only valid when has(id).
+    void* column(size_t chunk, ComponentId id) const { return chunks_[chunk] + offsets_[id]; }
+    template<typename T>
+    T* column(size_t chunk) const { return static_cast<T*>(column(chunk, component_id_of<T>())); }
+    const SlotHandle* entities(size_t chunk) const { return reinterpret_cast<const SlotHandle*>(chunks_[chunk]); }
+
+    void* component(uint32_t row, ComponentId id) const {
+        return chunks_[row / chunk_capacity_] + offsets_[id] + static_cast<size_t>(row % chunk_capacity_) * infos_[id]->size;
+    }
+
+private:
+    friend class EcsWorld;
+
+    ComponentMask mask_;
+    std::vector<ComponentId> components_;
+    std::array<const ComponentInfo*, MAX_COMPONENTS> infos_;
+    std::array<uint32_t, MAX_COMPONENTS> offsets_;
+    uint32_t chunk_capacity_;
+    size_t chunk_bytes_;
+    std::vector<unsigned char*> chunks_;
+    uint32_t size_;
+    SlabAllocator* allocator_;
+
+    // Archetype reached by adding / removing each component, filled lazily.
+    std::array<EcsArchetype*, MAX_COMPONENTS> add_edges_;
+    std::array<EcsArchetype*, MAX_COMPONENTS> remove_edges_;
+
+    // Appends a row for `entity` with its component storage uninitialised.
+    uint32_t push_row(SlotHandle entity);
+    // Destroys the row's components and fills the hole with the last row.
+    // Returns the entity now at `row`, or NULL_SLOT_HANDLE if the row was last.
+    SlotHandle erase_row(uint32_t row);
+    unsigned char* allocate_chunk();
+    void free_chunk(unsigned char* chunk);
+};
+
+// Entities and their components, grouped by archetype.
+//
+// Entity handles come from a SlotMap, so they are generational and a
+// destroyed entity's handle stays dead. Adding or removing a component moves
+// the entity to the archetype for its new set (the transitions are cached on
+// each archetype). Component pointers are valid until the next structural
+// change: create, destroy, add or remove. Archetype chunks come from the
+// SlabAllocator given at construction, if any, which must outlive the world.
+//
+// Queries name the components they need, e.g. each<Entity, VelocityComponent>;
+// the matching archetypes for each mask are cached and only new archetypes
+// are checked on later calls, so a query is a walk over dense arrays. Not
+// thread-safe; callers lock around it.
+class EcsWorld {
+public:
+    EcsWorld();
+    explicit EcsWorld(size_t capacity, SlabAllocator* allocator = nullptr);
+    ~EcsWorld();
+
+    EcsWorld(const EcsWorld&) = delete;
+    EcsWorld& operator=(const EcsWorld&) = delete;
+
+    template<typename... Ts>
+    SlotHandle create(Ts... components) {
+        (register_component<Ts>(), ...);
+        EcsArchetype* archetype = archetype_for(component_mask<Ts...>());
+        const SlotHandle entity = records_.emplace();
+        const uint32_t row = archetype->push_row(entity);
+        (new (archetype->component(row, component_id_of<Ts>())) Ts(std::move(components)), ...);
+        *records_.get(entity) = EntityRecord{archetype, row};
+        return entity;
+    }
+
+    // Returns false for a stale handle.
+    bool destroy(SlotHandle entity);
+    bool alive(SlotHandle entity) const { return records_.contains(entity); }
+
+    // Replaces the component if the entity already has one. Returns nullptr
+    // for a stale handle.
+    template<typename T>
+    T* add(SlotHandle entity, T component) {
+        register_component<T>();
+        constexpr ComponentId id = component_id_of<T>();
+        EntityRecord* record = records_.get(entity);
+        if (record == nullptr) return nullptr;
+        if (record->archetype->has(id)) {
+            T* existing = static_cast<T*>(record->archetype->component(record->row, id));
+            *existing = std::move(component);
+            return existing;
+        }
+        EcsArchetype* target = record->archetype->add_edges_[id];
+        if (target == nullptr) {
+            target = archetype_for(record->archetype->get_mask() | (ComponentMask{1} << id));
+            record->archetype->add_edges_[id] = target;
+        }
+        move_entity(entity, *record, target);
+        return new (target->component(record->row, id)) T(std::move(component));
+    }
+
+    template<typename T>
+    bool remove(SlotHandle entity) {
+        constexpr ComponentId id = component_id_of<T>();
+        EntityRecord* record = records_.get(entity);
+        if (record == nullptr || !record->archetype->has(id)) return false;
+        EcsArchetype* target = record->archetype->remove_edges_[id];
+        if (target == nullptr) {
+            target = archetype_for(record->archetype->get_mask() & ~(ComponentMask{1} << id));
+            record->archetype->remove_edges_[id] = target;
+        }
+        move_entity(entity, *record, target);
+        return true;
+    }
+
+    template<typename T>
+    T* get(SlotHandle entity) {
+        constexpr ComponentId id = component_id_of<T>();
+        const EntityRecord* record = records_.get(entity);
+        if (record == nullptr || !record->archetype->has(id)) return nullptr;
+        return static_cast<T*>(record->archetype->component(record->row, id));
+    }
+
+    template<typename T>
+    bool has(SlotHandle entity) const {
+        const EntityRecord* record = records_.get(entity);
+        return record != nullptr && record->archetype->has(component_id_of<T>());
+    }
+
+    // f(Ts&...) for every entity that has all of Ts.
+    template<typename... Ts, typename F>
+    void each(F&& f) {
+        for (EcsArchetype* archetype : query(component_mask<Ts...>())) {
+            for (size_t chunk = 0; chunk < archetype->get_chunk_count(); ++chunk) {
+                const uint32_t rows = archetype->get_chunk_rows(chunk);
+                auto columns = std::make_tuple(archetype->column<Ts>(chunk)...);
+                for (uint32_t i = 0; i < rows; ++i) {
+                    f(std::get<Ts*>(columns)[i]...);
+                }
+            }
+        }
+    }
+
+    // f(rows, entities, Ts*...) once per matching chunk, for loops that
+    // want the raw column arrays (batch math, SIMD).
+    template<typename... Ts, typename F>
+    void each_chunk(F&& f) {
+        for (EcsArchetype* archetype : query(component_mask<Ts...>())) {
+            for (size_t chunk = 0; chunk < archetype->get_chunk_count(); ++chunk) {
+                f(archetype->get_chunk_rows(chunk), archetype->entities(chunk), archetype->column<Ts>(chunk)...);
+            }
+        }
+    }
+
+    // Archetypes containing every component in `mask`, cached per mask.
+    const std::vector<EcsArchetype*>& query(ComponentMask mask);
+
+    size_t size() const { return records_.size(); }
+    size_t get_archetype_count() const { return archetypes_.size(); }
+
+private:
+    struct EntityRecord {
+        EcsArchetype* archetype;
+        uint32_t row;
+    };
+
+    struct QueryCache {
+        std::vector<EcsArchetype*> archetypes;
+        size_t scanned = 0;   // prefix of archetypes_ already matched
+    };
+
+    SlotMap<EntityRecord> records_;
+    std::vector<std::unique_ptr<EcsArchetype>> archetypes_;
+    std::unordered_map<ComponentMask, EcsArchetype*> archetype_index_;
+    std::unordered_map<ComponentMask, QueryCache> queries_;
+    std::array<const ComponentInfo*, MAX_COMPONENTS> infos_;
+    SlabAllocator* allocator_;
+
+    template<typename T>
+    void register_component() {
+        constexpr ComponentId id = component_id_of<T>();
+        const ComponentInfo* info = &component_info<T>();
+        if (infos_[id] == info) return;
+        if (infos_[id] != nullptr) {
+            throw std::logic_error("EcsWorld: two component types share COMPONENT_ID " + std::to_string(id));
+        }
+        infos_[id] = info;
+    }
+
+    EcsArchetype* archetype_for(ComponentMask mask);
+    void move_entity(SlotHandle entity, EntityRecord& record, EcsArchetype* target);
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,68 @@
+/**
+ * Anime Aggressors Performance Engine - Fixed timestep
+ * Accumulator that turns variable frame deltas into fixed simulation steps
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace AnimeAggressors {
+
+// Simulation rate shared with the native engine (aa::SIM_HZ in
+// native/engine/include/aa/simulation.hpp); keep the two in step.
+constexpr uint32_t SIM_HZ = 60;
+constexpr uint32_t MAX_SIM_SUBSTEPS = 4;
+constexpr uint32_t MAX_STEP_HZ = 1000;
+
+// Splits wall-clock frame time into whole simulation steps of 1/step_hz.
+//
+// advance() adds the frame's delta to an accumulator and returns how many
+// steps to run; the remainder carries into the next frame and, as a fraction
+// of a step, is the alpha a renderer blends the previous and current
+// simulation states by. Time is accumulated in integer nanosecond units, so
+// a given sequence of deltas always yields the same step counts.
+//
+// At most max_substeps run per frame. When a frame falls further behind than
+// that (a hitch, a debugger break) the excess whole steps are dropped rather
+// than queued, so a slow frame can't schedule an even slower one.
+//
+// Deterministic mode ignores the delta: every advance() is exactly one
+// SIM_HZ step, as in the native simulation, so state depends only on the
+// number of frames and their inputs. The caller paces frames at SIM_HZ.
+class FixedTimestep {
+public:
+    struct Config {
+        uint32_t step_hz = SIM_HZ;
+        uint32_t max_substeps = MAX_SIM_SUBSTEPS;
+        bool deterministic = false;
+    };
+
+    FixedTimestep();
+    // Throws std::invalid_argument unless 0 < step_hz <= MAX_STEP_HZ and
+    // max_substeps > 0.
+    explicit FixedTimestep(const Config& config);
+
+    // Applies `config` and empties the accumulator; tick counts are kept.
+    void configure(const Config& config);
+    void reset();
+
+    // Returns the number of steps to run for a frame of `frame_seconds`.
+    // Negative or NaN deltas count as zero.
+    uint32_t advance(double frame_seconds);
+
+    float get_step_seconds() const;
+    // Leftover time as a fraction of a step, in [0, 1]; 0 in deterministic mode.
+    float get_alpha() const;
+    uint64_t get_tick() const { return tick_; }
+    uint64_t get_dropped_steps() const { return dropped_steps_; }
+    const Config& get_config() const { return config_; }
+
+private:
+    Config config_;
+    uint64_t accumulator_;     // nanoseconds * step_hz; one step is 1e9
+    uint64_t tick_;
+    uint64_t dropped_steps_;
+};
+
+} // namespace AnimeAggressors
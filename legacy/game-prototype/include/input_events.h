@@ -0,0 +1,46 @@
+/**
+ * Anime Aggressors Performance Engine - Input events
+ * Dense key codes and timestamped device events for InputSystem
+ */
+
+#pragma once
+
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace AnimeAggressors {
+
+constexpr size_t MAX_INPUT_KEYS = 512;
+constexpr size_t INPUT_EVENT_CAPACITY = 4096;    // queued between frames
+
+// A key name interned by InputSystem::intern_key(), from 0 up.
+using KeyCode = uint16_t;
+constexpr KeyCode NO_KEY = UINT16_MAX;
+
+using KeyBits = std::bitset<MAX_INPUT_KEYS>;
+
+enum class InputEventType : uint8_t {
+    KEY_DOWN,
+    KEY_UP,
+    MOUSE_MOVE,
+};
+
+struct InputEvent {
+    InputEventType type;
+    KeyCode key;              // NO_KEY for mouse events
+    float x;                  // mouse position
+    float y;
+    uint64_t timestamp_ns;    // input_timestamp_now() when the device saw it
+};
+
+// Monotonic nanoseconds; the clock every input timestamp and frame deadline
+// is on.
+inline uint64_t input_timestamp_now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,101 @@
+/**
+ * Anime Aggressors Performance Engine - Fixed-size block pools
+ * Lock-free intrusive free list with configurable alignment
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace AnimeAggressors {
+
+// Fixed-size block allocator over one aligned arena.
+//
+// Free blocks form an intrusive singly linked list: the first four bytes of a
+// free block hold the index of the next free block, so the pool itself never
+// allocates after construction. The list head is a 64-bit word packing the
+// head index with a modification tag; allocate()/deallocate() are a single
+// CAS loop and the tag defeats ABA when a block is popped and pushed back
+// between another thread's load and CAS.
+class MemoryPool {
+public:
+    MemoryPool(size_t block_size, size_t block_count,
+               size_t alignment = alignof(std::max_align_t));
+    ~MemoryPool();
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    // Returns nullptr when the pool is exhausted.
+    void* allocate();
+    // `ptr` must have come from this pool's allocate(); nullptr is ignored.
+    void deallocate(void* ptr);
+
+    size_t get_available_blocks() const;
+    size_t get_total_blocks() const;
+    size_t get_block_size() const;
+    size_t get_alignment() const;
+    bool owns(const void* ptr) const;
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    size_t block_size_;
+    size_t block_count_;
+    size_t alignment_;
+    char* memory_;
+
+    // Low 32 bits: index of the first free block (NIL when empty).
+    // High 32 bits: tag bumped on every successful pop/push.
+    std::atomic<uint64_t> head_;
+    std::atomic<size_t> available_;
+
+    char* block_at(uint32_t index) const { return memory_ + static_cast<size_t>(index) * block_size_; }
+    uint32_t index_of(const void* ptr) const {
+        return static_cast<uint32_t>((static_cast<const char*>(ptr) - memory_) / block_size_);
+    }
+    static uint64_t pack(uint32_t index, uint32_t tag) {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+};
+
+// Typed wrapper that constructs and destroys T in MemoryPool blocks.
+template<typename T>
+class ObjectPool {
+public:
+    explicit ObjectPool(size_t capacity)
+        : pool_(sizeof(T), capacity, alignof(T) > alignof(std::max_align_t) ? alignof(T) : alignof(std::max_align_t)) {}
+
+    // Returns nullptr when the pool is exhausted. If T's constructor throws
+    // the block is returned to the pool before the exception propagates.
+    template<typename... Args>
+    T* create(Args&&... args) {
+        void* block = pool_.allocate();
+        if (block == nullptr) return nullptr;
+        try {
+            return new (block) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool_.deallocate(block);
+            throw;
+        }
+    }
+
+    void destroy(T* object) {
+        if (object == nullptr) return;
+        object->~T();
+        pool_.deallocate(object);
+    }
+
+    size_t available() const { return pool_.get_available_blocks(); }
+    size_t capacity() const { return pool_.get_total_blocks(); }
+    bool owns(const T* object) const { return pool_.owns(object); }
+
+private:
+    MemoryPool pool_;
+};
+
+} // namespace AnimeAggressors
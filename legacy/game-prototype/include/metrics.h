@@ -0,0 +1,120 @@
+/**
+ * Anime Aggressors Performance Engine - Lock-free metrics registry
+ * Per-thread counter and HDR histogram shards merged on read
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AnimeAggressors {
+
+using MetricId = uint32_t;
+
+constexpr size_t MAX_METRIC_THREADS = 64;
+
+// Merged contents of one histogram.
+//
+// Buckets are log-linear in microseconds (HDR layout): values below 128 get
+// one bucket each, and every power-of-two range above that is split into 64
+// equal buckets, so any recorded value is reported within 1/64 (~1.6%) of
+// its true value. Values above MAX_VALUE (about 71 minutes) are clamped.
+struct HistogramSnapshot {
+    static constexpr uint64_t MAX_VALUE = (uint64_t{1} << 32) - 1;
+    static constexpr size_t BUCKET_COUNT = 1728;
+
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets;
+
+    // Highest value in the bucket holding the given percentile (0-100),
+    // capped at max. Returns 0 for an empty histogram.
+    uint64_t value_at_percentile(double percentile) const;
+    double mean() const;
+
+    static size_t bucket_of(uint64_t value);
+    static uint64_t bucket_upper(size_t bucket);
+};
+
+// Named counters, gauges and histograms with a lock-free record path.
+//
+// Each thread that records gets its own shard of every counter and
+// histogram, claimed from MAX_METRIC_THREADS process-wide ThreadSlots
+// slots (see thread_slots.h). Only the owning thread writes a
+// shard, so a record is a relaxed load/store pair with no read-modify-write
+// and no shared cache lines; readers sum the shards. Threads beyond the slot
+// limit fall back to one shared shard updated with atomic adds. Gauges hold a
+// single last-written value.
+//
+// Registration takes a mutex and is meant for startup. Registering a name
+// that already exists as the same kind returns its id; a name clash with
+// another kind, or running out of ids, throws std::runtime_error. Ids are
+// only meaningful for the kind they were registered as.
+class MetricsRegistry {
+public:
+    enum class Kind {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM,
+    };
+
+    struct Series {
+        std::string name;
+        Kind kind;
+        MetricId id;
+    };
+
+    explicit MetricsRegistry(size_t max_counters = 1024, size_t max_gauges = 1024, size_t max_histograms = 64);
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    MetricId register_counter(const std::string& name);
+    MetricId register_gauge(const std::string& name);
+    MetricId register_histogram(const std::string& name);
+
+    // A thread's first record allocates its shard, and its first record into
+    // each histogram allocates that histogram's buckets; after that nothing
+    // allocates or locks.
+    void add(MetricId counter, uint64_t delta = 1);
+    void set(MetricId gauge, double value);
+    void record(MetricId histogram, uint64_t value_us);
+    void record_seconds(MetricId histogram, double seconds);
+
+    uint64_t get_counter(MetricId counter) const;
+    double get_gauge(MetricId gauge) const;
+    HistogramSnapshot get_histogram(MetricId histogram) const;
+    std::vector<Series> get_series() const;
+
+private:
+    struct HistogramShard;
+    struct ThreadShard;
+
+    size_t max_counters_;
+    size_t max_gauges_;
+    size_t max_histograms_;
+
+    std::atomic<ThreadShard*> shards_[MAX_METRIC_THREADS];
+    std::unique_ptr<ThreadShard> shared_shard_;
+    std::unique_ptr<std::atomic<double>[]> gauges_;
+
+    mutable std::mutex registry_mutex_;
+    std::vector<Series> series_;
+    size_t counter_count_;
+    size_t gauge_count_;
+    size_t histogram_count_;
+
+    ThreadShard* local_shard();
+    HistogramShard* histogram_shard(ThreadShard& shard, MetricId histogram);
+    MetricId register_series(const std::string& name, Kind kind, size_t& count, size_t limit);
+};
+
+} // namespace AnimeAggressors
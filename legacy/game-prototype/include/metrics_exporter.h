@@ -0,0 +1,116 @@
+/**
+ * Anime Aggressors Performance Engine - Background metrics exporter
+ * OpenMetrics snapshots of a MetricsRegistry to a file, Unix socket or loopback HTTP
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AnimeAggressors {
+
+class MetricsRegistry;
+
+constexpr std::chrono::milliseconds METRICS_EXPORT_INTERVAL{1000};
+
+// Periodically renders every series in a MetricsRegistry as OpenMetrics text
+// on its own thread (POSIX).
+//
+// The exporter only reads the registry's shards, so recording threads never
+// wait on it. Counters export as `<name>_total`, gauges as-is, and histograms
+// as summaries with 0.5/0.95/0.99 quantiles plus a `<name>_max` gauge, all
+// under an optional name prefix.
+//
+// Each snapshot renders into a fresh buffer and is then published by
+// swapping a shared pointer: connections still sending the previous snapshot
+// keep it alive, so a slow scraper never delays the next one. Each snapshot
+// is also written to `file_path` through a temporary file and rename(), when
+// set. Sockets are served from the same thread with non-blocking I/O:
+//   - `http_port` >= 0 listens on 127.0.0.1 (0 picks a free port) and answers
+//     any HTTP request with the latest snapshot;
+//   - `unix_socket_path` accepts stream connections and writes the latest
+//     snapshot straight away, then closes.
+// A connection that neither sends nor receives anything for one `interval`
+// is closed, so clients that connect and go quiet cannot hold every slot.
+//
+// Throws std::runtime_error if a listener cannot be set up.
+class MetricsExporter {
+public:
+    struct Options {
+        std::chrono::milliseconds interval = METRICS_EXPORT_INTERVAL;
+        std::string prefix;             // prepended to every metric name
+        std::string file_path;          // empty: no file output
+        std::string unix_socket_path;   // empty: no Unix socket
+        int http_port = -1;             // -1: no HTTP listener
+    };
+
+    struct Stats {
+        uint64_t snapshots;
+        uint64_t series;                // in the latest snapshot
+        uint64_t bytes;                 // size of the latest snapshot
+        double last_render_ms;
+        uint64_t scrapes;               // responses fully sent
+        uint64_t write_errors;          // failed file writes
+        uint64_t idle_closes;           // connections dropped for going quiet
+    };
+
+    MetricsExporter(MetricsRegistry& registry, const Options& options);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // The port actually bound, or 0 without an HTTP listener.
+    uint16_t get_http_port() const;
+    // Latest published snapshot (empty before the first one).
+    std::shared_ptr<const std::string> latest() const;
+    Stats get_stats() const;
+
+private:
+    struct Connection;
+
+    MetricsRegistry& registry_;
+    Options options_;
+
+    int http_fd_;
+    int unix_fd_;
+    uint16_t http_port_;
+    int wake_pipe_[2];
+    std::vector<Connection> connections_;
+
+    // Sanitized, prefixed names by position in MetricsRegistry::get_series();
+    // the registry only appends, so this only grows.
+    std::vector<std::string> names_;
+
+    mutable std::mutex latest_mutex_;
+    std::shared_ptr<const std::string> latest_;
+
+    std::atomic<uint64_t> snapshots_;
+    std::atomic<uint64_t> series_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<double> last_render_ms_;
+    std::atomic<uint64_t> scrapes_;
+    std::atomic<uint64_t> write_errors_;
+    std::atomic<uint64_t> idle_closes_;
+
+    std::atomic<bool> stopping_;
+    std::thread thread_;
+
+    void run();
+    void export_snapshot();
+    std::shared_ptr<const std::string> render();
+    void write_file(const std::string& text);
+    void accept_connections(int listen_fd, bool http);
+    // Returns false once the connection is finished and closed.
+    bool service(Connection& connection);
+    void close_fds();
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,207 @@
+/**
+ * Anime Aggressors Performance Engine - Motion input
+ * Command definitions compiled into one DFA over packed stick/button frames
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AnimeAggressors {
+
+constexpr uint32_t NO_MOTION_COMMAND = UINT32_MAX;
+constexpr uint8_t MOTION_DEFAULT_WINDOW = 3;       // inputs from one step to the next
+constexpr uint8_t MOTION_CHARGE_FRAMES = 40;
+constexpr uint16_t MOTION_TIMEOUT_FRAMES = 10;     // one input held this long ends partial motions
+constexpr size_t MAX_MOTION_CHARGES = 8;           // distinct charge conditions per automaton
+constexpr size_t MAX_MOTION_TABLE_BYTES = size_t(4) << 20;  // states and transitions cached before a flush
+
+// Buttons, one bit each. P and K are "any punch" and "any kick".
+enum MotionButton : uint8_t {
+    MOTION_LP = 1u << 0,
+    MOTION_MP = 1u << 1,
+    MOTION_HP = 1u << 2,
+    MOTION_LK = 1u << 3,
+    MOTION_MK = 1u << 4,
+    MOTION_HK = 1u << 5,
+    MOTION_PUNCH = MOTION_LP | MOTION_MP | MOTION_HP,
+    MOTION_KICK = MOTION_LK | MOTION_MK | MOTION_HK,
+};
+
+// Stick directions in numpad notation, 1-9 with 5 neutral, as one bit each
+// so a step can accept several.
+constexpr uint16_t motion_direction(uint8_t numpad) { return static_cast<uint16_t>(1u << numpad); }
+constexpr uint16_t MOTION_ANY_DIRECTION = 0x3FE;
+
+// One step of a command. The stick must be in `directions`; if `buttons`
+// is set, one of them must have gone down, or for a chord all of them must
+// be held with at least one new. A charge step instead needs the stick to
+// have stayed in `directions` for `charge_frames` frames.
+//
+// Time is counted in inputs: a new stick direction, a button going down or
+// a charge filling or emptying is one, and frames between are not. Except
+// for the first, a step must match within `window` inputs of the last one
+// the step before it matched, so the default of 3 lets two strays slip in
+// between. Holding anything but the next step for the automaton's timeout
+// ends the partial motion instead. Holding a step keeps it matched, so a
+// double tap is written with the neutral between, "656".
+struct MotionStep {
+    uint16_t directions = MOTION_ANY_DIRECTION;
+    uint8_t buttons = 0;
+    bool chord = false;
+    uint8_t charge_frames = 0;
+    uint8_t window = MOTION_DEFAULT_WINDOW;
+};
+
+// Steps are written for a fighter facing right. When several commands
+// complete on the same frame the highest priority wins, then the longest.
+struct MotionCommand {
+    uint32_t move_id = 0;
+    std::vector<MotionStep> steps;
+    uint8_t priority = 0;
+};
+
+// Builds a command from numpad notation: digits are stick steps, "[4]" a
+// charge of MOTION_CHARGE_FRAMES towards 4 (1, 4 and 7; "[2]" is 1, 2 and
+// 3), LP/MP/HP/LK/MK/HK/P/K are button presses, "+" joins a button to the
+// stick step before it and buttons into a chord. "236P", "[4]6+P",
+// "41236HK", "LP+LK". Throws std::invalid_argument on anything else.
+MotionCommand parse_motion_command(uint32_t move_id, const std::string& notation, uint8_t priority = 0);
+
+// One frame of a player's controls. `direction` is the numpad direction on
+// screen; facing left mirrors it before matching.
+struct MotionInput {
+    uint8_t direction = 5;
+    uint8_t buttons = 0;       // MotionButton bits held this frame
+    bool facing_left = false;
+};
+
+// Where one player is in an automaton; the automaton itself is shared.
+struct MotionReader {
+    uint32_t state = 0;
+    uint32_t generation = 0;
+    uint32_t stick = UINT32_MAX;       // last input's stick and charges
+    uint16_t held_frames = 0;          // frames it has lasted
+    uint8_t held_buttons = 0;
+    uint8_t charge[MAX_MOTION_CHARGES] = {};
+};
+
+// Compiled command set for any number of move lists
+//
+// Commands go into a trie of shared step prefixes. A frame is reduced to a
+// symbol class: the stick and the buttons pressed and held each go through
+// a table to the classes no step tells apart, and those combine with the
+// bits of the charges that are full into one class id. Matching is a
+// subset construction over classes: a state is the set of trie nodes that
+// a next step may still follow, each with the inputs since it matched, and
+// a transition is taken only on a new input, or once when one has been
+// held for the timeout, so holding a direction costs nothing.
+//
+// Every mix of partial motions is a state. A state keeps a node only while
+// one of its children could still follow, or for one input after matching
+// to catch a held repeat, so states that differ only in stale leniency
+// are one state. There are still far too many to build ahead of time (a
+// 24-command list reaches tens of thousands in play, out of more than
+// could be enumerated), so states are built lazily: a transition is worked
+// out from the trie the first time it is taken and is a hash lookup from
+// then on. Play keeps revisiting a small set of states, so after warm-up a
+// frame costs the class lookup, a counter per charge condition and at most
+// one probe, the same for ten commands or a thousand; only new input
+// sequences pay for an expansion. State keys live in one flat array with
+// an open-addressed index, and with the transitions they stay within
+// MAX_MOTION_TABLE_BYTES: at the limit the table is flushed and readers on
+// the old states start over. step() fills the table, so one thread steps
+// an automaton at a time; any number of players can share it, with a
+// MotionReader each.
+class MotionAutomaton {
+public:
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t transitions_taken = 0;
+        uint64_t expansions = 0;       // transitions worked out from the trie
+        uint64_t flushes = 0;
+        size_t states = 0;
+        size_t transitions = 0;
+        size_t classes = 0;
+        size_t table_bytes = 0;        // every table, the cached states and transitions included
+    };
+
+    // Recognizes nothing.
+    MotionAutomaton();
+    // Throws std::invalid_argument on a command with no steps or a bad step
+    // or a timeout under 2 frames, and std::length_error past
+    // MAX_MOTION_CHARGES.
+    explicit MotionAutomaton(const std::vector<MotionCommand>& commands,
+                             uint16_t timeout_frames = MOTION_TIMEOUT_FRAMES);
+
+    // Advances the reader by one frame. Returns the index of the command
+    // completed this frame, or NO_MOTION_COMMAND. A command fires once per
+    // completion; holding its last step does not repeat it.
+    uint32_t step(MotionReader& reader, const MotionInput& input);
+
+    const MotionCommand& get_command(uint32_t index) const { return commands_[index]; }
+    size_t get_command_count() const { return commands_.size(); }
+    Stats get_stats() const;
+
+private:
+    struct Charge {
+        uint16_t directions;
+        uint8_t frames;
+    };
+
+    struct Node {
+        uint32_t predicate;
+        uint8_t window;            // inputs allowed since the parent matched
+        uint8_t expiry;            // age past which no child can match
+        uint32_t command;          // completed here, or NO_MOTION_COMMAND
+        uint32_t first_child;
+        uint32_t child_count;
+    };
+
+    bool outranks(uint32_t a, uint32_t b) const;
+    void reset_states();
+    uint32_t find_state(const std::vector<uint32_t>& key) const;
+    bool state_fits(size_t words) const;
+    uint32_t add_state(const std::vector<uint32_t>& key);
+    void index_state(uint32_t id);
+    uint32_t find_transition(uint64_t key) const;
+    void add_transition(uint64_t key, uint32_t target);
+    uint32_t expand(uint32_t state, uint32_t symbol);
+    uint32_t intern(uint32_t state, uint32_t symbol, uint32_t fired);
+
+    std::vector<MotionCommand> commands_;
+    std::vector<Charge> charges_;
+    std::vector<Node> nodes_;                 // the trie; 0 is the root
+    std::vector<uint32_t> children_;
+    uint32_t predicate_count_ = 0;
+    std::vector<uint8_t> class_matches_;      // class * predicate_count_ + predicate
+
+    uint8_t direction_class_[16] = {};
+    std::vector<uint16_t> button_class_;      // pressed << 6 | held
+    std::vector<uint32_t> symbol_class_;      // (direction, buttons, full charges) -> class
+    uint32_t button_classes_ = 1;
+    uint32_t charge_classes_ = 1;
+    uint32_t class_count_ = 1;                // the timeout is class class_count_
+    uint16_t timeout_frames_ = MOTION_TIMEOUT_FRAMES;
+
+    std::vector<uint32_t> state_items_;       // every state's key, back to back
+    std::vector<uint32_t> state_offsets_;     // state's key starts here and ends at the next one's
+    std::vector<uint32_t> state_slots_;       // state ids by key hash, open addressing
+    std::vector<uint64_t> transition_keys_;   // state << 32 | class, open addressing
+    std::vector<uint32_t> transition_targets_;
+    size_t transition_count_ = 0;
+    std::vector<uint32_t> accepts_;           // command fired on entering the state
+    uint32_t generation_ = 0;
+    Stats stats_;
+
+    // expand() scratch
+    std::vector<uint16_t> live_ages_;
+    std::vector<uint8_t> matched_last_;
+    std::vector<uint32_t> live_;
+    std::vector<uint32_t> key_;
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,83 @@
+/**
+ * Anime Aggressors Performance Engine - Multi-producer single-consumer ring
+ * Bounded lock-free queue from any number of threads to one reader
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AnimeAggressors {
+
+// Fixed-capacity FIFO that many threads push to and one thread pops from.
+//
+// Each cell carries a sequence number saying whose turn it is: producers
+// claim a cell by advancing the shared tail with a compare-exchange, write
+// the value and publish it by bumping the sequence; the consumer takes
+// cells in order once published and hands them back a lap ahead. Neither
+// side blocks or allocates; try_push() fails when full and try_pop() when
+// the next cell is empty or still being written. Capacity is rounded up to
+// a power of two. T must be copyable.
+template<typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        cells_.reset(new Cell[rounded]);
+        for (size_t i = 0; i < rounded; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        mask_ = rounded - 1;
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Any thread.
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[tail & mask_];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(tail);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;    // a lap behind: the consumer has not freed this cell
+            } else {
+                tail = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer only.
+    bool try_pop(T& out) {
+        Cell& cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) return false;
+        out = cell.value;
+        cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> tail_{0};    // next cell to claim, shared by producers
+    alignas(64) size_t head_ = 0;                 // next cell to pop, consumer only
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,132 @@
+/**
+ * Anime Aggressors Performance Engine - Particle system
+ * Fixed-capacity SoA particle pool with emitters and batched, parallel update
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "batch_math.h"
+#include "slot_map.h"
+
+namespace AnimeAggressors {
+
+class ThreadPool;
+
+using ParticleEmitterId = SlotHandle;
+
+// Spawn parameters. Each particle starts at `position` with `velocity` plus a
+// uniform random offset of up to `velocity_spread` per axis, lives
+// `lifetime` +/- `lifetime_spread` seconds and fades linearly from
+// `start_color` to `end_color` (RGBA) over that life.
+struct ParticleEmitterDesc {
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float velocity[3] = {0.0f, 1.0f, 0.0f};
+    float velocity_spread[3] = {0.5f, 0.5f, 0.5f};
+    float start_color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float end_color[4] = {1.0f, 1.0f, 1.0f, 0.0f};
+    float lifetime = 1.0f;
+    float lifetime_spread = 0.0f;
+    float rate = 0.0f;               // particles per second; 0 for bursts only
+    float gravity_scale = 1.0f;
+};
+
+// Borrowed views of the live particles' streams, valid until the next
+// update(); hand them straight to the renderer.
+struct ParticleRenderData {
+    const float* position[3];
+    const float* color[4];
+    size_t count;
+};
+
+// Live particles in one block of SoA float streams, allocated once at
+// construction.
+//
+// update() emits, then integrates velocity, position, color and remaining
+// life with the batch math kernels, in ranges fanned out over the pool, then
+// swap-compacts dead particles so the live ones stay packed at the front.
+// Nothing allocates after construction (or after the first update with a
+// new pool). Emission beyond capacity is dropped
+// and counted. Order is not stable across updates.
+class ParticleSystem {
+public:
+    struct Stats {
+        size_t alive = 0;
+        size_t spawned = 0;      // last update, including bursts since the one before
+        size_t died = 0;
+        size_t dropped = 0;      // spawns refused at capacity
+        size_t tasks = 0;
+        double emit_us = 0.0;
+        double simulate_us = 0.0;
+        double compact_us = 0.0;
+    };
+
+    explicit ParticleSystem(size_t capacity, uint32_t seed = 1);
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // Throws std::invalid_argument for a non-positive lifetime.
+    ParticleEmitterId add_emitter(const ParticleEmitterDesc& desc);
+    bool remove_emitter(ParticleEmitterId emitter);
+    // Returns nullptr for a removed emitter. Edits apply to later spawns.
+    ParticleEmitterDesc* get_emitter(ParticleEmitterId emitter);
+    // Spawns `count` particles from `emitter` at once; returns how many fit.
+    size_t burst(ParticleEmitterId emitter, size_t count);
+    void clear();
+
+    void set_gravity(const float gravity[3]);
+    // Ranges of the update fan out over `pool`; null runs on the caller.
+    void set_thread_pool(ThreadPool* pool);
+
+    void update(float delta_time);
+
+    ParticleRenderData get_render_data() const;
+    size_t size() const { return count_; }
+    size_t capacity() const { return capacity_; }
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    enum Stream : size_t {
+        POSITION_X, POSITION_Y, POSITION_Z,
+        VELOCITY_X, VELOCITY_Y, VELOCITY_Z,
+        COLOR_R, COLOR_G, COLOR_B, COLOR_A,
+        FADE_R, FADE_G, FADE_B, FADE_A,    // color change per second
+        LIFE,                              // seconds left
+        GRAVITY_SCALE,
+        STREAM_COUNT
+    };
+
+    struct Emitter {
+        ParticleEmitterDesc desc;
+        float pending = 0.0f;    // fractional particles carried between updates
+    };
+
+    size_t capacity_;
+    size_t stride_;              // floats per stream, padded to a cache line
+    std::vector<float> streams_;
+    float* base_;                // streams_ rounded up to a cache line
+    std::vector<uint32_t> dead_;          // dead indices, each range in its own slice
+    std::vector<size_t> range_dead_;      // dead count per range
+    size_t count_;
+    SlotMap<Emitter> emitters_;
+    float gravity_[3];
+    ThreadPool* thread_pool_;
+    uint32_t rng_state_;
+    size_t pending_spawned_;
+    size_t pending_dropped_;
+    Stats stats_;
+
+    float* stream(Stream s) { return base_ + s * stride_; }
+    const float* stream(Stream s) const { return base_ + s * stride_; }
+    size_t spawn(const ParticleEmitterDesc& desc, size_t count);
+    float random_signed();
+    // Returns how many particles in the range died.
+    size_t simulate(size_t begin, size_t end, float delta_time);
+    size_t compact(size_t ranges, size_t chunk);
+};
+
+} // namespace AnimeAggressors
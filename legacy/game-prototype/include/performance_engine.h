@@ -15,10 +15,32 @@
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <map>
 #include <functional>
 #include <future>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
+
+#include "async_cache.h"
+#include "audio_mixer.h"
+#include "batch_math.h"
+#include "cache_system.h"
+#include "disk_cache.h"
+#include "ecs.h"
+#include "fixed_timestep.h"
+#include "frame_graph.h"
+#include "input_events.h"
+#include "memory_pool.h"
+#include "metrics.h"
+#include "metrics_exporter.h"
+#include "motion_input.h"
+#include "particle_system.h"
+#include "physics_world.h"
+#include "render_commands.h"
+#include "slab_allocator.h"
+#include "thread_pool.h"
+#include "visibility.h"
 
 namespace AnimeAggressors {
 
@@ -30,17 +52,19 @@ class AudioEngine;
 class PhysicsEngine;
 class AIEngine;
 class MemoryPool;
+class SlabAllocator;
 class ThreadPool;
 class CacheSystem;
 class Analytics;
+template<typename T> class MpscRing;
 
 // Performance optimization constants
 constexpr size_t MAX_ENTITIES = 10000;
 constexpr size_t MAX_PARTICLES = 50000;
 constexpr size_t MAX_SOUNDS = 1000;
+constexpr size_t MAX_REAL_SOUNDS = 64;      // mixed at once; the rest play virtually
 constexpr size_t MAX_ANIMATIONS = 1000;
-constexpr size_t CACHE_SIZE = 1000;
-constexpr size_t THREAD_POOL_SIZE = std::thread::hardware_concurrency();
+constexpr uint32_t MEMORY_REPORT_FRAMES = 60;   // update()s between allocator samples
 
 // High-performance data structures
 struct Vector3D {
@@ -89,26 +113,66 @@ struct Transform {
     Transform() : scale(1.0f, 1.0f, 1.0f) {}
 };
 
+// Core per-entity data, stored as ECS component 0 in PerformanceEngine's
+// world. Everything else an entity carries is a further component.
 struct Entity {
+    static constexpr ComponentId COMPONENT_ID = 0;
+    
     uint32_t id;
     Transform transform;
     bool active;
     uint32_t type;
-    std::unordered_map<std::string, void*> components;
     
     Entity() : id(0), active(false), type(0) {}
 };
 
+struct VelocityComponent {
+    static constexpr ComponentId COMPONENT_ID = 1;
+    
+    Vector3D linear;
+};
+
+// What to draw an entity with. Entities without one draw mesh `type` with
+// material 0 on the opaque layer. Meshes `mesh` to `mesh + lod_count - 1`
+// are the entity's LOD chain, most detailed first.
+struct RenderableComponent {
+    static constexpr ComponentId COMPONENT_ID = 2;
+    
+    uint32_t mesh = 0;
+    uint32_t material = 0;
+    uint8_t layer = RENDER_LAYER_OPAQUE;
+    uint8_t lod_count = 1;
+};
+
+// Point-in-time copy of Analytics. Frame-time percentiles come from the
+// frame_time_us histogram and are whole microseconds.
 struct PerformanceMetrics {
-    std::atomic<uint64_t> frame_count{0};
-    std::atomic<double> fps{0.0};
-    std::atomic<double> frame_time{0.0};
-    std::atomic<uint64_t> entity_count{0};
-    std::atomic<uint64_t> particle_count{0};
-    std::atomic<uint64_t> draw_calls{0};
-    std::atomic<uint64_t> memory_usage{0};
-    std::atomic<uint64_t> cache_hits{0};
-    std::atomic<uint64_t> cache_misses{0};
+    uint64_t frame_count = 0;
+    double fps = 0.0;
+    double frame_time = 0.0;
+    uint64_t entity_count = 0;
+    uint64_t particle_count = 0;
+    uint64_t draw_calls = 0;
+    uint64_t visible_entities = 0;
+    uint64_t culled_entities = 0;
+    uint64_t audio_voices = 0;
+    uint64_t audio_virtual_voices = 0;
+    double audio_block_us = 0.0;
+    uint64_t memory_usage = 0;
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    uint64_t frame_time_p50_us = 0;
+    uint64_t frame_time_p95_us = 0;
+    uint64_t frame_time_p99_us = 0;
+    uint64_t frame_time_max_us = 0;
+    uint64_t input_latency_p50_us = 0;
+    uint64_t input_latency_p99_us = 0;
+};
+
+struct MemoryClassUsage {
+    uint32_t block_size; // 0 for allocations outside any size class
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
 };
 
 struct PerformanceAlert {
@@ -119,77 +183,11 @@ struct PerformanceAlert {
     bool resolved;
 };
 
-// High-performance memory pool
-class MemoryPool {
-public:
-    MemoryPool(size_t block_size, size_t block_count);
-    ~MemoryPool();
-    
-    void* allocate();
-    void deallocate(void* ptr);
-    size_t get_available_blocks() const;
-    size_t get_total_blocks() const;
-    
-private:
-    size_t block_size_;
-    size_t block_count_;
-    std::vector<char> memory_;
-    std::queue<void*> free_blocks_;
-    mutable std::mutex mutex_;
-};
-
-// High-performance thread pool
-class ThreadPool {
-public:
-    ThreadPool(size_t thread_count = THREAD_POOL_SIZE);
-    ~ThreadPool();
-    
-    template<typename F, typename... Args>
-    auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
-    
-    void shutdown();
-    size_t get_thread_count() const;
-    
-private:
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    std::atomic<bool> stop_;
-};
-
-// High-performance cache system
-class CacheSystem {
-public:
-    CacheSystem(size_t max_size = CACHE_SIZE);
-    ~CacheSystem();
-    
-    bool get(const std::string& key, std::string& value);
-    void put(const std::string& key, const std::string& value);
-    void remove(const std::string& key);
-    void clear();
-    size_t size() const;
-    double get_hit_rate() const;
-    
-private:
-    struct CacheNode {
-        std::string key;
-        std::string value;
-        std::chrono::high_resolution_clock::time_point timestamp;
-        std::shared_ptr<CacheNode> prev;
-        std::shared_ptr<CacheNode> next;
-    };
-    
-    size_t max_size_;
-    std::unordered_map<std::string, std::shared_ptr<CacheNode>> cache_map_;
-    std::shared_ptr<CacheNode> head_;
-    std::shared_ptr<CacheNode> tail_;
-    mutable std::mutex mutex_;
-    std::atomic<uint64_t> hits_{0};
-    std::atomic<uint64_t> misses_{0};
-};
-
 // High-performance analytics system
+//
+// Values live in a MetricsRegistry, so recording never takes a lock; the
+// mutex only guards alerts and the per-size-class memory table. Subsystems
+// can register their own timers through get_registry().
 class Analytics {
 public:
     Analytics();
@@ -197,32 +195,76 @@ public:
     
     void record_frame_time(double frame_time);
     void record_entity_count(uint64_t count);
+    void record_particle_count(uint64_t count);
     void record_draw_calls(uint64_t count);
+    void record_visibility(uint64_t visible, uint64_t culled);
+    void record_audio(uint64_t real_voices, uint64_t virtual_voices, double block_us);
+    void record_input_latency(double seconds);
     void record_memory_usage(uint64_t usage);
+    void record_memory_usage(uint32_t block_size, uint64_t live_bytes, uint64_t peak_bytes);
+    // Records every class at once, under one lock.
+    void record_memory_usage(const std::vector<MemoryClassUsage>& classes);
     void record_cache_hit();
     void record_cache_miss();
     
     PerformanceMetrics get_metrics() const;
+    HistogramSnapshot get_frame_time_histogram() const;
     std::vector<PerformanceAlert> get_alerts() const;
     void clear_alerts();
+    std::vector<MemoryClassUsage> get_memory_class_usage() const;
+    MetricsRegistry& get_registry();
     
 private:
-    PerformanceMetrics metrics_;
+    struct MetricIds {
+        MetricId frame_count;
+        MetricId fps;
+        MetricId frame_time;
+        MetricId frame_time_us;
+        MetricId entity_count;
+        MetricId particle_count;
+        MetricId draw_calls;
+        MetricId visible_entities;
+        MetricId culled_entities;
+        MetricId audio_voices;
+        MetricId audio_virtual_voices;
+        MetricId audio_block_us;
+        MetricId input_latency_us;
+        MetricId memory_usage;
+        MetricId cache_hits;
+        MetricId cache_misses;
+    };
+    
+    MetricsRegistry registry_;
+    MetricIds ids_;
     std::vector<PerformanceAlert> alerts_;
+    std::map<uint32_t, MemoryClassUsage> memory_classes_;
     mutable std::mutex mutex_;
     
-    void check_performance_thresholds();
+    void check_performance_thresholds(double frame_time, double fps);
     void add_alert(const std::string& message, uint8_t severity);
 };
 
 // High-performance fighting system
+//
+// Each character's move list is compiled once into a MotionAutomaton and
+// each player reads their controls through their character's, so
+// recognizing every special and super a player could be inputting costs the
+// same per frame however long the lists are or however many are loaded.
 class FightingSystem {
 public:
     FightingSystem();
     ~FightingSystem();
     
     void update_combat(float delta_time);
-    void process_input(const std::string& input, uint32_t player_id);
+    // Compiles a character's commands and returns the move list's id.
+    // Throws what MotionAutomaton does.
+    uint32_t load_move_list(const std::vector<MotionCommand>& commands);
+    // Throws std::invalid_argument for a move list that was never loaded.
+    void set_player_move_list(uint32_t player_id, uint32_t move_list);
+    // One frame of a player's controls, every frame. Executes the move a
+    // command completes and returns its id, or NO_MOTION_COMMAND, as it does
+    // for a player with no move list.
+    uint32_t process_input(const MotionInput& input, uint32_t player_id);
     void execute_move(uint32_t move_id, uint32_t player_id);
     void execute_combo(uint32_t combo_id, uint32_t player_id);
     void execute_super_move(uint32_t super_move_id, uint32_t player_id);
@@ -231,36 +273,106 @@ public:
     uint32_t get_entity_count() const;
     
 private:
+    struct PlayerMotion {
+        uint32_t move_list = NO_MOTION_COMMAND;
+        MotionReader reader;
+    };
+    
     std::vector<Entity> entities_;
-    std::unordered_map<uint32_t, std::vector<uint32_t>> move_combos_;
+    std::vector<MotionAutomaton> move_lists_;
+    std::vector<PlayerMotion> players_;      // by player id
     std::atomic<uint32_t> entity_count_{0};
     mutable std::mutex mutex_;
 };
 
 // High-performance input system
+//
+// Key names are interned once to dense KeyCodes, and key state is three
+// bitsets, so a query is a bit test and frame-wide questions are bitwise
+// operations. Device threads post timestamped events to a lock-free MPSC
+// ring; process_input_frame() pops them, orders them by timestamp and
+// applies the ones due by the frame's deadline, leaving later ones for the
+// next frame, so each press lands in the simulation step whose time it fell
+// in. A key pressed and released within one frame still reads as just
+// pressed and just released. Key state and handlers change only between
+// frames, on the thread that processes them, so stages that run after input
+// read them without locking.
 class InputSystem {
 public:
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t events = 0;              // applied, total
+        uint64_t dropped_events = 0;      // the queue was full
+        size_t waiting_events = 0;        // stamped after the last frame's deadline
+        double last_latency_us = 0.0;     // newest event applied to its frame
+        double max_latency_us = 0.0;
+    };
+    
     InputSystem();
     ~InputSystem();
     
+    // Applies every event stamped at or before `deadline_ns` in timestamp
+    // order and keeps later ones for the next frame. Defaults to now.
     void process_input_frame();
+    void process_input_frame(uint64_t deadline_ns);
+    // Runs in process_input_frame() when the key goes down. Interns the
+    // key. Call between frames.
     void register_input_handler(const std::string& input, std::function<void()> handler);
     void unregister_input_handler(const std::string& input);
     
+    // Thread-safe. Throws std::length_error past MAX_INPUT_KEYS keys.
+    KeyCode intern_key(const std::string& key);
+    // NO_KEY if the key was never interned.
+    KeyCode find_key(const std::string& key) const;
+    std::string get_key_name(KeyCode key) const;
+    
+    // Device threads; any number may post at once. False when the queue is
+    // full and the event was dropped.
+    bool post_key(KeyCode key, bool down, uint64_t timestamp_ns = input_timestamp_now());
+    bool post_mouse_move(float x, float y, uint64_t timestamp_ns = input_timestamp_now());
+    
+    bool is_key_pressed(KeyCode key) const;
+    bool is_key_just_pressed(KeyCode key) const;
+    bool is_key_just_released(KeyCode key) const;
+    // By name: a lookup per call, so hot paths should intern once.
     bool is_key_pressed(const std::string& key) const;
     bool is_key_just_pressed(const std::string& key) const;
     bool is_key_just_released(const std::string& key) const;
     
+    const KeyBits& get_pressed_keys() const { return pressed_; }
+    const KeyBits& get_just_pressed_keys() const { return just_pressed_; }
+    const KeyBits& get_just_released_keys() const { return just_released_; }
+    // This frame's events, in timestamp order, and when it consumed them.
+    const std::vector<InputEvent>& get_frame_events() const { return frame_events_; }
+    uint64_t get_frame_time_ns() const { return frame_time_ns_; }
+    
     Vector3D get_mouse_position() const;
     Vector3D get_mouse_delta() const;
     
+    Stats get_stats() const;
+    
 private:
-    std::unordered_map<std::string, bool> key_states_;
-    std::unordered_map<std::string, bool> previous_key_states_;
-    std::unordered_map<std::string, std::function<void()>> input_handlers_;
+    // Written only by process_input_frame()
+    KeyBits pressed_;
+    KeyBits just_pressed_;
+    KeyBits just_released_;
+    std::vector<InputEvent> waiting_;         // popped, not yet due
+    std::vector<InputEvent> frame_events_;
+    uint64_t frame_time_ns_;
     Vector3D mouse_position_;
     Vector3D previous_mouse_position_;
+    Stats stats_;
+    std::vector<std::function<void()>> input_handlers_;    // by key code
+    
+    std::unique_ptr<MpscRing<InputEvent>> events_;
+    std::atomic<uint64_t> dropped_events_;
+    
+    // Key names; only interning and lookups by name lock
+    std::unordered_map<std::string, KeyCode> key_codes_;
+    std::vector<std::string> key_names_;
     mutable std::mutex mutex_;
+    
+    void apply(const InputEvent& event);
 };
 
 // High-performance graphics engine
@@ -271,14 +383,35 @@ public:
     
     void initialize();
     void shutdown();
+    // Clears the command buffer and takes the camera for this frame's
+    // sort depths. Call before the frame's draw_* calls.
+    void begin_frame();
+    // Sorts the frame's commands and submits them to the backend as
+    // instanced draws: opaque layers, then particles, then the rest.
     void render_frame();
     void set_viewport(int width, int height);
     void set_camera(const Vector3D& position, const Vector3D& target);
+    // Vertical field of view in radians and clip distances. Throws
+    // std::invalid_argument where make_frustum() would.
+    void set_projection(float fov_y, float near_distance, float far_distance);
+    // The camera's view volume, for culling.
+    Frustum get_frustum() const;
     
+    // Records a draw command; nothing reaches the backend until render_frame().
     void draw_entity(const Entity& entity);
-    void draw_particles(const std::vector<Vector3D>& positions);
+    void draw_entity(const Entity& entity, const RenderableComponent& renderable);
+    // Draws the live particles straight from the simulation's streams.
+    void draw_particles(const ParticleRenderData& particles);
+    // A quad on the UI layer; repeats of one element share an instanced draw.
     void draw_ui_element(const std::string& element_id, const Vector3D& position);
     
+    // Headless by default. Not locked; swap it between frames.
+    void set_backend(std::unique_ptr<RenderBackend> backend);
+    RenderBackend& get_backend();
+    const RenderCommandBuffer& get_command_buffer() const;
+    // Draws submitted by the last render_frame().
+    uint64_t get_draw_calls() const;
+    
     void set_lighting_enabled(bool enabled);
     void set_shadows_enabled(bool enabled);
     void set_anti_aliasing_enabled(bool enabled);
@@ -289,14 +422,34 @@ private:
     int viewport_height_;
     Vector3D camera_position_;
     Vector3D camera_target_;
+    float fov_y_;
+    float near_distance_;
+    float far_distance_;
     bool lighting_enabled_;
     bool shadows_enabled_;
     bool anti_aliasing_enabled_;
     std::atomic<uint64_t> draw_calls_{0};
+    RenderCommandBuffer commands_;
+    std::unique_ptr<RenderBackend> backend_;
+    ParticleRenderData particles_;
+    std::unordered_map<std::string, uint32_t> ui_materials_;
+    Vector3D view_position_;     // camera for this frame's depths
+    Vector3D view_forward_;
     mutable std::mutex mutex_;
+    
+    float view_depth(const Vector3D& position) const;
 };
 
 // High-performance audio engine
+//
+// Sounds are registered once as mono clips at AUDIO_SAMPLE_RATE and played
+// by name through an AudioMixer with MAX_SOUNDS voices, which mixes on its
+// own thread into a NullAudioSink until set_sink() supplies a device or a
+// file. Playing a sound returns a handle for stopping or moving it. Only the
+// MAX_REAL_SOUNDS loudest are mixed, highest priority first; the others keep
+// time silently until they are loud enough again. Music plays at the top
+// priority. The mutex only serializes game-side callers, such as the frame
+// graph's audio stage and the game thread; the mixer thread never takes it.
 class AudioEngine {
 public:
     AudioEngine();
@@ -304,12 +457,25 @@ public:
     
     void initialize();
     void shutdown();
+    // Reclaims the voices of sounds that have finished.
     void update_audio();
-    
-    void play_sound(const std::string& sound_id, const Vector3D& position);
-    void play_music(const std::string& music_id, bool loop = false);
-    void stop_sound(const std::string& sound_id);
+    // Plays an impact at each contact that began in the last physics step.
+    void process_contacts(const ContactEventBuffer& events);
+    
+    // Throws std::invalid_argument for an empty clip or a name already taken.
+    void register_sound(const std::string& sound_id, std::vector<float> samples);
+    bool has_sound(const std::string& sound_id) const;
+    
+    // NO_SOUND if the engine is not running, the sound is not registered or
+    // every voice is busy.
+    SoundHandle play_sound(const std::string& sound_id, const Vector3D& position, float volume = 1.0f,
+                           uint8_t priority = AUDIO_PRIORITY_DEFAULT);
+    SoundHandle play_music(const std::string& music_id, bool loop = false);
+    void stop_sound(SoundHandle sound);
     void stop_music();
+    void set_sound_position(SoundHandle sound, const Vector3D& position);
+    bool is_playing(SoundHandle sound) const;
+    size_t get_playing_count() const;
     
     void set_master_volume(float volume);
     void set_sfx_volume(float volume);
@@ -317,6 +483,11 @@ public:
     
     void set_listener_position(const Vector3D& position);
     void set_listener_orientation(const Vector3D& forward, const Vector3D& up);
+    void set_max_real_sounds(size_t count);
+    
+    // Replaces where mixed audio goes, restarting the mixer thread if it runs.
+    void set_sink(std::unique_ptr<AudioSink> sink);
+    AudioMixer::Stats get_mixer_stats() const;
     
 private:
     bool initialized_;
@@ -326,9 +497,15 @@ private:
     Vector3D listener_position_;
     Vector3D listener_forward_;
     Vector3D listener_up_;
-    std::unordered_map<std::string, bool> playing_sounds_;
-    std::string current_music_;
+    // Declared before the mixer, so they outlive its thread
+    std::unordered_map<std::string, std::vector<float>> sounds_;
+    std::unique_ptr<AudioSink> sink_;
+    AudioMixer mixer_;
+    SoundHandle current_music_;
     mutable std::mutex mutex_;
+    
+    SoundHandle play_clip(const std::string& sound_id, const VoiceParams& params);
+    void send_listener();
 };
 
 // High-performance physics engine
@@ -341,22 +518,33 @@ public:
     void shutdown();
     void update_physics(float delta_time);
     
-    void add_rigid_body(uint32_t entity_id, const Vector3D& position, const Vector3D& size);
+    // `size` is the full extent of the body's AABB. Throws
+    // std::invalid_argument if the entity already has a body.
+    void add_rigid_body(uint32_t entity_id, const Vector3D& position, const Vector3D& size, uint32_t flags = 0);
     void remove_rigid_body(uint32_t entity_id);
+    // Ignored for static bodies.
     void set_rigid_body_velocity(uint32_t entity_id, const Vector3D& velocity);
     Vector3D get_rigid_body_position(uint32_t entity_id) const;
     
-    void add_collision_detector(uint32_t entity_id, std::function<void(uint32_t, uint32_t)> callback);
-    void remove_collision_detector(uint32_t entity_id);
-    
     void set_gravity(const Vector3D& gravity);
     Vector3D get_gravity() const;
     
+    // Broadphase and narrowphase fan out over `pool`; null runs them on the
+    // calling thread.
+    void set_thread_pool(ThreadPool* pool);
+    // Contacts and timings from the last update_physics().
+    std::vector<Contact> get_contacts() const;
+    PhysicsWorld::Stats get_stats() const;
+    // Begin/persist/end events from the last update_physics(), sorted by
+    // entity. Not locked: read it from stages ordered after physics (or
+    // before the next step), any number of them at once.
+    const ContactEventBuffer& get_contact_events() const;
+    
 private:
     bool initialized_;
     Vector3D gravity_;
-    std::unordered_map<uint32_t, void*> rigid_bodies_;
-    std::unordered_map<uint32_t, std::function<void(uint32_t, uint32_t)>> collision_callbacks_;
+    PhysicsWorld world_;
+    ThreadPool* thread_pool_;
     mutable std::mutex mutex_;
 };
 
@@ -393,6 +581,8 @@ public:
     
     void initialize();
     void shutdown();
+    // Runs the frame graph once per fixed simulation step that fits in
+    // `delta_time`, each with the fixed step as its delta.
     void update(float delta_time);
     void render();
     
@@ -402,28 +592,81 @@ public:
     GraphicsEngine& get_graphics_engine();
     AudioEngine& get_audio_engine();
     PhysicsEngine& get_physics_engine();
+    // Not locked; add emitters and bursts outside update().
+    ParticleSystem& get_particle_system();
     AIEngine& get_ai_engine();
     MemoryPool& get_memory_pool();
+    // Backs entity storage and lives as long as the engine; usage is
+    // reported every MEMORY_REPORT_FRAMES update()s.
+    SlabAllocator& get_slab_allocator();
     ThreadPool& get_thread_pool();
+    FrameGraph& get_frame_graph();
     CacheSystem& get_cache_system();
+    AsyncCache& get_async_cache();
+    // Adds a persistent second tier under the cache; call after initialize().
+    void enable_disk_cache(const std::string& directory, size_t max_bytes = DISK_CACHE_MAX_BYTES);
     Analytics& get_analytics();
+    // Starts (or restarts) a background OpenMetrics exporter over the
+    // analytics registry; call after initialize().
+    void enable_metrics_export(const MetricsExporter::Options& options);
+    MetricsExporter* get_metrics_exporter();
     
     // Performance monitoring
     PerformanceMetrics get_performance_metrics() const;
     std::vector<PerformanceAlert> get_performance_alerts() const;
     void clear_performance_alerts();
     
-    // Entity management
+    // Entity management. Ids are generational EcsWorld handles: destroyed ids
+    // never alias a later entity, and Entity and component pointers stay
+    // valid only until the next create, destroy, add or remove.
     uint32_t create_entity();
     void destroy_entity(uint32_t entity_id);
     Entity* get_entity(uint32_t entity_id);
     std::vector<Entity*> get_all_entities();
     
+    template<typename T>
+    T* add_component(uint32_t entity_id, T component) {
+        std::lock_guard<std::mutex> lock(entity_mutex_);
+        return world_.add(entity_id, std::move(component));
+    }
+    
+    template<typename T>
+    T* get_component(uint32_t entity_id) {
+        std::lock_guard<std::mutex> lock(entity_mutex_);
+        return world_.get<T>(entity_id);
+    }
+    
+    template<typename T>
+    bool remove_component(uint32_t entity_id) {
+        std::lock_guard<std::mutex> lock(entity_mutex_);
+        return world_.remove<T>(entity_id);
+    }
+    
+    // Direct access for systems that run queries; hold no other entity
+    // pointers across a structural change.
+    EcsWorld& get_world();
+    
     // Performance optimization
     void set_target_fps(uint32_t fps);
     void set_vsync_enabled(bool enabled);
     void set_multithreading_enabled(bool enabled);
     
+    // Simulation step rate, catch-up limit and deterministic mode; resets the
+    // accumulator. Throws std::invalid_argument on an invalid config.
+    void set_fixed_timestep(const FixedTimestep::Config& config);
+    const FixedTimestep& get_fixed_timestep() const;
+    // How far the renderer should blend from the previous simulation step
+    // towards the last one, given the time left over after update().
+    float get_interpolation_alpha() const;
+    
+    // Distances at which entities switch to coarser meshes in their LOD
+    // chain. Throws std::invalid_argument unless positive and ascending.
+    void set_lod_distances(const float distances[MAX_LOD_LEVELS - 1]);
+    // Entities in the camera's frustum as of the last update(), with their
+    // LOD level; render() draws only these. Not locked; read it between
+    // updates.
+    const std::vector<VisibleEntity>& get_visible_entities() const;
+    
 private:
     bool initialized_;
     uint32_t target_fps_;
@@ -436,21 +679,38 @@ private:
     std::unique_ptr<GraphicsEngine> graphics_engine_;
     std::unique_ptr<AudioEngine> audio_engine_;
     std::unique_ptr<PhysicsEngine> physics_engine_;
+    std::unique_ptr<ParticleSystem> particle_system_;
     std::unique_ptr<AIEngine> ai_engine_;
     std::unique_ptr<MemoryPool> memory_pool_;
+    std::unique_ptr<SlabAllocator> slab_allocator_;
     std::unique_ptr<ThreadPool> thread_pool_;
+    std::unique_ptr<FrameGraph> frame_graph_;
     std::unique_ptr<CacheSystem> cache_system_;
+    std::unique_ptr<AsyncCache> async_cache_;
+    std::unique_ptr<DiskCache> disk_cache_;
     std::unique_ptr<Analytics> analytics_;
+    std::unique_ptr<MetricsExporter> metrics_exporter_;
+    std::vector<MetricId> stage_timers_;   // per frame-graph stage, by StageId
+    MetricId sim_steps_counter_;
+    MetricId sim_dropped_steps_counter_;
+    FixedTimestep timestep_;
+    uint64_t input_deadline_ns_;          // end of the running step's share of the frame
+    uint32_t frames_since_memory_report_;
+    std::vector<MemoryClassUsage> memory_report_;
     
     // Entity management
-    std::vector<Entity> entities_;
-    std::queue<uint32_t> free_entity_ids_;
-    uint32_t next_entity_id_;
+    EcsWorld world_;
     mutable std::mutex entity_mutex_;
+    std::vector<float> motion_scratch_;   // SoA position/velocity streams for one chunk
+    std::vector<float> culling_scratch_;  // SoA center/extent streams for one chunk
+    BatchCuller culling_;
+    std::vector<VisibleEntity> visible_entities_;
     
+    void build_frame_graph();
     void update_entities(float delta_time);
     void render_entities();
     void optimize_performance();
+    void report_memory_usage();
 };
 
 // Utility functions
@@ -0,0 +1,261 @@
+/**
+ * Anime Aggressors Performance Engine - Rigid body world
+ * SoA body store, persistent sweep-and-prune broadphase and batched AABB narrowphase
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "batch_math.h"
+
+namespace AnimeAggressors {
+
+class ThreadPool;
+
+constexpr uint32_t NO_RIGID_BODY = UINT32_MAX;
+
+enum RigidBodyFlags : uint32_t {
+    RIGID_BODY_STATIC = 1u << 0,       // never moves; static-static pairs are skipped
+    RIGID_BODY_NO_GRAVITY = 1u << 1,
+};
+
+struct RigidBodyDesc {
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float velocity[3] = {0.0f, 0.0f, 0.0f};
+    float half_extents[3] = {0.5f, 0.5f, 0.5f};
+    uint32_t flags = 0;
+};
+
+// Two bodies whose AABBs overlap. `entity_a` < `entity_b`; the normal is the
+// axis of least penetration, pointing from a towards b, and `point` is the
+// centre of the overlap box.
+struct Contact {
+    uint32_t entity_a;
+    uint32_t entity_b;
+    float normal[3];
+    float point[3];
+    float depth;
+};
+
+enum class ContactPhase : uint8_t {
+    BEGIN,      // touching this step, not the step before
+    PERSIST,    // touching both steps
+    END,        // touching the step before only; carries that step's data
+};
+
+// One side of a contact: `entity` touching `other`, with the normal pointing
+// from `entity` towards `other`. Every contact yields one event per side.
+struct ContactEvent {
+    uint32_t entity;
+    uint32_t other;
+    ContactPhase phase;
+    float normal[3];
+    float point[3];
+    float depth;
+};
+
+struct ContactEventRange {
+    const ContactEvent* first;
+    const ContactEvent* last;
+
+    const ContactEvent* begin() const { return first; }
+    const ContactEvent* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// Per-step contact events, sorted by (entity, other).
+//
+// update() diffs the step's contacts against the previous step's and
+// rewrites the buffer; consumers iterate it afterwards, concurrently if they
+// like, instead of being called back per pair from inside the step. Buffers
+// are reused, so a steady contact count does not allocate.
+class ContactEventBuffer {
+public:
+    void update(const std::vector<Contact>& contacts);
+    void clear();
+
+    const std::vector<ContactEvent>& get_events() const { return events_; }
+    // The contiguous run of events whose `entity` is `entity`.
+    ContactEventRange get_events_for(uint32_t entity) const;
+    size_t get_count(ContactPhase phase) const { return counts_[static_cast<size_t>(phase)]; }
+
+private:
+    std::vector<Contact> previous_;   // sorted by (entity_a, entity_b)
+    std::vector<Contact> current_;
+    std::vector<Contact> contact_scratch_;
+    std::vector<ContactEvent> events_;
+    std::vector<ContactEvent> a_side_;
+    std::vector<ContactEvent> b_side_;
+    std::vector<ContactEvent> event_scratch_;
+    size_t counts_[3] = {0, 0, 0};    // per pair, by ContactPhase
+};
+
+// Dense SoA rigid body storage, one float stream per component axis.
+// Bodies are addressed by entity id; removal swaps the last body into the
+// hole, so dense indices are only stable between structural changes.
+class RigidBodyStore {
+public:
+    explicit RigidBodyStore(size_t capacity = 0);
+
+    // Throws std::invalid_argument if `entity_id` already has a body.
+    uint32_t add(uint32_t entity_id, const RigidBodyDesc& desc);
+    // Swaps the last body into the hole; `moved_from` receives that body's
+    // old index, or NO_RIGID_BODY when the removed body was last.
+    bool remove(uint32_t entity_id, uint32_t& moved_from);
+    uint32_t index_of(uint32_t entity_id) const;
+    void clear();
+    size_t size() const { return entity_ids_.size(); }
+
+    // pos += vel * dt after vel += gravity * dt for bodies that feel it,
+    // then refreshes the AABB streams.
+    void integrate(float delta_time, const float gravity[3]);
+    // Recomputes min/max from position and half extents.
+    void update_bounds();
+
+    Vec3SoA positions() { return {position_[0].data(), position_[1].data(), position_[2].data()}; }
+    Vec3SoA velocities() { return {velocity_[0].data(), velocity_[1].data(), velocity_[2].data()}; }
+    Vec3SoA half_extents() { return {half_extents_[0].data(), half_extents_[1].data(), half_extents_[2].data()}; }
+    const float* position(int axis) const { return position_[axis].data(); }
+    const float* min(int axis) const { return min_[axis].data(); }
+    const float* max(int axis) const { return max_[axis].data(); }
+    const uint32_t* flags() const { return flags_.data(); }
+    const uint32_t* entity_ids() const { return entity_ids_.data(); }
+
+private:
+    std::vector<float> position_[3];
+    std::vector<float> velocity_[3];
+    std::vector<float> half_extents_[3];
+    std::vector<float> gravity_scale_;   // 0 for static and no-gravity bodies
+    std::vector<float> min_[3];
+    std::vector<float> max_[3];
+    std::vector<uint32_t> flags_;
+    std::vector<uint32_t> entity_ids_;
+    std::unordered_map<uint32_t, uint32_t> index_;
+};
+
+// Candidate pairs as dense body indices, a < b not implied.
+struct BodyPair {
+    uint32_t a;
+    uint32_t b;
+};
+
+// Sweep-and-prune with a persistent sort order, swept per grid cell.
+//
+// The body order from the previous frame is re-sorted with insertion sort,
+// which is close to linear while bodies move a little per frame. The sweep
+// axis follows the axis of greatest centre variance, with hysteresis so it
+// does not flip (and force a full re-sort) every frame.
+//
+// A single sweep axis degrades towards all-pairs in a dense 3D arena, so the
+// two cross axes are cut into a coarse grid of cells a few body-widths wide.
+// Each body's bounds are copied, in sweep order, into every cell it touches,
+// and each cell is swept on its own, over contiguous memory. Runs of cells
+// are the buckets that sweep in parallel, each writing its own candidate
+// list. A pair is kept only by the cell holding
+// the low corner of its cross-axis overlap, so no pair is found twice.
+class SweepAndPrune {
+public:
+    struct Stats {
+        int axis = 0;
+        size_t cells = 0;
+        size_t buckets = 0;
+        size_t swaps = 0;             // insertion-sort moves this update
+        bool full_sort = false;
+        size_t candidate_pairs = 0;
+    };
+
+    // Keep the order in step with RigidBodyStore::add()/remove().
+    void on_add(uint32_t index);
+    void on_remove(uint32_t removed, uint32_t moved_from);
+    void clear();
+
+    // Re-sorts and sweeps. Bucket results stay valid until the next update.
+    void update(const RigidBodyStore& bodies, ThreadPool* pool);
+
+    size_t get_bucket_count() const { return bucket_count_; }
+    const std::vector<BodyPair>& get_bucket_pairs(size_t bucket) const { return bucket_pairs_[bucket]; }
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    std::vector<uint32_t> order_;        // body indices sorted by min on axis_
+    // A body's bounds copied into a cell, so a cell sweeps contiguous memory.
+    struct CellEntry {
+        float min;
+        float max;
+        float cross_min[2];
+        float cross_max[2];
+        uint32_t body;
+        uint32_t is_static;
+    };
+
+    std::vector<std::vector<CellEntry>> cells_;   // in sweep order
+    size_t cell_count_[2] = {1, 1};
+    float cell_origin_[2] = {0.0f, 0.0f};
+    float inverse_cell_size_[2] = {0.0f, 0.0f};
+    std::vector<std::vector<BodyPair>> bucket_pairs_;
+    size_t bucket_count_ = 0;
+    int axis_ = 0;
+    bool needs_full_sort_ = true;
+    Stats stats_;
+
+    void choose_axis_and_grid(const RigidBodyStore& bodies);
+    void sort(const RigidBodyStore& bodies);
+    void bin(const RigidBodyStore& bodies);
+    size_t cell_of(int cross, float value) const;
+    void sweep(size_t bucket, size_t cell_begin, size_t cell_end);
+};
+
+// Exact AABB test and contact generation over `pairs`, appending to
+// `contacts`. Pairs are processed in fixed-size blocks gathered into SoA
+// scratch, so the per-axis overlap math vectorizes across the block.
+void narrowphase(const RigidBodyStore& bodies, const BodyPair* pairs, size_t count, std::vector<Contact>& contacts);
+
+// Bodies, broadphase and narrowphase stepped together.
+class PhysicsWorld {
+public:
+    struct Stats {
+        size_t bodies = 0;
+        size_t candidate_pairs = 0;
+        size_t contacts = 0;
+        size_t sort_swaps = 0;
+        int sweep_axis = 0;
+        double integrate_us = 0.0;
+        double broadphase_us = 0.0;
+        double narrowphase_us = 0.0;
+        double contact_events_us = 0.0;
+    };
+
+    explicit PhysicsWorld(size_t capacity = 0);
+
+    uint32_t add_body(uint32_t entity_id, const RigidBodyDesc& desc);
+    bool remove_body(uint32_t entity_id);
+    void clear();
+    RigidBodyStore& get_bodies() { return bodies_; }
+    const RigidBodyStore& get_bodies() const { return bodies_; }
+
+    // Integrates, sweeps and generates this step's contacts. With a pool
+    // the broadphase and narrowphase fan out per bucket; without one they
+    // run on the calling thread.
+    void step(float delta_time, const float gravity[3], ThreadPool* pool);
+
+    // Contacts from the last step, grouped by broadphase bucket.
+    const std::vector<Contact>& get_contacts() const { return contacts_; }
+    // Begin/persist/end events for the last step.
+    const ContactEventBuffer& get_contact_events() const { return contact_events_; }
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    RigidBodyStore bodies_;
+    SweepAndPrune broadphase_;
+    std::vector<std::vector<Contact>> bucket_contacts_;
+    std::vector<Contact> contacts_;
+    ContactEventBuffer contact_events_;
+    Stats stats_;
+};
+
+} // namespace AnimeAggressors
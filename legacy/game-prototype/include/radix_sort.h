@@ -0,0 +1,49 @@
+/**
+ * Anime Aggressors Performance Engine - Radix sort
+ * Stable LSD radix sort on 64-bit keys for per-frame buffers
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace AnimeAggressors {
+
+// Sorts `items` by key(item) ascending, stably, in O(n) per byte of key.
+// `scratch` is resized to match and keeps its capacity, so a buffer sorted
+// every frame stops allocating once warm. Byte positions where every key
+// agrees (e.g. the high bytes of small ids) are skipped.
+template<typename T, typename KeyFn>
+void radix_sort(std::vector<T>& items, std::vector<T>& scratch, KeyFn key) {
+    const size_t count = items.size();
+    if (count < 2) return;
+    scratch.resize(count);
+
+    // One pass counts every byte position; positions where all keys agree
+    // have a single full bucket and are skipped.
+    size_t offsets[8][256] = {};
+    for (const T& item : items) {
+        const uint64_t k = key(item);
+        for (int byte = 0; byte < 8; ++byte) ++offsets[byte][(k >> (byte * 8)) & 0xFF];
+    }
+
+    for (int byte = 0; byte < 8; ++byte) {
+        const int shift = byte * 8;
+        size_t* offset = offsets[byte];
+        if (offset[(key(items[0]) >> shift) & 0xFF] == count) continue;
+
+        size_t total = 0;
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            const size_t size = offset[bucket];
+            offset[bucket] = total;
+            total += size;
+        }
+        for (T& item : items) scratch[offset[(key(item) >> shift) & 0xFF]++] = std::move(item);
+        items.swap(scratch);
+    }
+}
+
+} // namespace AnimeAggressors
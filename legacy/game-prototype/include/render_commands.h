@@ -0,0 +1,134 @@
+/**
+ * Anime Aggressors Performance Engine - Render command buffer
+ * Sort-keyed draw commands merged into instanced draws for a render backend
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AnimeAggressors {
+
+struct ParticleRenderData;
+
+constexpr uint32_t MAX_RENDER_MESHES = 1u << 16;
+constexpr uint32_t MAX_RENDER_MATERIALS = 1u << 16;
+constexpr uint32_t MAX_INSTANCES_PER_DRAW = 1024;
+
+// Layers draw in ascending order. Layers from RENDER_LAYER_TRANSPARENT up
+// sort back to front by depth first, for blending; the rest sort by
+// material and mesh, front to back within each.
+enum RenderLayer : uint8_t {
+    RENDER_LAYER_OPAQUE = 0,
+    RENDER_LAYER_TRANSPARENT = 128,
+    RENDER_LAYER_UI = 192,
+};
+
+// Per-instance data, gathered contiguous per draw for upload.
+struct RenderInstance {
+    float position[3];
+    float scale[3];
+    float rotation[4];
+    uint32_t entity;
+};
+
+// 64-bit sort key plus the index of its instance; 16 bytes so the radix
+// sort moves little.
+//
+//   opaque:       layer:8 | material:16 | mesh:16 | depth:24
+//   transparent:  layer:8 | ~depth:24 | material:16 | mesh:16
+//
+// Depth is the top 24 bits of a non-negative float, which order the same
+// way as the floats themselves.
+struct RenderCommand {
+    uint64_t key;
+    uint32_t instance;
+};
+
+// One instanced draw: `instance_count` instances of `mesh` with `material`,
+// starting at `first_instance` in the buffer's sorted instances.
+struct DrawBatch {
+    uint8_t layer;
+    uint32_t material;
+    uint32_t mesh;
+    uint32_t first_instance;
+    uint32_t instance_count;
+};
+
+// What the command buffer submits to: a GPU API, or HeadlessRenderBackend.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void begin_frame() {}
+    virtual void draw_instanced(const DrawBatch& batch, const RenderInstance* instances) = 0;
+    virtual void draw_particles(const ParticleRenderData& particles) = 0;
+    virtual void end_frame() {}
+};
+
+// Counts what would have reached the GPU, so draw-call reductions can be
+// measured without one.
+class HeadlessRenderBackend : public RenderBackend {
+public:
+    struct FrameCounts {
+        uint64_t draw_calls = 0;
+        uint64_t instances = 0;
+        uint64_t particles = 0;
+    };
+
+    void begin_frame() override;
+    void draw_instanced(const DrawBatch& batch, const RenderInstance* instances) override;
+    void draw_particles(const ParticleRenderData& particles) override;
+    void end_frame() override;
+
+    // Counts for the frame being drawn, and for the last finished one.
+    const FrameCounts& get_current() const { return current_; }
+    const FrameCounts& get_last_frame() const { return last_frame_; }
+    uint64_t get_frame_count() const { return frames_; }
+
+private:
+    FrameCounts current_;
+    FrameCounts last_frame_;
+    uint64_t frames_ = 0;
+};
+
+// A frame's draws, recorded in any order.
+//
+// sort() radix-sorts the commands by key and walks them once, merging each
+// run with the same layer, material and mesh into one DrawBatch (split every
+// MAX_INSTANCES_PER_DRAW instances). Instance data is gathered into that
+// order so each batch is one contiguous range. Buffers keep their capacity
+// across clear(), so a steady scene records and sorts without allocating.
+// Not thread-safe; record from one thread.
+class RenderCommandBuffer {
+public:
+    explicit RenderCommandBuffer(size_t capacity = 0);
+
+    void clear();
+    // `depth` is the distance along the view direction; negative counts as 0.
+    // Throws std::invalid_argument for a mesh or material id past the key's
+    // 16-bit fields.
+    void add(uint8_t layer, uint32_t material, uint32_t mesh, float depth, const RenderInstance& instance);
+    void sort();
+    // Sorts if needed and issues every batch. Returns the number of draws.
+    size_t submit(RenderBackend& backend);
+
+    size_t size() const { return commands_.size(); }
+    const std::vector<RenderCommand>& get_commands() const { return commands_; }
+    const std::vector<DrawBatch>& get_batches() const { return batches_; }
+    const std::vector<RenderInstance>& get_sorted_instances() const { return sorted_instances_; }
+
+    static uint64_t make_key(uint8_t layer, uint32_t material, uint32_t mesh, float depth);
+
+private:
+    std::vector<RenderCommand> commands_;
+    std::vector<RenderCommand> scratch_;
+    std::vector<RenderInstance> instances_;
+    std::vector<RenderInstance> sorted_instances_;
+    std::vector<DrawBatch> batches_;
+    bool sorted_;
+};
+
+} // namespace AnimeAggressors
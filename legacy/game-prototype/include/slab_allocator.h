@@ -0,0 +1,113 @@
+/**
+ * Anime Aggressors Performance Engine - Size-class slab allocator
+ * Thread-local magazines over a shared per-class depot
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace AnimeAggressors {
+
+// General-purpose small-object allocator for 16B-64KB requests.
+//
+// Requests are rounded up to one of NUM_SIZE_CLASSES block sizes. Each thread
+// owns a magazine (a small stack of free blocks) per class, so the common
+// allocate/deallocate path touches no shared state. When a magazine runs dry
+// it is refilled with half a magazine from the class depot (or freshly carved
+// slab memory); when it overflows, half is flushed back. A block freed on a
+// different thread from the one that allocated it simply lands in the freeing
+// thread's magazine, so cross-thread frees cost the same as local ones.
+//
+// Requests above MAX_SMALL_SIZE go straight to ::operator new. Deallocation
+// is sized: callers pass the same size they allocated with. Blocks are
+// 16-byte aligned, and 64-byte aligned when the size is a multiple of 64.
+class SlabAllocator {
+public:
+    static constexpr size_t NUM_SIZE_CLASSES = 24;
+    static constexpr size_t MAX_SMALL_SIZE = 64 * 1024;
+    static constexpr size_t MAX_THREAD_CACHES = 64;
+
+    struct SizeClassStats {
+        uint32_t block_size;      // 0 for the large-object bucket
+        uint64_t live_bytes;      // handed out and not yet returned
+        uint64_t peak_bytes;      // highest live_bytes seen; see get_stats()
+        uint64_t reserved_bytes;  // slab memory carved for this class
+    };
+
+    SlabAllocator();
+    ~SlabAllocator();
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(alignof(T) <= 16, "SlabAllocator blocks are 16-byte aligned");
+        void* block = allocate(sizeof(T));
+        try {
+            return new (block) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(block, sizeof(T));
+            throw;
+        }
+    }
+
+    template<typename T>
+    void destroy(T* object) {
+        if (object == nullptr) return;
+        object->~T();
+        deallocate(object, sizeof(T));
+    }
+
+    // One entry per size class followed by the large-object bucket. Live
+    // bytes are merged from the per-thread counters at call time. A class's
+    // peak is the merged value sampled on every magazine refill and here, so
+    // it can trail the true peak by at most a magazine per thread; the
+    // large bucket's is exact.
+    std::vector<SizeClassStats> get_stats();
+    uint64_t get_live_bytes();
+
+    static size_t size_class_of(size_t size);
+    static size_t class_block_size(size_t size_class);
+
+private:
+    struct ThreadCache;
+
+    struct alignas(64) SizeClass {
+        std::mutex mutex;
+        void* depot_head = nullptr;   // intrusive list of free blocks
+        size_t depot_count = 0;
+        char* bump = nullptr;         // uncarved remainder of the newest slab
+        char* bump_end = nullptr;
+        std::vector<void*> slabs;
+        std::atomic<uint64_t> reserved_bytes{0};
+        std::atomic<uint64_t> peak_bytes{0};
+    };
+
+    SizeClass classes_[NUM_SIZE_CLASSES];
+    std::atomic<ThreadCache*> caches_[MAX_THREAD_CACHES];
+
+    // Large allocations and threads without a cache slot update these
+    // directly.
+    std::atomic<int64_t> shared_live_blocks_[NUM_SIZE_CLASSES];
+    std::atomic<int64_t> large_live_bytes_{0};
+    std::atomic<uint64_t> large_peak_bytes_{0};
+
+    ThreadCache* local_cache();
+    uint64_t class_live_bytes(size_t size_class) const;
+    size_t refill(size_t size_class, void** out, size_t wanted);
+    void flush(size_t size_class, void* const* blocks, size_t count);
+};
+
+} // namespace AnimeAggressors
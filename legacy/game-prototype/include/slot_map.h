@@ -0,0 +1,186 @@
+/**
+ * Anime Aggressors Performance Engine - Generational slot map
+ * O(1) handle-addressed storage with dense iteration and stale-handle checks
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace AnimeAggressors {
+
+// 32-bit handle: low 20 bits slot index, high 12 bits generation. Zero is
+// never a live handle.
+using SlotHandle = uint32_t;
+
+constexpr SlotHandle NULL_SLOT_HANDLE = 0;
+
+// Values stored densely and addressed by generational handles.
+//
+// Values live contiguously in insertion-ish order, so iteration touches only
+// live elements; a slot table maps each handle's index to its dense position.
+// erase() moves the last value into the hole (swap-remove), so order is not
+// stable and pointers from get() are only valid until the next insert or
+// erase. Handles stay valid until their own erase.
+//
+// Every erase bumps the slot's generation, so an old handle to a reused slot
+// no longer matches and get() returns nullptr instead of aliasing the new
+// value. Freed slots are reused oldest-first to spread generations, and a
+// slot whose generation would wrap is retired rather than reused, so a stale
+// handle can never match. Throws std::length_error past MAX_SLOTS.
+template<typename T>
+class SlotMap {
+public:
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t MAX_SLOTS = 1u << INDEX_BITS;
+    static constexpr uint32_t MAX_GENERATION = (1u << (32 - INDEX_BITS)) - 1;
+
+    SlotMap() : free_head_(NIL), free_tail_(NIL), retired_(0) {}
+
+    explicit SlotMap(size_t capacity) : SlotMap() {
+        reserve(capacity);
+    }
+
+    void reserve(size_t capacity) {
+        slots_.reserve(capacity);
+        values_.reserve(capacity);
+        value_slots_.reserve(capacity);
+    }
+
+    template<typename... Args>
+    SlotHandle emplace(Args&&... args) {
+        if (free_head_ == NIL && slots_.size() >= MAX_SLOTS) {
+            throw std::length_error("SlotMap: out of slots");
+        }
+
+        // Grow the dense arrays first so a throwing constructor or allocation
+        // leaves the slot table untouched.
+        value_slots_.push_back(NIL);
+        try {
+            values_.emplace_back(std::forward<Args>(args)...);
+            if (free_head_ == NIL) slots_.push_back(Slot{NIL, 1});
+        } catch (...) {
+            if (values_.size() > value_slots_.size() - 1) values_.pop_back();
+            value_slots_.pop_back();
+            throw;
+        }
+
+        uint32_t index;
+        if (free_head_ != NIL) {
+            index = free_head_;
+            free_head_ = slots_[index].dense_or_next;
+            if (free_head_ == NIL) free_tail_ = NIL;
+        } else {
+            index = static_cast<uint32_t>(slots_.size() - 1);
+        }
+        slots_[index].dense_or_next = static_cast<uint32_t>(values_.size() - 1);
+        value_slots_.back() = index;
+        return make_handle(index, slots_[index].generation);
+    }
+
+    SlotHandle insert(T value) {
+        return emplace(std::move(value));
+    }
+
+    // Returns false for stale or null handles.
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) return false;
+
+        const uint32_t index = handle_index(handle);
+        const uint32_t dense = slots_[index].dense_or_next;
+        const uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+        if (dense != last) {
+            values_[dense] = std::move(values_[last]);
+            value_slots_[dense] = value_slots_[last];
+            slots_[value_slots_[dense]].dense_or_next = dense;
+        }
+        values_.pop_back();
+        value_slots_.pop_back();
+        release_slot(index);
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        const uint32_t index = handle_index(handle);
+        return index < slots_.size() && handle_generation(handle) != 0 &&
+               slots_[index].generation == handle_generation(handle) &&
+               slots_[index].dense_or_next < values_.size() && value_slots_[slots_[index].dense_or_next] == index;
+    }
+
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &values_[slots_[handle_index(handle)].dense_or_next] : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values_[slots_[handle_index(handle)].dense_or_next] : nullptr;
+    }
+
+    void clear() {
+        // Keep generations so handles from before the clear stay stale.
+        for (uint32_t index : value_slots_) release_slot(index);
+        values_.clear();
+        value_slots_.clear();
+    }
+
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    size_t slot_count() const { return slots_.size(); }
+    size_t retired_slots() const { return retired_; }
+
+    // Dense access for iteration; handle_at(i) is the handle of data()[i].
+    T* data() { return values_.data(); }
+    const T* data() const { return values_.data(); }
+    typename std::vector<T>::iterator begin() { return values_.begin(); }
+    typename std::vector<T>::iterator end() { return values_.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values_.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values_.end(); }
+    SlotHandle handle_at(size_t dense_index) const {
+        const uint32_t index = value_slots_[dense_index];
+        return make_handle(index, slots_[index].generation);
+    }
+
+    static uint32_t handle_index(SlotHandle handle) { return handle & (MAX_SLOTS - 1); }
+    static uint32_t handle_generation(SlotHandle handle) { return handle >> INDEX_BITS; }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Slot {
+        uint32_t dense_or_next;   // live: dense index; free: next free slot
+        uint32_t generation;      // 1..MAX_GENERATION, 0 once retired
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<T> values_;
+    std::vector<uint32_t> value_slots_;   // dense index -> slot index
+    uint32_t free_head_;
+    uint32_t free_tail_;
+    size_t retired_;
+
+    static SlotHandle make_handle(uint32_t index, uint32_t generation) {
+        return (generation << INDEX_BITS) | index;
+    }
+
+    void release_slot(uint32_t index) {
+        Slot& slot = slots_[index];
+        slot.dense_or_next = NIL;
+        if (slot.generation == MAX_GENERATION) {
+            slot.generation = 0;   // matches no handle; never reused
+            ++retired_;
+            return;
+        }
+        ++slot.generation;
+        if (free_tail_ == NIL) {
+            free_head_ = index;
+        } else {
+            slots_[free_tail_].dense_or_next = index;
+        }
+        free_tail_ = index;
+    }
+};
+
+} // namespace AnimeAggressors
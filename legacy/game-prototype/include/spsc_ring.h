@@ -0,0 +1,74 @@
+/**
+ * Anime Aggressors Performance Engine - Single-producer single-consumer ring
+ * Bounded lock-free queue between exactly two threads
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace AnimeAggressors {
+
+// Fixed-capacity FIFO for one producer thread and one consumer thread.
+//
+// Neither side ever blocks or allocates: try_push() fails when full and
+// try_pop() when empty. Head and tail live on separate cache lines, and
+// each side keeps a private copy of the other's index, re-reading the shared
+// one only when its copy says the ring is full (or empty), so a steady
+// stream costs one atomic store per operation. Capacity is rounded up to a
+// power of two. T must be copyable; slots are reused without destruction.
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        slots_.resize(rounded);
+        mask_ = rounded - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only.
+    bool try_push(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool try_pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) return false;
+        }
+        out = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from either side; exact when the other side is idle.
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};    // next slot to pop, written by the consumer
+    size_t cached_tail_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};    // next slot to push, written by the producer
+    size_t cached_head_ = 0;
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,17 @@
+/**
+ * Anime Aggressors Performance Engine - Stage timing
+ * Wall-clock helpers for the per-stage timings subsystems report in their stats
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace AnimeAggressors {
+
+// Microseconds from `start` to now on the steady clock.
+inline double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace AnimeAggressors
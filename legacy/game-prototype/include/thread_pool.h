@@ -0,0 +1,229 @@
+/**
+ * Anime Aggressors Performance Engine - Work-stealing thread pool
+ * Per-worker Chase-Lev deques, small-buffer tasks, spin-then-park workers
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "memory_pool.h"
+
+namespace AnimeAggressors {
+
+inline const size_t THREAD_POOL_SIZE = std::thread::hardware_concurrency();
+
+class ThreadPool;
+
+// Counts outstanding tasks submitted against it. ThreadPool::wait() runs
+// other queued tasks on the calling thread until the count reaches zero, so
+// a worker can fork and join without blocking a thread. The first exception
+// a task in the group throws is kept and rethrown by wait().
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class ThreadPool;
+    std::atomic<size_t> pending_{0};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+// Type-erased, move-only callable stored inline. Callables up to
+// INLINE_SIZE bytes never touch the heap; larger ones are boxed.
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    Task() = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& f) { // NOLINT: implicit by design, like std::function
+        using Fn = std::decay_t<F>;
+        if constexpr (sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<Fn>) {
+            new (storage_) Fn(std::forward<F>(f));
+            invoke_ = [](void* p) { (*static_cast<Fn*>(p))(); };
+            manage_ = [](void* dst, void* src) {
+                if (dst != nullptr) new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                static_cast<Fn*>(src)->~Fn();
+            };
+        } else {
+            Fn* boxed = new Fn(std::forward<F>(f));
+            new (storage_) Fn*(boxed);
+            invoke_ = [](void* p) { (**static_cast<Fn**>(p))(); };
+            manage_ = [](void* dst, void* src) {
+                if (dst != nullptr) {
+                    new (dst) Fn*(*static_cast<Fn**>(src));
+                } else {
+                    delete *static_cast<Fn**>(src);
+                }
+            };
+        }
+    }
+
+    Task(Task&& other) noexcept { move_from(other); }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    explicit operator bool() const { return invoke_ != nullptr; }
+    void operator()() { invoke_(storage_); }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE];
+    void (*invoke_)(void*) = nullptr;
+    void (*manage_)(void* dst, void* src) = nullptr; // move into dst, or destroy when dst is null
+
+    void reset() {
+        if (manage_ != nullptr) manage_(nullptr, storage_);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+    void move_from(Task& other) {
+        if (other.manage_ != nullptr) other.manage_(storage_, other.storage_);
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+        other.invoke_ = nullptr;
+        other.manage_ = nullptr;
+    }
+};
+
+// Work-stealing pool.
+//
+// Each worker owns a bounded Chase-Lev deque: it pushes and pops at the
+// bottom without contention, while idle workers steal from the top. Tasks
+// submitted from outside the pool (or when a deque is full) go to a shared
+// injection queue. Idle workers spin briefly looking for work before parking
+// on a condition variable, so short gaps between frames don't cost a
+// futex round-trip.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count = THREAD_POOL_SIZE);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Fire-and-forget submission; no allocation for small callables.
+    template<typename F>
+    void submit(F&& f) {
+        push(make_node(Task(std::forward<F>(f)), nullptr));
+    }
+
+    // Submission tracked by `group`; pair with wait(group).
+    template<typename F>
+    void submit(TaskGroup& group, F&& f) {
+        TaskNode* node = make_node(Task(std::forward<F>(f)), &group);
+        group.pending_.fetch_add(1, std::memory_order_relaxed);
+        push(node);
+    }
+
+    // Runs queued tasks on the calling thread until every task in `group`
+    // has finished, then rethrows the first exception one of them threw.
+    // Exceptions from tasks submitted without a group are dropped.
+    void wait(TaskGroup& group);
+
+    // Future-returning submission, kept for callers that need a result.
+    template<typename F, typename... Args>
+    auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        using return_type = std::invoke_result_t<F, Args...>;
+        auto task = std::make_shared<std::packaged_task<return_type()>>(
+            std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+        std::future<return_type> result = task->get_future();
+        submit([task] { (*task)(); });
+        return result;
+    }
+
+    void shutdown();
+    size_t get_thread_count() const;
+
+    // Index of the calling worker in [0, get_thread_count()), or -1 when
+    // called from a thread that does not belong to this pool.
+    int current_worker_index() const;
+
+private:
+    struct TaskNode {
+        Task task;
+        TaskGroup* group;
+        bool pooled;
+    };
+
+    // Bounded single-owner deque (Chase & Lev, with the C11 orderings from
+    // Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+    class WorkDeque {
+    public:
+        static constexpr int64_t CAPACITY = 4096;
+
+        bool push(TaskNode* node);
+        TaskNode* pop();
+        TaskNode* steal();
+        bool empty() const;
+
+    private:
+        alignas(64) std::atomic<int64_t> top_{0};
+        alignas(64) std::atomic<int64_t> bottom_{0};
+        std::atomic<TaskNode*> buffer_[CAPACITY];
+    };
+
+    struct alignas(64) Worker {
+        WorkDeque deque;
+        std::thread thread;
+        uint32_t steal_seed = 0;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    MemoryPool node_pool_;
+
+    std::mutex injection_mutex_;
+    std::queue<TaskNode*> injection_;
+    std::atomic<size_t> injected_{0};
+
+    // Parking: workers sleep on condition_ once spinning finds nothing.
+    // work_epoch_ is bumped on every push so a worker that checked for work
+    // and then raced with a push notices before it sleeps.
+    std::mutex park_mutex_;
+    std::condition_variable condition_;
+    std::atomic<uint64_t> work_epoch_{0};
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<bool> stop_;
+
+    TaskNode* make_node(Task&& task, TaskGroup* group);
+    void push(TaskNode* node);
+    TaskNode* find_work(int self);
+    void run(TaskNode* node);
+    void worker_loop(int index);
+};
+
+} // namespace AnimeAggressors
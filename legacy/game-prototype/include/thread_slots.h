@@ -0,0 +1,75 @@
+/**
+ * Anime Aggressors Performance Engine - Thread slots
+ * Process-wide per-thread slot ids and owner-only counter updates
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace AnimeAggressors {
+
+// Process-wide slot ids in [0, Capacity) for the threads of one subsystem,
+// named by Tag. A thread claims the lowest free slot on first use and gives
+// it back on exit, so a later thread inherits the slot (and whatever the
+// subsystem keeps in it) instead of leaking it. Once every slot is taken,
+// further threads get NONE and the subsystem falls back to shared state.
+template<typename Tag, size_t Capacity>
+class ThreadSlots {
+public:
+    static constexpr int NONE = -1;
+
+    // The calling thread's slot, claiming one on first use.
+    static int current() {
+        const int slot = t_slot_;
+        return slot == UNASSIGNED ? claim() : slot;
+    }
+
+private:
+    static constexpr int UNASSIGNED = -2;
+
+    struct Releaser {
+        ~Releaser() {
+            if (t_slot_ < 0) return;
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_use_[static_cast<size_t>(t_slot_)] = false;
+            t_slot_ = UNASSIGNED;
+        }
+    };
+
+    static int claim() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            t_slot_ = NONE;
+            for (size_t i = 0; i < Capacity; ++i) {
+                if (!in_use_[i]) {
+                    in_use_[i] = true;
+                    t_slot_ = static_cast<int>(i);
+                    break;
+                }
+            }
+        }
+        thread_local Releaser releaser;
+        (void)releaser;
+        return t_slot_;
+    }
+
+    static inline std::mutex mutex_;
+    static inline std::array<bool, Capacity> in_use_{};
+    // Trivially initialised so the hot path reads it without a TLS init
+    // guard; the releaser is only constructed once a slot is claimed.
+    static inline thread_local int t_slot_ = UNASSIGNED;
+};
+
+// Owner-only counter update: a plain load/store pair instead of an atomic
+// read-modify-write, since only the owning thread writes and readers only
+// need an approximate snapshot.
+template<typename T>
+inline void owner_add(std::atomic<T>& counter, T delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+} // namespace AnimeAggressors
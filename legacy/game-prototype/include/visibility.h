@@ -0,0 +1,172 @@
+/**
+ * Anime Aggressors Performance Engine - Visibility
+ * Refitted BVH over entity bounds with batched frustum culling and distance LOD
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "batch_math.h"
+#include "slot_map.h"
+
+namespace AnimeAggressors {
+
+constexpr size_t MAX_LOD_LEVELS = 4;
+constexpr uint32_t CULLING_LEAF_SIZE = 8;
+constexpr float CULLING_MARGIN = 1.0f;    // how far a box moves before its leaf is refit
+
+// Six inward-facing unit planes (near, far, left, right, bottom, top) and
+// the eye they were built from, which LOD distances are measured to.
+struct Frustum {
+    Plane planes[6];
+    float eye[3];
+};
+
+// Perspective frustum looking from `eye` at `target`. `fov_y` is the full
+// vertical angle in radians and `aspect` is width over height. Throws
+// std::invalid_argument for a non-positive fov, aspect or near distance, or
+// far not beyond near.
+Frustum make_frustum(const float eye[3], const float target[3], const float up[3], float fov_y, float aspect,
+                     float near_distance, float far_distance);
+
+struct VisibleEntity {
+    SlotHandle entity;
+    uint32_t lod;      // 0 is the most detailed
+};
+
+// Entity boxes in a bounding volume hierarchy, kept current by refitting.
+//
+// Each entity's box, its fattened copy and its place in the tree share one
+// record, in the order entities were added (swap-removed), so pushing a box
+// touches one cache line after the slot lookup. The tree holds each box
+// grown by CULLING_MARGIN, in leaf order; a box that leaves its fattened
+// copy re-grows it and marks its leaf, and refit() recomputes bounds from
+// the marked leaves up to the first ancestor that does not change, or in
+// one bottom-up pass over every node once marked leaves are too many for
+// that to be cheaper. Boxes that stay inside their margin cost nothing
+// beyond the push. Entities added since the last build wait in a loose
+// list that is tested linearly, and removed ones become tombstones in
+// their leaves; refit() rebuilds by median split once those make up a
+// quarter of the items or refitting has doubled the root's surface area.
+//
+// cull() walks the tree: nodes wholly outside a plane are skipped, nodes
+// wholly inside accept all their items, and straddling leaves gather their
+// exact boxes through batch_plane_distance, so results match testing every
+// box. Visible entities get a LOD level from their distance to the eye.
+// Buffers keep their capacity, so a steady scene does not allocate.
+// Entities are found through a table indexed by handle slot rather than a
+// hash. A push costs more than testing the box outright, so the tree only
+// pays when callers push just the boxes that moved; a caller that pushes
+// every box each frame is better served by BatchCuller. Not thread-safe.
+class CullingBvh {
+public:
+    struct Stats {
+        size_t items = 0;
+        size_t visible = 0;
+        size_t culled = 0;
+        size_t nodes = 0;
+        size_t nodes_visited = 0;
+        size_t items_tested = 0;    // through the plane kernel
+        size_t escaped = 0;         // boxes that outgrew their margin before the last refit
+        size_t nodes_refit = 0;     // by the last refit
+        size_t rebuilds = 0;        // total
+        double refit_us = 0.0;
+        double cull_us = 0.0;
+    };
+
+    explicit CullingBvh(size_t capacity = 0);
+
+    // Adds the entity, or moves its box; `extent` is the half size.
+    void set_bounds(SlotHandle entity, const float center[3], const float extent[3]);
+    bool remove(SlotHandle entity);
+    void clear();
+    size_t size() const { return items_.size(); }
+
+    // Level i is used up to distances[i] from the eye; beyond the last, the
+    // coarsest level. Throws std::invalid_argument unless the distances are
+    // positive and ascending.
+    void set_lod_distances(const float distances[MAX_LOD_LEVELS - 1]);
+
+    // Rebuilds if due, else refits the leaves whose boxes left their margin.
+    void refit();
+    // Replaces `visible` with the entities that may intersect the frustum.
+    // Call refit() first after moving boxes.
+    void cull(const Frustum& frustum, std::vector<VisibleEntity>& visible);
+
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    struct Node {
+        float min[3];
+        float max[3];
+        uint32_t begin;     // leaf-order range
+        uint32_t end;
+        uint32_t left;      // children are left and left + 1; 0 for a leaf
+        uint32_t parent;    // NO_PARENT for the root
+    };
+
+    struct Item {
+        float center[3];
+        float extent[3];
+        float fat_min[3];
+        float fat_max[3];
+        SlotHandle entity;
+        uint32_t place;     // leaf position, or LOOSE_ITEM | index in loose_
+    };
+
+    std::vector<Item> items_;
+    std::vector<uint32_t> slot_items_;    // item per handle slot index, or NO_CULLING_ITEM
+
+    // Per leaf position: the item, or NO_CULLING_ITEM for a tombstone, its
+    // fattened box, inside out for a tombstone, and the leaf node holding it
+    std::vector<uint32_t> leaf_items_;    // also the build's permutation
+    std::vector<float> leaf_min_[3];
+    std::vector<float> leaf_max_[3];
+    std::vector<uint32_t> leaf_nodes_;
+    std::vector<uint32_t> loose_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> dirty_nodes_;   // leaf nodes to refit, may repeat
+    size_t tombstones_;
+    size_t escaped_;
+    float build_area_;          // root surface area after the last build
+    float lod_distance_squared_[MAX_LOD_LEVELS - 1];
+    std::vector<float> gathered_;         // exact boxes for the plane kernel, then its output
+    std::vector<uint32_t> stack_;
+    Stats stats_;
+
+    uint32_t find(SlotHandle entity) const;
+    void grow_leaf_box(uint32_t item);
+    void rebuild();
+    void build_node(uint32_t node, uint32_t begin, uint32_t end);
+    void refit_nodes();
+    void refit_path(uint32_t node);
+    void accept(uint32_t begin, uint32_t end, const float eye[3], std::vector<VisibleEntity>& visible) const;
+    void test(const uint32_t* items, size_t count, const Frustum& frustum, std::vector<VisibleEntity>& visible);
+    uint32_t lod_for(uint32_t item, const float eye[3]) const;
+};
+
+// Frustum culling with no tree: each call tests the boxes it is given in
+// one batch_plane_distance pass and appends the visible ones with their LOD
+// level. For callers that hold every box in SoA streams and cannot tell
+// which moved, this beats keeping a CullingBvh current. Not thread-safe.
+class BatchCuller {
+public:
+    BatchCuller();
+
+    // As CullingBvh::set_lod_distances.
+    void set_lod_distances(const float distances[MAX_LOD_LEVELS - 1]);
+
+    // Appends the entities whose boxes (`extent` is the half size) may
+    // intersect the frustum to `visible`; returns how many were appended.
+    size_t cull(const Frustum& frustum, const SlotHandle* entities, ConstVec3SoA center, ConstVec3SoA extent,
+                size_t count, std::vector<VisibleEntity>& visible);
+
+private:
+    float lod_distance_squared_[MAX_LOD_LEVELS - 1];
+    std::vector<float> distances_;
+};
+
+} // namespace AnimeAggressors
@@ -0,0 +1,83 @@
+/**
+ * Anime Aggressors Performance Engine - Async asset cache
+ */
+
+#include "async_cache.h"
+
+#include <memory>
+
+namespace AnimeAggressors {
+
+namespace {
+
+std::shared_future<std::string> ready_future(std::string value) {
+    std::promise<std::string> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future().share();
+}
+
+} // namespace
+
+// AsyncCache Implementation
+AsyncCache::AsyncCache(CacheSystem& cache, ThreadPool& pool) : cache_(cache), pool_(pool) {}
+
+AsyncCache::~AsyncCache() {
+    pool_.wait(loads_);
+}
+
+std::shared_future<std::string> AsyncCache::get_or_load(std::string_view key, Loader loader) {
+    std::string value;
+    if (cache_.get(key, value)) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return ready_future(std::move(value));
+    }
+
+    std::string owned_key(key);
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::shared_future<std::string> result;
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        auto it = in_flight_.find(owned_key);
+        if (it != in_flight_.end()) {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+        // A load that finished between the miss above and taking the lock
+        // is not re-checked: that would count a second miss and read the
+        // disk tier under this lock. The rare race costs one extra load.
+        result = promise->get_future().share();
+        in_flight_.emplace(owned_key, result);
+    }
+
+    loads_started_.fetch_add(1, std::memory_order_relaxed);
+    pool_.submit(loads_, [this, key = std::move(owned_key), loader = std::move(loader), promise]() mutable {
+        try {
+            std::string loaded = loader();
+            cache_.put(key, loaded);
+            finish_load(key);
+            promise->set_value(std::move(loaded));
+        } catch (...) {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+            finish_load(key);
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return result;
+}
+
+void AsyncCache::finish_load(const std::string& key) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    in_flight_.erase(key);
+}
+
+size_t AsyncCache::get_in_flight() const {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    return in_flight_.size();
+}
+
+AsyncCache::Stats AsyncCache::get_stats() const {
+    return {hits_.load(std::memory_order_relaxed), loads_started_.load(std::memory_order_relaxed),
+            coalesced_.load(std::memory_order_relaxed), failures_.load(std::memory_order_relaxed)};
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,462 @@
+/**
+ * Anime Aggressors Performance Engine - Audio mixer
+ */
+
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "batch_math.h"
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr size_t MAX_AUDIO_VOICES = size_t(1) << 16;
+constexpr uint32_t SLOT_MASK = 0xFFFF;
+constexpr uint32_t GENERATION_SHIFT = 16;
+constexpr float QUARTER_PI = 0.78539816f;
+constexpr auto BLOCK_PERIOD = std::chrono::microseconds(1000000 * AUDIO_BLOCK_FRAMES / AUDIO_SAMPLE_RATE);
+
+void put_u16(unsigned char* out, uint16_t value) {
+    out[0] = static_cast<unsigned char>(value);
+    out[1] = static_cast<unsigned char>(value >> 8);
+}
+
+void put_u32(unsigned char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+// RIFF header for IEEE float stereo at AUDIO_SAMPLE_RATE holding `frames`.
+void make_wav_header(unsigned char header[44], uint64_t frames) {
+    const uint32_t frame_bytes = AUDIO_CHANNELS * sizeof(float);
+    const uint32_t data_bytes = static_cast<uint32_t>(std::min<uint64_t>(frames * frame_bytes, UINT32_MAX - 36));
+    std::memcpy(header, "RIFF", 4);
+    put_u32(header + 4, 36 + data_bytes);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, 3);    // WAVE_FORMAT_IEEE_FLOAT
+    put_u16(header + 22, AUDIO_CHANNELS);
+    put_u32(header + 24, AUDIO_SAMPLE_RATE);
+    put_u32(header + 28, AUDIO_SAMPLE_RATE * frame_bytes);
+    put_u16(header + 32, frame_bytes);
+    put_u16(header + 34, 32);
+    std::memcpy(header + 36, "data", 4);
+    put_u32(header + 40, data_bytes);
+}
+
+} // namespace
+
+// Sink Implementation
+void NullAudioSink::write(const float*, size_t frames) {
+    frames_.fetch_add(frames, std::memory_order_relaxed);
+}
+
+WavFileAudioSink::WavFileAudioSink(const std::string& path) : file_(std::fopen(path.c_str(), "wb")), frames_(0) {
+    if (!file_) throw std::runtime_error("WavFileAudioSink: cannot create " + path);
+    unsigned char header[44];
+    make_wav_header(header, 0);
+    std::fwrite(header, 1, sizeof(header), file_);
+}
+
+WavFileAudioSink::~WavFileAudioSink() {
+    unsigned char header[44];
+    make_wav_header(header, frames_);
+    std::fseek(file_, 0, SEEK_SET);
+    std::fwrite(header, 1, sizeof(header), file_);
+    std::fclose(file_);
+}
+
+void WavFileAudioSink::write(const float* samples, size_t frames) {
+    // Samples go out in host order, which WAV expects to be little-endian
+    frames_ += std::fwrite(samples, sizeof(float) * AUDIO_CHANNELS, frames, file_);
+}
+
+// AudioMixer Implementation
+AudioMixer::AudioMixer(size_t max_voices)
+    : max_voices_(max_voices), commands_(AUDIO_COMMAND_CAPACITY), finished_(max_voices),
+      master_gain_(1.0f), running_(false), blocks_(0), late_blocks_(0), total_block_ns_(0),
+      last_block_ns_(0), max_block_ns_(0), real_voices_(0), virtual_voices_(0), dropped_commands_(0) {
+    if (max_voices == 0 || max_voices > MAX_AUDIO_VOICES) {
+        throw std::invalid_argument("AudioMixer: max_voices must be between 1 and 65536");
+    }
+    generations_.assign(max_voices, 0);
+    free_slots_.reserve(max_voices);
+    for (size_t slot = max_voices; slot-- > 0;) free_slots_.push_back(static_cast<uint16_t>(slot));
+
+    voices_.assign(max_voices, Voice{});
+    active_.reserve(max_voices);
+    ranked_.reserve(max_voices);
+    max_real_voices_ = max_voices;
+    listener_position_[0] = listener_position_[1] = listener_position_[2] = 0.0f;
+    listener_right_[0] = 1.0f;
+    listener_right_[1] = listener_right_[2] = 0.0f;
+    std::fill(bus_gains_, bus_gains_ + AUDIO_BUS_COUNT, 1.0f);
+    bus_buffers_.assign(AUDIO_BUS_COUNT * AUDIO_CHANNELS * AUDIO_BLOCK_FRAMES, 0.0f);
+    mix_buffer_.assign(AUDIO_CHANNELS * AUDIO_BLOCK_FRAMES, 0.0f);
+}
+
+AudioMixer::~AudioMixer() {
+    stop_thread();
+}
+
+SoundHandle AudioMixer::play(const AudioClip& clip, const VoiceParams& params) {
+    if (!clip.samples || clip.frames == 0 || free_slots_.empty()) return NO_SOUND;
+
+    const uint16_t slot = free_slots_.back();
+    const uint16_t generation = ++generations_[slot];
+    const SoundHandle sound = (static_cast<uint32_t>(generation) << GENERATION_SHIFT) | slot;
+
+    Command command{};
+    command.type = COMMAND_PLAY;
+    command.bus = params.bus < AUDIO_BUS_COUNT ? params.bus : AUDIO_BUS_SFX;
+    command.priority = params.priority;
+    command.positional = params.positional;
+    command.loop = params.loop;
+    command.sound = sound;
+    command.samples = clip.samples;
+    command.frames = static_cast<uint32_t>(std::min<size_t>(clip.frames, UINT32_MAX));
+    command.gain = params.gain;
+    std::copy(params.position, params.position + 3, command.vectors);
+    if (!push(command)) {
+        ++generations_[slot];
+        return NO_SOUND;
+    }
+    free_slots_.pop_back();
+    return sound;
+}
+
+void AudioMixer::stop(SoundHandle sound) {
+    if (!is_playing(sound)) return;
+    Command command{};
+    command.type = COMMAND_STOP;
+    command.sound = sound;
+    push(command);
+}
+
+void AudioMixer::set_voice_position(SoundHandle sound, const float position[3]) {
+    if (!is_playing(sound)) return;
+    Command command{};
+    command.type = COMMAND_SET_POSITION;
+    command.sound = sound;
+    std::copy(position, position + 3, command.vectors);
+    push(command);
+}
+
+void AudioMixer::set_voice_gain(SoundHandle sound, float gain) {
+    if (!is_playing(sound)) return;
+    Command command{};
+    command.type = COMMAND_SET_GAIN;
+    command.sound = sound;
+    command.gain = gain;
+    push(command);
+}
+
+void AudioMixer::set_listener(const float position[3], const float forward[3], const float up[3]) {
+    Command command{};
+    command.type = COMMAND_SET_LISTENER;
+    std::copy(position, position + 3, command.vectors);
+    std::copy(forward, forward + 3, command.vectors + 3);
+    std::copy(up, up + 3, command.vectors + 6);
+    push(command);
+}
+
+void AudioMixer::set_bus_gain(AudioBus bus, float gain) {
+    if (bus >= AUDIO_BUS_COUNT) return;
+    Command command{};
+    command.type = COMMAND_SET_BUS_GAIN;
+    command.bus = bus;
+    command.gain = gain;
+    push(command);
+}
+
+void AudioMixer::set_master_gain(float gain) {
+    Command command{};
+    command.type = COMMAND_SET_MASTER_GAIN;
+    command.gain = gain;
+    push(command);
+}
+
+void AudioMixer::set_max_real_voices(size_t count) {
+    Command command{};
+    command.type = COMMAND_SET_MAX_REAL_VOICES;
+    command.frames = static_cast<uint32_t>(std::min(count, max_voices_));
+    push(command);
+}
+
+void AudioMixer::update() {
+    SoundHandle sound;
+    while (finished_.try_pop(sound)) {
+        const uint16_t slot = static_cast<uint16_t>(sound & SLOT_MASK);
+        if (generations_[slot] != sound >> GENERATION_SHIFT) continue;
+        ++generations_[slot];
+        free_slots_.push_back(slot);
+    }
+}
+
+bool AudioMixer::is_playing(SoundHandle sound) const {
+    const uint32_t slot = sound & SLOT_MASK;
+    const uint32_t generation = sound >> GENERATION_SHIFT;
+    return slot < max_voices_ && (generation & 1) && generations_[slot] == generation;
+}
+
+bool AudioMixer::push(const Command& command) {
+    if (commands_.try_push(command)) return true;
+    dropped_commands_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AudioMixer::apply(const Command& command) {
+    if (command.type == COMMAND_SET_LISTENER) {
+        std::copy(command.vectors, command.vectors + 3, listener_position_);
+        const float* forward = command.vectors + 3;
+        const float* up = command.vectors + 6;
+        float right[3] = {forward[1] * up[2] - forward[2] * up[1], forward[2] * up[0] - forward[0] * up[2],
+                          forward[0] * up[1] - forward[1] * up[0]};
+        if (normalize3(right)) std::copy(right, right + 3, listener_right_);
+        return;
+    }
+    if (command.type == COMMAND_SET_BUS_GAIN) {
+        bus_gains_[command.bus] = command.gain;
+        return;
+    }
+    if (command.type == COMMAND_SET_MASTER_GAIN) {
+        master_gain_ = command.gain;
+        return;
+    }
+    if (command.type == COMMAND_SET_MAX_REAL_VOICES) {
+        max_real_voices_ = command.frames;
+        return;
+    }
+
+    const uint32_t slot = command.sound & SLOT_MASK;
+    Voice& voice = voices_[slot];
+    if (command.type == COMMAND_PLAY) {
+        voice.sound = command.sound;
+        voice.samples = command.samples;
+        voice.frames = command.frames;
+        voice.cursor = 0;
+        voice.active = static_cast<uint32_t>(active_.size());
+        voice.gain = command.gain;
+        std::copy(command.vectors, command.vectors + 3, voice.position);
+        voice.bus = command.bus;
+        voice.priority = command.priority;
+        voice.state = VOICE_NEW;
+        voice.positional = command.positional;
+        voice.loop = command.loop;
+        active_.push_back(slot);
+        return;
+    }
+    // The voice may have ended since the game thread sent this
+    if (voice.sound != command.sound) return;
+    switch (command.type) {
+        case COMMAND_STOP:
+            finish(slot);
+            break;
+        case COMMAND_SET_POSITION:
+            std::copy(command.vectors, command.vectors + 3, voice.position);
+            break;
+        case COMMAND_SET_GAIN:
+            voice.gain = command.gain;
+            break;
+        default:
+            break;
+    }
+}
+
+void AudioMixer::finish(uint32_t slot) {
+    Voice& voice = voices_[slot];
+    // Never full: each handle the game holds finishes at most once
+    finished_.try_push(voice.sound);
+    voice.sound = NO_SOUND;
+    const uint32_t moved = active_.back();
+    active_[voice.active] = moved;
+    voices_[moved].active = voice.active;
+    active_.pop_back();
+}
+
+size_t AudioMixer::choose_real_voices() {
+    ranked_.clear();
+    for (uint32_t slot : active_) {
+        Voice& voice = voices_[slot];
+        voice.attenuated = voice.gain;
+        voice.pan = 0.0f;
+        if (voice.positional) {
+            const float offset[3] = {voice.position[0] - listener_position_[0],
+                                     voice.position[1] - listener_position_[1],
+                                     voice.position[2] - listener_position_[2]};
+            const float distance = std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+            voice.attenuated = voice.gain * AUDIO_REFERENCE_DISTANCE / std::max(distance, AUDIO_REFERENCE_DISTANCE);
+            if (distance > 1e-6f) {
+                voice.pan = (offset[0] * listener_right_[0] + offset[1] * listener_right_[1] +
+                             offset[2] * listener_right_[2]) / distance;
+            }
+        }
+        const float audibility = std::fabs(voice.attenuated) * bus_gains_[voice.bus];
+        voice.real = audibility >= AUDIO_AUDIBLE_GAIN;
+        if (!voice.real) continue;
+        uint32_t bits;
+        std::memcpy(&bits, &audibility, sizeof(bits));
+        ranked_.push_back(RankedVoice{(static_cast<uint64_t>(voice.priority) << 32) | bits, slot});
+    }
+    if (ranked_.size() <= max_real_voices_) return ranked_.size();
+
+    // Non-negative floats order the same as their bits
+    const auto cut = ranked_.begin() + max_real_voices_;
+    std::nth_element(ranked_.begin(), cut, ranked_.end(),
+                     [](const RankedVoice& a, const RankedVoice& b) { return a.score > b.score; });
+    for (auto it = cut; it != ranked_.end(); ++it) voices_[it->slot].real = false;
+    return max_real_voices_;
+}
+
+bool AudioMixer::mix_voice(Voice& voice, float fade_from, float fade_to) {
+    // Panned here rather than when scoring, so virtual voices skip the trig
+    float left_gain = voice.attenuated;
+    float right_gain = voice.attenuated;
+    if (voice.positional) {
+        const float angle = (voice.pan + 1.0f) * QUARTER_PI;
+        left_gain *= std::cos(angle);
+        right_gain *= std::sin(angle);
+    }
+    float* left = bus_buffers_.data() + voice.bus * AUDIO_CHANNELS * AUDIO_BLOCK_FRAMES;
+    float* right = left + AUDIO_BLOCK_FRAMES;
+    const float fade_step = (fade_to - fade_from) / AUDIO_BLOCK_FRAMES;
+    size_t done = 0;
+    while (done < AUDIO_BLOCK_FRAMES) {
+        const size_t count = std::min<size_t>(AUDIO_BLOCK_FRAMES - done, voice.frames - voice.cursor);
+        const float* samples = voice.samples + voice.cursor;
+        if (fade_step == 0.0f) {
+            batch_multiply_add(left + done, left + done, samples, left_gain * fade_to, count);
+            batch_multiply_add(right + done, right + done, samples, right_gain * fade_to, count);
+        } else {
+            // Fades only happen on the block a voice changes sides
+            for (size_t i = 0; i < count; ++i) {
+                const float fade = fade_from + fade_step * static_cast<float>(done + i);
+                left[done + i] += samples[i] * left_gain * fade;
+                right[done + i] += samples[i] * right_gain * fade;
+            }
+        }
+        done += count;
+        voice.cursor += static_cast<uint32_t>(count);
+        if (voice.cursor == voice.frames) {
+            if (!voice.loop) return false;
+            voice.cursor = 0;
+        }
+    }
+    return true;
+}
+
+bool AudioMixer::skip_voice(Voice& voice) {
+    const size_t cursor = static_cast<size_t>(voice.cursor) + AUDIO_BLOCK_FRAMES;
+    if (cursor < voice.frames) {
+        voice.cursor = static_cast<uint32_t>(cursor);
+        return true;
+    }
+    if (!voice.loop) return false;
+    voice.cursor = static_cast<uint32_t>(cursor % voice.frames);
+    return true;
+}
+
+void AudioMixer::mix_block(float* out) {
+    const auto start = std::chrono::steady_clock::now();
+
+    Command command;
+    while (commands_.try_pop(command)) apply(command);
+
+    std::fill(bus_buffers_.begin(), bus_buffers_.end(), 0.0f);
+    const uint32_t voice_count = static_cast<uint32_t>(active_.size());
+    const uint32_t real_count = static_cast<uint32_t>(choose_real_voices());
+    for (size_t i = 0; i < active_.size();) {
+        const uint32_t slot = active_[i];
+        Voice& voice = voices_[slot];
+        bool playing;
+        if (voice.real) {
+            playing = mix_voice(voice, voice.state == VOICE_VIRTUAL ? 0.0f : 1.0f, 1.0f);
+            voice.state = VOICE_REAL;
+        } else {
+            playing = voice.state == VOICE_REAL ? mix_voice(voice, 1.0f, 0.0f) : skip_voice(voice);
+            voice.state = VOICE_VIRTUAL;
+        }
+        if (playing) {
+            ++i;
+        } else {
+            finish(slot);   // moves the last active voice into i
+        }
+    }
+    // Buses into the master mix, then clamp and interleave
+    std::fill(mix_buffer_.begin(), mix_buffer_.end(), 0.0f);
+    for (size_t bus = 0; bus < AUDIO_BUS_COUNT; ++bus) {
+        const float gain = bus_gains_[bus] * master_gain_;
+        for (size_t channel = 0; channel < AUDIO_CHANNELS; ++channel) {
+            float* mix = mix_buffer_.data() + channel * AUDIO_BLOCK_FRAMES;
+            const float* source = bus_buffers_.data() + (bus * AUDIO_CHANNELS + channel) * AUDIO_BLOCK_FRAMES;
+            batch_multiply_add(mix, mix, source, gain, AUDIO_BLOCK_FRAMES);
+        }
+    }
+    const float* left = mix_buffer_.data();
+    const float* right = left + AUDIO_BLOCK_FRAMES;
+    for (size_t frame = 0; frame < AUDIO_BLOCK_FRAMES; ++frame) {
+        out[frame * 2] = std::min(std::max(left[frame], -1.0f), 1.0f);
+        out[frame * 2 + 1] = std::min(std::max(right[frame], -1.0f), 1.0f);
+    }
+
+    const uint64_t elapsed = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    // Only this thread writes these, so plain loads and stores suffice
+    blocks_.store(blocks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total_block_ns_.store(total_block_ns_.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+    last_block_ns_.store(elapsed, std::memory_order_relaxed);
+    if (elapsed > max_block_ns_.load(std::memory_order_relaxed)) max_block_ns_.store(elapsed, std::memory_order_relaxed);
+    real_voices_.store(real_count, std::memory_order_relaxed);
+    virtual_voices_.store(voice_count - real_count, std::memory_order_relaxed);
+}
+
+void AudioMixer::start_thread(AudioSink& sink, bool paced) {
+    stop_thread();
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this, &sink, paced] { run(sink, paced); });
+}
+
+void AudioMixer::stop_thread() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+}
+
+void AudioMixer::run(AudioSink& sink, bool paced) {
+    std::vector<float> block(AUDIO_CHANNELS * AUDIO_BLOCK_FRAMES);
+    auto deadline = std::chrono::steady_clock::now();
+    while (running_.load(std::memory_order_acquire)) {
+        mix_block(block.data());
+        sink.write(block.data(), AUDIO_BLOCK_FRAMES);
+        if (!paced) continue;
+        deadline += BLOCK_PERIOD;
+        const auto now = std::chrono::steady_clock::now();
+        if (now > deadline) {
+            // Fell behind; count it and restart the schedule rather than burst
+            late_blocks_.fetch_add(1, std::memory_order_relaxed);
+            deadline = now;
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+AudioMixer::Stats AudioMixer::get_stats() const {
+    Stats stats;
+    stats.blocks = blocks_.load(std::memory_order_relaxed);
+    stats.late_blocks = late_blocks_.load(std::memory_order_relaxed);
+    stats.dropped_commands = dropped_commands_.load(std::memory_order_relaxed);
+    stats.real_voices = real_voices_.load(std::memory_order_relaxed);
+    stats.virtual_voices = virtual_voices_.load(std::memory_order_relaxed);
+    stats.last_block_us = last_block_ns_.load(std::memory_order_relaxed) / 1000.0;
+    stats.max_block_us = max_block_ns_.load(std::memory_order_relaxed) / 1000.0;
+    stats.average_block_us =
+        stats.blocks ? total_block_ns_.load(std::memory_order_relaxed) / 1000.0 / stats.blocks : 0.0;
+    return stats;
+}
+
+} // namespace AnimeAggressors
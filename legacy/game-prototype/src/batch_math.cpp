@@ -0,0 +1,322 @@
+/**
+ * Anime Aggressors Performance Engine - Batch vector math
+ */
+
+#include "batch_math.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define AA_BATCH_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define AA_BATCH_AVX2 1
+#endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define AA_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace AnimeAggressors {
+
+namespace {
+
+// Register wrappers. Each provides WIDTH, load/store/set, + - * /, and the
+// free functions fmadd(a, b, c) = a * b + c, minimum, maximum, square_root
+// and keep_if_positive(mask_source, value) = value where mask_source > 0,
+// else 0.
+struct ScalarLane {
+    static constexpr size_t WIDTH = 1;
+    float v;
+
+    static ScalarLane load(const float* p) { return {*p}; }
+    static ScalarLane set(float f) { return {f}; }
+    void store(float* p) const { *p = v; }
+};
+
+inline ScalarLane operator+(ScalarLane a, ScalarLane b) { return {a.v + b.v}; }
+inline ScalarLane operator-(ScalarLane a, ScalarLane b) { return {a.v - b.v}; }
+inline ScalarLane operator*(ScalarLane a, ScalarLane b) { return {a.v * b.v}; }
+inline ScalarLane operator/(ScalarLane a, ScalarLane b) { return {a.v / b.v}; }
+inline ScalarLane fmadd(ScalarLane a, ScalarLane b, ScalarLane c) { return {a.v * b.v + c.v}; }
+inline ScalarLane minimum(ScalarLane a, ScalarLane b) { return {b.v < a.v ? b.v : a.v}; }
+inline ScalarLane maximum(ScalarLane a, ScalarLane b) { return {b.v > a.v ? b.v : a.v}; }
+inline ScalarLane square_root(ScalarLane a) { return {std::sqrt(a.v)}; }
+inline ScalarLane keep_if_positive(ScalarLane mask_source, ScalarLane value) {
+    return {mask_source.v > 0.0f ? value.v : 0.0f};
+}
+
+struct Kernels {
+    SimdIsa isa;
+    void (*add)(Vec3SoA, ConstVec3SoA, ConstVec3SoA, size_t);
+    void (*scale)(Vec3SoA, ConstVec3SoA, float, size_t);
+    void (*multiply_add)(Vec3SoA, ConstVec3SoA, ConstVec3SoA, float, size_t);
+    void (*normalize)(Vec3SoA, ConstVec3SoA, size_t);
+    void (*lerp)(Vec3SoA, ConstVec3SoA, ConstVec3SoA, float, size_t);
+    void (*clamp)(Vec3SoA, ConstVec3SoA, const Bounds3&, size_t);
+    void (*quat_rotate)(Vec3SoA, ConstQuatSoA, ConstVec3SoA, size_t);
+    void (*transform_compose)(TransformSoA, ConstTransformSoA, ConstTransformSoA, size_t);
+    void (*add_scalar)(float*, const float*, float, size_t);
+    void (*multiply_add_scalar)(float*, const float*, const float*, float, size_t);
+    void (*plane_distance)(float*, const Plane*, size_t, ConstVec3SoA, ConstVec3SoA, size_t);
+};
+
+#define AA_BATCH_KERNEL_TABLE(isa, ns)                                                            \
+    Kernels {                                                                                     \
+        isa, ns::add, ns::scale, ns::multiply_add, ns::normalize, ns::lerp, ns::clamp,            \
+            ns::quat_rotate, ns::transform_compose, ns::add_scalar, ns::multiply_add_scalar,      \
+            ns::plane_distance                                                                    \
+    }
+
+namespace scalar_kernels {
+using Lane = ScalarLane;
+#include "batch_math_kernels.inl"
+} // namespace scalar_kernels
+
+#ifdef AA_BATCH_SSE2
+namespace sse2_kernels {
+struct Lane {
+    static constexpr size_t WIDTH = 4;
+    __m128 v;
+
+    static Lane load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static Lane set(float f) { return {_mm_set1_ps(f)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    friend Lane operator+(Lane a, Lane b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend Lane operator-(Lane a, Lane b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend Lane operator*(Lane a, Lane b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend Lane operator/(Lane a, Lane b) { return {_mm_div_ps(a.v, b.v)}; }
+    friend Lane fmadd(Lane a, Lane b, Lane c) { return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)}; }
+    friend Lane minimum(Lane a, Lane b) { return {_mm_min_ps(a.v, b.v)}; }
+    friend Lane maximum(Lane a, Lane b) { return {_mm_max_ps(a.v, b.v)}; }
+    friend Lane square_root(Lane a) { return {_mm_sqrt_ps(a.v)}; }
+    friend Lane keep_if_positive(Lane mask_source, Lane value) {
+        return {_mm_and_ps(_mm_cmpgt_ps(mask_source.v, _mm_setzero_ps()), value.v)};
+    }
+};
+#include "batch_math_kernels.inl"
+} // namespace sse2_kernels
+#endif
+
+#ifdef AA_BATCH_AVX2
+// Compiled for AVX2/FMA regardless of the build flags and only selected
+// after the CPU check in detect_simd_isa().
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace avx2_kernels {
+// GCC does not carry the pragma over to functions defined in the class body.
+#define AA_AVX2 __attribute__((target("avx2,fma")))
+struct Lane {
+    static constexpr size_t WIDTH = 8;
+    __m256 v;
+
+    AA_AVX2 static Lane load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    AA_AVX2 static Lane set(float f) { return {_mm256_set1_ps(f)}; }
+    AA_AVX2 void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+    AA_AVX2 friend Lane operator+(Lane a, Lane b) { return {_mm256_add_ps(a.v, b.v)}; }
+    AA_AVX2 friend Lane operator-(Lane a, Lane b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    AA_AVX2 friend Lane operator*(Lane a, Lane b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    AA_AVX2 friend Lane operator/(Lane a, Lane b) { return {_mm256_div_ps(a.v, b.v)}; }
+    AA_AVX2 friend Lane fmadd(Lane a, Lane b, Lane c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+    AA_AVX2 friend Lane minimum(Lane a, Lane b) { return {_mm256_min_ps(a.v, b.v)}; }
+    AA_AVX2 friend Lane maximum(Lane a, Lane b) { return {_mm256_max_ps(a.v, b.v)}; }
+    AA_AVX2 friend Lane square_root(Lane a) { return {_mm256_sqrt_ps(a.v)}; }
+    AA_AVX2 friend Lane keep_if_positive(Lane mask_source, Lane value) {
+        return {_mm256_and_ps(_mm256_cmp_ps(mask_source.v, _mm256_setzero_ps(), _CMP_GT_OQ), value.v)};
+    }
+};
+#include "batch_math_kernels.inl"
+} // namespace avx2_kernels
+#undef AA_AVX2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+#ifdef AA_BATCH_NEON
+namespace neon_kernels {
+struct Lane {
+    static constexpr size_t WIDTH = 4;
+    float32x4_t v;
+
+    static Lane load(const float* p) { return {vld1q_f32(p)}; }
+    static Lane set(float f) { return {vdupq_n_f32(f)}; }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    friend Lane operator+(Lane a, Lane b) { return {vaddq_f32(a.v, b.v)}; }
+    friend Lane operator-(Lane a, Lane b) { return {vsubq_f32(a.v, b.v)}; }
+    friend Lane operator*(Lane a, Lane b) { return {vmulq_f32(a.v, b.v)}; }
+    friend Lane operator/(Lane a, Lane b) { return {vdivq_f32(a.v, b.v)}; }
+    friend Lane fmadd(Lane a, Lane b, Lane c) { return {vfmaq_f32(c.v, a.v, b.v)}; }
+    friend Lane minimum(Lane a, Lane b) { return {vminq_f32(a.v, b.v)}; }
+    friend Lane maximum(Lane a, Lane b) { return {vmaxq_f32(a.v, b.v)}; }
+    friend Lane square_root(Lane a) { return {vsqrtq_f32(a.v)}; }
+    friend Lane keep_if_positive(Lane mask_source, Lane value) {
+        const uint32x4_t mask = vcgtq_f32(mask_source.v, vdupq_n_f32(0.0f));
+        return {vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(value.v)))};
+    }
+};
+#include "batch_math_kernels.inl"
+} // namespace neon_kernels
+#endif
+
+const Kernels SCALAR_KERNELS = AA_BATCH_KERNEL_TABLE(SimdIsa::SCALAR, scalar_kernels);
+#ifdef AA_BATCH_SSE2
+const Kernels SSE2_KERNELS = AA_BATCH_KERNEL_TABLE(SimdIsa::SSE2, sse2_kernels);
+#endif
+#ifdef AA_BATCH_AVX2
+const Kernels AVX2_KERNELS = AA_BATCH_KERNEL_TABLE(SimdIsa::AVX2, avx2_kernels);
+#endif
+#ifdef AA_BATCH_NEON
+const Kernels NEON_KERNELS = AA_BATCH_KERNEL_TABLE(SimdIsa::NEON, neon_kernels);
+#endif
+
+const Kernels* kernels_for(SimdIsa isa) {
+    switch (isa) {
+#ifdef AA_BATCH_SSE2
+        case SimdIsa::SSE2: return &SSE2_KERNELS;
+#endif
+#ifdef AA_BATCH_AVX2
+        case SimdIsa::AVX2: return &AVX2_KERNELS;
+#endif
+#ifdef AA_BATCH_NEON
+        case SimdIsa::NEON: return &NEON_KERNELS;
+#endif
+        case SimdIsa::SCALAR: return &SCALAR_KERNELS;
+        default: return nullptr;
+    }
+}
+
+std::atomic<const Kernels*> g_kernels{nullptr};
+
+const Kernels& kernels() {
+    const Kernels* active = g_kernels.load(std::memory_order_acquire);
+    if (active == nullptr) {
+        // Racing first callers all pick the same table.
+        active = kernels_for(detect_simd_isa());
+        g_kernels.store(active, std::memory_order_release);
+    }
+    return *active;
+}
+
+} // namespace
+
+const char* simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::SCALAR: return "scalar";
+        case SimdIsa::SSE2: return "sse2";
+        case SimdIsa::AVX2: return "avx2";
+        case SimdIsa::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+bool simd_isa_supported(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::SCALAR: return true;
+        case SimdIsa::SSE2:
+#ifdef AA_BATCH_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case SimdIsa::AVX2:
+#ifdef AA_BATCH_AVX2
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+            return false;
+#endif
+        case SimdIsa::NEON:
+#ifdef AA_BATCH_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+SimdIsa detect_simd_isa() {
+    for (SimdIsa isa : {SimdIsa::AVX2, SimdIsa::NEON, SimdIsa::SSE2}) {
+        if (simd_isa_supported(isa)) return isa;
+    }
+    return SimdIsa::SCALAR;
+}
+
+SimdIsa get_batch_math_isa() {
+    return kernels().isa;
+}
+
+void set_batch_math_isa(SimdIsa isa) {
+    if (!simd_isa_supported(isa)) {
+        throw std::invalid_argument(std::string("batch math: ") + simd_isa_name(isa) + " is not supported here");
+    }
+    g_kernels.store(kernels_for(isa), std::memory_order_release);
+}
+
+// Batch kernels
+void batch_add(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, size_t count) {
+    kernels().add(out, a, b, count);
+}
+
+void batch_scale(Vec3SoA out, ConstVec3SoA a, float s, size_t count) {
+    kernels().scale(out, a, s, count);
+}
+
+void batch_multiply_add(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float s, size_t count) {
+    kernels().multiply_add(out, a, b, s, count);
+}
+
+void batch_normalize(Vec3SoA out, ConstVec3SoA a, size_t count) {
+    kernels().normalize(out, a, count);
+}
+
+void batch_lerp(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float t, size_t count) {
+    kernels().lerp(out, a, b, t, count);
+}
+
+void batch_clamp(Vec3SoA out, ConstVec3SoA a, const Bounds3& bounds, size_t count) {
+    kernels().clamp(out, a, bounds, count);
+}
+
+void batch_quat_rotate(Vec3SoA out, ConstQuatSoA q, ConstVec3SoA v, size_t count) {
+    kernels().quat_rotate(out, q, v, count);
+}
+
+void batch_transform_compose(TransformSoA out, ConstTransformSoA parent, ConstTransformSoA child, size_t count) {
+    kernels().transform_compose(out, parent, child, count);
+}
+
+void batch_add(float* out, const float* a, float s, size_t count) {
+    kernels().add_scalar(out, a, s, count);
+}
+
+void batch_multiply_add(float* out, const float* a, const float* b, float s, size_t count) {
+    kernels().multiply_add_scalar(out, a, b, s, count);
+}
+
+void batch_plane_distance(float* out, const Plane* planes, size_t plane_count, ConstVec3SoA center,
+                          ConstVec3SoA extent, size_t count) {
+    kernels().plane_distance(out, planes, plane_count, center, extent, count);
+}
+
+bool normalize3(float v[3]) {
+    const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (!(length > 1e-6f)) return false;
+    for (int axis = 0; axis < 3; ++axis) v[axis] /= length;
+    return true;
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,258 @@
+/**
+ * Anime Aggressors Performance Engine - Batch vector math kernels
+ *
+ * Included by batch_math.cpp once per instruction set, inside that set's
+ * namespace (and target pragma) with `Lane` naming its register wrapper.
+ * Each kernel runs the body of the stream on Lane and the remainder on
+ * ScalarLane, so every path produces the same layout of results.
+ */
+
+template<typename L>
+void add_lanes(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, size_t i, size_t end) {
+    for (; i < end; i += L::WIDTH) {
+        (L::load(a.x + i) + L::load(b.x + i)).store(out.x + i);
+        (L::load(a.y + i) + L::load(b.y + i)).store(out.y + i);
+        (L::load(a.z + i) + L::load(b.z + i)).store(out.z + i);
+    }
+}
+
+void add(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    add_lanes<Lane>(out, a, b, 0, body);
+    add_lanes<ScalarLane>(out, a, b, body, count);
+}
+
+template<typename L>
+void scale_lanes(Vec3SoA out, ConstVec3SoA a, float s, size_t i, size_t end) {
+    const L factor = L::set(s);
+    for (; i < end; i += L::WIDTH) {
+        (L::load(a.x + i) * factor).store(out.x + i);
+        (L::load(a.y + i) * factor).store(out.y + i);
+        (L::load(a.z + i) * factor).store(out.z + i);
+    }
+}
+
+void scale(Vec3SoA out, ConstVec3SoA a, float s, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    scale_lanes<Lane>(out, a, s, 0, body);
+    scale_lanes<ScalarLane>(out, a, s, body, count);
+}
+
+template<typename L>
+void multiply_add_lanes(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float s, size_t i, size_t end) {
+    const L factor = L::set(s);
+    for (; i < end; i += L::WIDTH) {
+        fmadd(L::load(b.x + i), factor, L::load(a.x + i)).store(out.x + i);
+        fmadd(L::load(b.y + i), factor, L::load(a.y + i)).store(out.y + i);
+        fmadd(L::load(b.z + i), factor, L::load(a.z + i)).store(out.z + i);
+    }
+}
+
+void multiply_add(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float s, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    multiply_add_lanes<Lane>(out, a, b, s, 0, body);
+    multiply_add_lanes<ScalarLane>(out, a, b, s, body, count);
+}
+
+template<typename L>
+void normalize_lanes(Vec3SoA out, ConstVec3SoA a, size_t i, size_t end) {
+    const L one = L::set(1.0f);
+    for (; i < end; i += L::WIDTH) {
+        const L x = L::load(a.x + i);
+        const L y = L::load(a.y + i);
+        const L z = L::load(a.z + i);
+        const L length_sq = fmadd(x, x, fmadd(y, y, z * z));
+        // A true divide keeps results within an ulp of Vector3D::normalized();
+        // zero-length inputs give 1/0 = inf, which keep_if_positive drops.
+        const L inverse = keep_if_positive(length_sq, one / square_root(length_sq));
+        (x * inverse).store(out.x + i);
+        (y * inverse).store(out.y + i);
+        (z * inverse).store(out.z + i);
+    }
+}
+
+void normalize(Vec3SoA out, ConstVec3SoA a, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    normalize_lanes<Lane>(out, a, 0, body);
+    normalize_lanes<ScalarLane>(out, a, body, count);
+}
+
+template<typename L>
+void lerp_lanes(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float t, size_t i, size_t end) {
+    const L weight = L::set(t);
+    for (; i < end; i += L::WIDTH) {
+        const L ax = L::load(a.x + i);
+        const L ay = L::load(a.y + i);
+        const L az = L::load(a.z + i);
+        fmadd(L::load(b.x + i) - ax, weight, ax).store(out.x + i);
+        fmadd(L::load(b.y + i) - ay, weight, ay).store(out.y + i);
+        fmadd(L::load(b.z + i) - az, weight, az).store(out.z + i);
+    }
+}
+
+void lerp(Vec3SoA out, ConstVec3SoA a, ConstVec3SoA b, float t, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    lerp_lanes<Lane>(out, a, b, t, 0, body);
+    lerp_lanes<ScalarLane>(out, a, b, t, body, count);
+}
+
+template<typename L>
+void clamp_lanes(Vec3SoA out, ConstVec3SoA a, const Bounds3& bounds, size_t i, size_t end) {
+    const L min_x = L::set(bounds.min[0]), max_x = L::set(bounds.max[0]);
+    const L min_y = L::set(bounds.min[1]), max_y = L::set(bounds.max[1]);
+    const L min_z = L::set(bounds.min[2]), max_z = L::set(bounds.max[2]);
+    for (; i < end; i += L::WIDTH) {
+        maximum(min_x, minimum(max_x, L::load(a.x + i))).store(out.x + i);
+        maximum(min_y, minimum(max_y, L::load(a.y + i))).store(out.y + i);
+        maximum(min_z, minimum(max_z, L::load(a.z + i))).store(out.z + i);
+    }
+}
+
+void clamp(Vec3SoA out, ConstVec3SoA a, const Bounds3& bounds, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    clamp_lanes<Lane>(out, a, bounds, 0, body);
+    clamp_lanes<ScalarLane>(out, a, bounds, body, count);
+}
+
+// v' = v + w * t + cross(q.xyz, t) with t = 2 * cross(q.xyz, v): two cross
+// products instead of two full quaternion products.
+template<typename L>
+void rotate(const L& qx, const L& qy, const L& qz, const L& qw, L& vx, L& vy, L& vz) {
+    const L two = L::set(2.0f);
+    const L tx = (qy * vz - qz * vy) * two;
+    const L ty = (qz * vx - qx * vz) * two;
+    const L tz = (qx * vy - qy * vx) * two;
+    vx = fmadd(qw, tx, vx) + (qy * tz - qz * ty);
+    vy = fmadd(qw, ty, vy) + (qz * tx - qx * tz);
+    vz = fmadd(qw, tz, vz) + (qx * ty - qy * tx);
+}
+
+template<typename L>
+void quat_rotate_lanes(Vec3SoA out, ConstQuatSoA q, ConstVec3SoA v, size_t i, size_t end) {
+    for (; i < end; i += L::WIDTH) {
+        L x = L::load(v.x + i);
+        L y = L::load(v.y + i);
+        L z = L::load(v.z + i);
+        rotate(L::load(q.x + i), L::load(q.y + i), L::load(q.z + i), L::load(q.w + i), x, y, z);
+        x.store(out.x + i);
+        y.store(out.y + i);
+        z.store(out.z + i);
+    }
+}
+
+void quat_rotate(Vec3SoA out, ConstQuatSoA q, ConstVec3SoA v, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    quat_rotate_lanes<Lane>(out, q, v, 0, body);
+    quat_rotate_lanes<ScalarLane>(out, q, v, body, count);
+}
+
+template<typename L>
+void transform_compose_lanes(TransformSoA out, ConstTransformSoA parent, ConstTransformSoA child, size_t i, size_t end) {
+    for (; i < end; i += L::WIDTH) {
+        const L pqx = L::load(parent.rotation.x + i);
+        const L pqy = L::load(parent.rotation.y + i);
+        const L pqz = L::load(parent.rotation.z + i);
+        const L pqw = L::load(parent.rotation.w + i);
+        const L cqx = L::load(child.rotation.x + i);
+        const L cqy = L::load(child.rotation.y + i);
+        const L cqz = L::load(child.rotation.z + i);
+        const L cqw = L::load(child.rotation.w + i);
+        const L psx = L::load(parent.scale.x + i);
+        const L psy = L::load(parent.scale.y + i);
+        const L psz = L::load(parent.scale.z + i);
+
+        // Everything is loaded before the first store, so `out` may be
+        // either input.
+        L px = psx * L::load(child.position.x + i);
+        L py = psy * L::load(child.position.y + i);
+        L pz = psz * L::load(child.position.z + i);
+        rotate(pqx, pqy, pqz, pqw, px, py, pz);
+        px = px + L::load(parent.position.x + i);
+        py = py + L::load(parent.position.y + i);
+        pz = pz + L::load(parent.position.z + i);
+        const L sx = psx * L::load(child.scale.x + i);
+        const L sy = psy * L::load(child.scale.y + i);
+        const L sz = psz * L::load(child.scale.z + i);
+
+        // Hamilton product parent * child.
+        const L rw = pqw * cqw - pqx * cqx - pqy * cqy - pqz * cqz;
+        const L rx = pqw * cqx + pqx * cqw + pqy * cqz - pqz * cqy;
+        const L ry = pqw * cqy - pqx * cqz + pqy * cqw + pqz * cqx;
+        const L rz = pqw * cqz + pqx * cqy - pqy * cqx + pqz * cqw;
+
+        px.store(out.position.x + i);
+        py.store(out.position.y + i);
+        pz.store(out.position.z + i);
+        sx.store(out.scale.x + i);
+        sy.store(out.scale.y + i);
+        sz.store(out.scale.z + i);
+        rx.store(out.rotation.x + i);
+        ry.store(out.rotation.y + i);
+        rz.store(out.rotation.z + i);
+        rw.store(out.rotation.w + i);
+    }
+}
+
+void transform_compose(TransformSoA out, ConstTransformSoA parent, ConstTransformSoA child, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    transform_compose_lanes<Lane>(out, parent, child, 0, body);
+    transform_compose_lanes<ScalarLane>(out, parent, child, body, count);
+}
+
+template<typename L>
+void add_scalar_lanes(float* out, const float* a, float s, size_t i, size_t end) {
+    const L addend = L::set(s);
+    for (; i < end; i += L::WIDTH) {
+        (L::load(a + i) + addend).store(out + i);
+    }
+}
+
+void add_scalar(float* out, const float* a, float s, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    add_scalar_lanes<Lane>(out, a, s, 0, body);
+    add_scalar_lanes<ScalarLane>(out, a, s, body, count);
+}
+
+template<typename L>
+void multiply_add_scalar_lanes(float* out, const float* a, const float* b, float s, size_t i, size_t end) {
+    const L factor = L::set(s);
+    for (; i < end; i += L::WIDTH) {
+        fmadd(L::load(b + i), factor, L::load(a + i)).store(out + i);
+    }
+}
+
+void multiply_add_scalar(float* out, const float* a, const float* b, float s, size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    multiply_add_scalar_lanes<Lane>(out, a, b, s, 0, body);
+    multiply_add_scalar_lanes<ScalarLane>(out, a, b, s, body, count);
+}
+
+template<typename L>
+void plane_distance_lanes(float* out, const Plane* planes, size_t plane_count, ConstVec3SoA center,
+                          ConstVec3SoA extent, size_t i, size_t end) {
+    for (; i < end; i += L::WIDTH) {
+        const L cx = L::load(center.x + i), cy = L::load(center.y + i), cz = L::load(center.z + i);
+        const L ex = L::load(extent.x + i), ey = L::load(extent.y + i), ez = L::load(extent.z + i);
+        L nearest = L::set(HUGE_VALF);
+        for (size_t p = 0; p < plane_count; ++p) {
+            const Plane& plane = planes[p];
+            // Center distance plus the box's reach toward the plane: the
+            // distance of the corner furthest along the normal.
+            L d = fmadd(cx, L::set(plane.normal[0]), L::set(plane.distance));
+            d = fmadd(cy, L::set(plane.normal[1]), d);
+            d = fmadd(cz, L::set(plane.normal[2]), d);
+            d = fmadd(ex, L::set(std::fabs(plane.normal[0])), d);
+            d = fmadd(ey, L::set(std::fabs(plane.normal[1])), d);
+            d = fmadd(ez, L::set(std::fabs(plane.normal[2])), d);
+            nearest = minimum(nearest, d);
+        }
+        nearest.store(out + i);
+    }
+}
+
+void plane_distance(float* out, const Plane* planes, size_t plane_count, ConstVec3SoA center, ConstVec3SoA extent,
+                    size_t count) {
+    const size_t body = count - count % Lane::WIDTH;
+    plane_distance_lanes<Lane>(out, planes, plane_count, center, extent, 0, body);
+    plane_distance_lanes<ScalarLane>(out, planes, plane_count, center, extent, body, count);
+}
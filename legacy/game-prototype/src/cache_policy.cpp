@@ -0,0 +1,467 @@
+/**
+ * Anime Aggressors Performance Engine - Cache eviction policies
+ */
+
+#include "cache_policy.h"
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+// Doubly linked lists threaded through per-node prev/next arrays. A node is
+// on at most one list at a time, so several lists can share the arrays.
+class NodeLists {
+public:
+    struct List {
+        uint32_t head = NIL;
+        uint32_t tail = NIL;
+        uint32_t size = 0;
+    };
+
+    explicit NodeLists(uint32_t capacity) : prev_(capacity, NIL), next_(capacity, NIL) {}
+
+    void push_front(List& list, uint32_t node) {
+        prev_[node] = NIL;
+        next_[node] = list.head;
+        if (list.head != NIL) prev_[list.head] = node; else list.tail = node;
+        list.head = node;
+        ++list.size;
+    }
+
+    void remove(List& list, uint32_t node) {
+        if (prev_[node] != NIL) next_[prev_[node]] = next_[node]; else list.head = next_[node];
+        if (next_[node] != NIL) prev_[next_[node]] = prev_[node]; else list.tail = prev_[node];
+        --list.size;
+    }
+
+    void move_to_front(List& list, uint32_t node) {
+        if (list.head == node) return;
+        remove(list, node);
+        push_front(list, node);
+    }
+
+    uint32_t pop_back(List& list) {
+        const uint32_t node = list.tail;
+        if (node != NIL) remove(list, node);
+        return node;
+    }
+
+private:
+    std::vector<uint32_t> prev_;
+    std::vector<uint32_t> next_;
+};
+
+// Evicted keys remembered by hash only, most recent first.
+class GhostList {
+public:
+    bool contains(uint64_t hash) const { return index_.count(hash) != 0; }
+    size_t size() const { return index_.size(); }
+
+    void push_front(uint64_t hash) {
+        order_.push_front(hash);
+        index_[hash] = order_.begin();
+    }
+
+    bool erase(uint64_t hash) {
+        auto it = index_.find(hash);
+        if (it == index_.end()) return false;
+        order_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    void pop_back() {
+        if (order_.empty()) return;
+        index_.erase(order_.back());
+        order_.pop_back();
+    }
+
+    void clear() {
+        order_.clear();
+        index_.clear();
+    }
+
+private:
+    std::list<uint64_t> order_;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> index_;
+};
+
+// Count-min sketch with four rows of 4-bit saturating counters, packed
+// sixteen to a word. Counters are halved every 10 * capacity increments so
+// popularity from an earlier level fades out.
+class FrequencySketch {
+public:
+    explicit FrequencySketch(uint32_t capacity) {
+        width_ = 16;
+        while (width_ < capacity) width_ <<= 1;
+        table_.assign(ROWS * width_ / 16, 0);
+        sample_size_ = std::max<uint32_t>(10 * capacity, 16);
+    }
+
+    void increment(uint64_t hash) {
+        bool added = false;
+        for (uint32_t row = 0; row < ROWS; ++row) {
+            uint64_t& word = table_[word_index(row, hash)];
+            const uint32_t shift = counter_shift(row, hash);
+            if (((word >> shift) & 0xF) < 0xF) {
+                word += uint64_t(1) << shift;
+                added = true;
+            }
+        }
+        if (added && ++additions_ >= sample_size_) {
+            for (uint64_t& word : table_) word = (word >> 1) & 0x7777777777777777ull;
+            additions_ /= 2;
+        }
+    }
+
+    uint32_t frequency(uint64_t hash) const {
+        uint32_t result = 0xF;
+        for (uint32_t row = 0; row < ROWS; ++row) {
+            const uint64_t word = table_[word_index(row, hash)];
+            result = std::min(result, static_cast<uint32_t>((word >> counter_shift(row, hash)) & 0xF));
+        }
+        return result;
+    }
+
+    void clear() {
+        std::fill(table_.begin(), table_.end(), 0);
+        additions_ = 0;
+    }
+
+private:
+    static constexpr uint32_t ROWS = 4;
+
+    std::vector<uint64_t> table_;
+    uint32_t width_;
+    uint32_t sample_size_;
+    uint32_t additions_ = 0;
+
+    uint32_t counter_index(uint32_t row, uint64_t hash) const {
+        static constexpr uint64_t SEEDS[ROWS] = {
+            0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull, 0x9ae16a3b2f90404full, 0xcbf29ce484222325ull,
+        };
+        uint64_t h = (hash ^ SEEDS[row]) * 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return static_cast<uint32_t>(h) & (width_ - 1);
+    }
+
+    size_t word_index(uint32_t row, uint64_t hash) const {
+        return (static_cast<size_t>(row) * width_ + counter_index(row, hash)) / 16;
+    }
+
+    uint32_t counter_shift(uint32_t row, uint64_t hash) const {
+        return (counter_index(row, hash) % 16) * 4;
+    }
+};
+
+class LruPolicy : public CachePolicy {
+public:
+    explicit LruPolicy(uint32_t capacity) : links_(capacity) {}
+
+    void on_hit(uint32_t node) override { links_.move_to_front(list_, node); }
+    void on_insert(uint32_t node, uint64_t) override { links_.push_front(list_, node); }
+    void on_remove(uint32_t node) override { links_.remove(list_, node); }
+    uint32_t select_victim(uint64_t) override { return links_.pop_back(list_); }
+    void clear() override { list_ = {}; }
+
+private:
+    NodeLists links_;
+    NodeLists::List list_;
+};
+
+// Second-chance clock over node slots: a hit sets the reference bit, the
+// hand clears set bits and evicts the first resident slot without one.
+class ClockPolicy : public CachePolicy {
+public:
+    explicit ClockPolicy(uint32_t capacity) : state_(capacity, ABSENT) {}
+
+    void on_hit(uint32_t node) override { state_[node] = REFERENCED; }
+    void on_insert(uint32_t node, uint64_t) override { state_[node] = RESIDENT; }
+    void on_remove(uint32_t node) override { state_[node] = ABSENT; }
+
+    uint32_t select_victim(uint64_t) override {
+        while (true) {
+            const uint32_t node = hand_;
+            hand_ = hand_ + 1 == state_.size() ? 0 : hand_ + 1;
+            if (state_[node] == REFERENCED) {
+                state_[node] = RESIDENT;
+            } else if (state_[node] == RESIDENT) {
+                state_[node] = ABSENT;
+                return node;
+            }
+        }
+    }
+
+    void clear() override {
+        std::fill(state_.begin(), state_.end(), ABSENT);
+        hand_ = 0;
+    }
+
+private:
+    enum : uint8_t { ABSENT, RESIDENT, REFERENCED };
+
+    std::vector<uint8_t> state_;
+    uint32_t hand_ = 0;
+};
+
+// W-TinyLFU (Einziger, Friedman & Manes). New keys enter a small LRU window;
+// when the window overflows, its oldest entry competes with the main
+// segment's eviction candidate and only the more frequent one (by the
+// sketch) stays. The main segment is a segmented LRU, so one-hit scans
+// churn the window and probation without displacing protected entries.
+class TinyLfuPolicy : public CachePolicy {
+public:
+    explicit TinyLfuPolicy(uint32_t capacity)
+        : links_(capacity), where_(capacity, NONE), hashes_(capacity, 0), sketch_(capacity) {
+        window_max_ = std::max<uint32_t>(1, capacity / 100);
+        const uint32_t main = capacity > window_max_ ? capacity - window_max_ : 0;
+        protected_max_ = main * 8 / 10;
+    }
+
+    void on_access(uint64_t hash) override { sketch_.increment(hash); }
+
+    void on_hit(uint32_t node) override {
+        switch (where_[node]) {
+        case WINDOW:
+            links_.move_to_front(window_, node);
+            break;
+        case PROBATION:
+            links_.remove(probation_, node);
+            links_.push_front(protected_, node);
+            where_[node] = PROTECTED;
+            if (protected_.size > protected_max_) {
+                const uint32_t demoted = links_.pop_back(protected_);
+                links_.push_front(probation_, demoted);
+                where_[demoted] = PROBATION;
+            }
+            break;
+        case PROTECTED:
+            links_.move_to_front(protected_, node);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void on_insert(uint32_t node, uint64_t hash) override {
+        hashes_[node] = hash;
+        links_.push_front(window_, node);
+        where_[node] = WINDOW;
+        // Only overflows while the shard still has room; once full,
+        // select_victim() has already made space in the window.
+        if (window_.size > window_max_) {
+            const uint32_t overflow = links_.pop_back(window_);
+            links_.push_front(probation_, overflow);
+            where_[overflow] = PROBATION;
+        }
+    }
+
+    void on_remove(uint32_t node) override { unlink(node); }
+
+    uint32_t select_victim(uint64_t) override {
+        const uint32_t main_victim = probation_.tail != NIL ? probation_.tail : protected_.tail;
+        uint32_t victim;
+        if (window_.size < window_max_ || main_victim == NIL) {
+            victim = main_victim != NIL ? main_victim : window_.tail;
+        } else {
+            const uint32_t candidate = window_.tail;
+            if (sketch_.frequency(hashes_[candidate]) > sketch_.frequency(hashes_[main_victim])) {
+                links_.remove(window_, candidate);
+                links_.push_front(probation_, candidate);
+                where_[candidate] = PROBATION;
+                victim = main_victim;
+            } else {
+                victim = candidate;
+            }
+        }
+        unlink(victim);
+        return victim;
+    }
+
+    void clear() override {
+        window_ = probation_ = protected_ = {};
+        std::fill(where_.begin(), where_.end(), NONE);
+        sketch_.clear();
+    }
+
+private:
+    enum : uint8_t { NONE, WINDOW, PROBATION, PROTECTED };
+
+    NodeLists links_;
+    NodeLists::List window_;
+    NodeLists::List probation_;
+    NodeLists::List protected_;
+    std::vector<uint8_t> where_;
+    std::vector<uint64_t> hashes_;
+    FrequencySketch sketch_;
+    uint32_t window_max_;
+    uint32_t protected_max_;
+
+    void unlink(uint32_t node) {
+        switch (where_[node]) {
+        case WINDOW: links_.remove(window_, node); break;
+        case PROBATION: links_.remove(probation_, node); break;
+        case PROTECTED: links_.remove(protected_, node); break;
+        default: break;
+        }
+        where_[node] = NONE;
+    }
+};
+
+// Adaptive Replacement Cache (Megiddo & Modha). T1 holds keys seen once,
+// T2 keys seen at least twice; ghost lists B1/B2 remember recent evictions
+// from each and steer the target T1 size p toward whichever list is
+// producing ghost hits.
+class ArcPolicy : public CachePolicy {
+public:
+    explicit ArcPolicy(uint32_t capacity)
+        : links_(capacity), where_(capacity, NONE), hashes_(capacity, 0), capacity_(capacity) {}
+
+    void on_hit(uint32_t node) override {
+        if (where_[node] == T1) {
+            links_.remove(t1_, node);
+            links_.push_front(t2_, node);
+            where_[node] = T2;
+        } else {
+            links_.move_to_front(t2_, node);
+        }
+    }
+
+    void on_insert(uint32_t node, uint64_t hash) override {
+        const uint8_t target = pending_ && pending_hash_ == hash ? pending_target_ : adapt(hash);
+        pending_ = false;
+        hashes_[node] = hash;
+        links_.push_front(target == T1 ? t1_ : t2_, node);
+        where_[node] = target;
+
+        // Keep the directory bounded when inserts arrive without evictions
+        // (after explicit removes).
+        while (t1_.size + b1_.size() > capacity_ && b1_.size() > 0) b1_.pop_back();
+        while (directory_size() > 2 * static_cast<size_t>(capacity_) && b2_.size() > 0) b2_.pop_back();
+    }
+
+    void on_remove(uint32_t node) override {
+        links_.remove(where_[node] == T1 ? t1_ : t2_, node);
+        where_[node] = NONE;
+    }
+
+    uint32_t select_victim(uint64_t incoming_hash) override {
+        // A byte-budget put() may ask for several victims for one key; the
+        // ghost hit is only consumed (and p adapted) on the first request.
+        const bool repeat = pending_ && pending_hash_ == incoming_hash;
+        const bool ghost_b2 = repeat ? pending_from_b2_ : b2_.contains(incoming_hash);
+        if (!repeat) {
+            pending_target_ = adapt(incoming_hash);
+            pending_hash_ = incoming_hash;
+            pending_from_b2_ = ghost_b2;
+            pending_ = true;
+        }
+
+        if (pending_target_ == T1) {
+            if (t1_.size + b1_.size() >= capacity_) {
+                if (t1_.size < capacity_) {
+                    b1_.pop_back();
+                } else {
+                    // T1 alone fills the cache: drop its LRU outright.
+                    const uint32_t victim = links_.pop_back(t1_);
+                    where_[victim] = NONE;
+                    return victim;
+                }
+            } else if (directory_size() >= 2 * static_cast<size_t>(capacity_)) {
+                b2_.pop_back();
+            }
+        }
+        return replace(ghost_b2);
+    }
+
+    void clear() override {
+        t1_ = t2_ = {};
+        std::fill(where_.begin(), where_.end(), NONE);
+        b1_.clear();
+        b2_.clear();
+        p_ = 0;
+        pending_ = false;
+    }
+
+private:
+    enum : uint8_t { NONE, T1, T2 };
+
+    NodeLists links_;
+    NodeLists::List t1_;
+    NodeLists::List t2_;
+    GhostList b1_;
+    GhostList b2_;
+    std::vector<uint8_t> where_;
+    std::vector<uint64_t> hashes_;
+    uint32_t capacity_;
+    uint32_t p_ = 0;
+
+    // select_victim() already consumed the ghost entry for the key that
+    // on_insert() is about to receive.
+    bool pending_ = false;
+    uint64_t pending_hash_ = 0;
+    uint8_t pending_target_ = T1;
+    bool pending_from_b2_ = false;
+
+    size_t directory_size() const { return t1_.size + t2_.size + b1_.size() + b2_.size(); }
+
+    uint8_t adapt(uint64_t hash) {
+        if (b1_.contains(hash)) {
+            const uint32_t delta = std::max<uint32_t>(1, static_cast<uint32_t>(b2_.size() / b1_.size()));
+            p_ = std::min(capacity_, p_ + delta);
+            b1_.erase(hash);
+            return T2;
+        }
+        if (b2_.contains(hash)) {
+            const uint32_t delta = std::max<uint32_t>(1, static_cast<uint32_t>(b1_.size() / b2_.size()));
+            p_ = p_ > delta ? p_ - delta : 0;
+            b2_.erase(hash);
+            return T2;
+        }
+        return T1;
+    }
+
+    uint32_t replace(bool ghost_b2) {
+        uint32_t victim;
+        if (t1_.size > 0 && (t1_.size > p_ || (ghost_b2 && t1_.size == p_) || t2_.size == 0)) {
+            victim = links_.pop_back(t1_);
+            b1_.push_front(hashes_[victim]);
+        } else {
+            victim = links_.pop_back(t2_);
+            b2_.push_front(hashes_[victim]);
+        }
+        where_[victim] = NONE;
+        return victim;
+    }
+};
+
+} // namespace
+
+const char* cache_policy_name(CachePolicyType type) {
+    switch (type) {
+    case CachePolicyType::LRU: return "lru";
+    case CachePolicyType::CLOCK: return "clock";
+    case CachePolicyType::TINY_LFU: return "w-tinylfu";
+    case CachePolicyType::ARC: return "arc";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<CachePolicy> make_cache_policy(CachePolicyType type, uint32_t capacity) {
+    switch (type) {
+    case CachePolicyType::CLOCK: return std::make_unique<ClockPolicy>(capacity);
+    case CachePolicyType::TINY_LFU: return std::make_unique<TinyLfuPolicy>(capacity);
+    case CachePolicyType::ARC: return std::make_unique<ArcPolicy>(capacity);
+    case CachePolicyType::LRU: break;
+    }
+    return std::make_unique<LruPolicy>(capacity);
+}
+
+} // namespace AnimeAggressors
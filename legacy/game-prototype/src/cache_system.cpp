@@ -0,0 +1,319 @@
+/**
+ * Anime Aggressors Performance Engine - Sharded key/value cache
+ */
+
+#include "cache_system.h"
+#include "cache_trace.h"
+#include "disk_cache.h"
+#include "thread_slots.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace AnimeAggressors {
+
+namespace {
+
+size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+} // namespace
+
+// CacheSystem::Shard Implementation
+size_t CacheSystem::Shard::find_slot(std::string_view key, uint32_t hash) const {
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.node == NIL) return NIL;
+        if (slot.hash == hash && nodes[slot.node].key == key) return i;
+    }
+}
+
+void CacheSystem::Shard::insert_slot(uint32_t node, uint32_t hash) {
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].node != NIL) i = (i + 1) & mask;
+    slots[i] = {node, hash};
+}
+
+void CacheSystem::Shard::erase_slot(size_t hole) {
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole so lookups never need tombstones.
+    const size_t mask = slots.size() - 1;
+    size_t next = hole;
+    while (true) {
+        next = (next + 1) & mask;
+        if (slots[next].node == NIL) break;
+        const size_t home = slots[next].hash & mask;
+        const bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole].node = NIL;
+}
+
+uint32_t CacheSystem::Shard::acquire_node() {
+    if (free_head != NIL) {
+        const uint32_t index = free_head;
+        free_head = nodes[index].next_free;
+        return index;
+    }
+    nodes.emplace_back();
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void CacheSystem::Shard::release_node(uint32_t index) {
+    nodes[index].next_free = free_head;
+    free_head = index;
+}
+
+// CacheSystem Implementation
+CacheSystem::CacheSystem(size_t max_size, size_t shard_count, CachePolicyType policy, size_t max_bytes)
+    : max_bytes_(max_bytes), policy_(policy) {
+    max_size = std::max<size_t>(1, max_size);
+    // Keep at least one entry per shard, and a power of two so the shard is
+    // picked from the top hash bits with a shift.
+    shard_count = round_up_pow2(std::max<size_t>(1, std::min(shard_count, max_size)));
+    while (shard_count > max_size) shard_count >>= 1;
+
+    shard_count_ = shard_count;
+    shard_shift_ = 64;
+    for (size_t n = shard_count; n > 1; n >>= 1) --shard_shift_;
+    shards_ = std::make_unique<Shard[]>(shard_count);
+
+    const size_t per_shard = (max_size + shard_count - 1) / shard_count;
+    capacity_ = per_shard * shard_count;
+    for (size_t i = 0; i < shard_count; ++i) {
+        Shard& shard = shards_[i];
+        shard.capacity = static_cast<uint32_t>(per_shard);
+        shard.nodes.reserve(per_shard);
+        shard.policy = make_cache_policy(policy, static_cast<uint32_t>(per_shard));
+        // At most 50% load keeps probe runs short.
+        shard.slots.assign(round_up_pow2(per_shard * 2), Slot{NIL, 0});
+    }
+}
+
+CacheSystem::~CacheSystem() = default;
+
+uint64_t CacheSystem::hash_key(std::string_view key) {
+    // Fibonacci mix so the top bits (shard) and low bits (slot) are both
+    // well distributed.
+    return static_cast<uint64_t>(std::hash<std::string_view>{}(key)) * 0x9E3779B97F4A7C15ull;
+}
+
+CacheSystem::Shard& CacheSystem::shard_for(uint64_t hash) const {
+    return shards_[shard_shift_ == 64 ? 0 : static_cast<size_t>(hash >> shard_shift_)];
+}
+
+void CacheSystem::drop_entry(Shard& shard, size_t slot) {
+    const uint32_t index = shard.slots[slot].node;
+    Node& node = shard.nodes[index];
+    const size_t entry_bytes = node.key.size() + node.value.size();
+    shard.erase_slot(slot);
+    shard.bytes -= entry_bytes;
+    bytes_.fetch_sub(entry_bytes, std::memory_order_relaxed);
+    shard.release_node(index);
+    --shard.count;
+}
+
+void CacheSystem::evict_one(Shard& shard, uint64_t incoming_hash) {
+    const Node& victim = shard.nodes[shard.policy->select_victim(incoming_hash)];
+    drop_entry(shard, shard.find_slot(victim.key, static_cast<uint32_t>(victim.hash)));
+}
+
+void CacheSystem::trim_to_budget() {
+    // Another put() may be trimming too; both stop once the total fits.
+    size_t empty_shards = 0;
+    while (bytes_.load(std::memory_order_relaxed) > max_bytes_ && empty_shards < shard_count_) {
+        Shard& shard = shards_[trim_cursor_.fetch_add(1, std::memory_order_relaxed) & (shard_count_ - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.count == 0) {
+            ++empty_shards;
+            continue;
+        }
+        empty_shards = 0;
+        evict_one(shard, 0);
+    }
+}
+
+bool CacheSystem::get(std::string_view key, std::string& value) {
+    if (CacheTrace* trace = trace_.load(std::memory_order_relaxed)) trace->record(CacheOp::GET, key);
+
+    const uint64_t hash = hash_key(key);
+    Shard& shard = shard_for(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        shard.policy->on_access(hash);
+        const size_t slot = shard.find_slot(key, static_cast<uint32_t>(hash));
+        if (slot != NIL) {
+            const uint32_t index = shard.slots[slot].node;
+            shard.policy->on_hit(index);
+            value = shard.nodes[index].value;
+            owner_add<uint64_t>(shard.hits, 1);
+            return true;
+        }
+        owner_add<uint64_t>(shard.misses, 1);
+
+        // Memory miss: promote from the disk tier if it has the key. The
+        // shard stays locked so a concurrent put() of the key can't land
+        // between the disk read and the promotion.
+        DiskCache* tier = disk_tier_.load(std::memory_order_acquire);
+        if (tier == nullptr || !tier->get(key, value)) {
+            return false;
+        }
+        store_locked(shard, hash, key, value);
+    }
+
+    if (bytes_.load(std::memory_order_relaxed) > max_bytes_) {
+        trim_to_budget();
+    }
+    return true;
+}
+
+void CacheSystem::put(std::string_view key, std::string_view value) {
+    if (CacheTrace* trace = trace_.load(std::memory_order_relaxed)) trace->record(CacheOp::PUT, key, value.size());
+
+    const uint64_t hash = hash_key(key);
+    Shard& shard = shard_for(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // Disk first, then memory, under one lock, so concurrent puts of a
+        // key leave both tiers holding the same value.
+        if (DiskCache* tier = disk_tier_.load(std::memory_order_acquire)) tier->put(key, value);
+        store_locked(shard, hash, key, value);
+    }
+
+    if (bytes_.load(std::memory_order_relaxed) > max_bytes_) {
+        trim_to_budget();
+    }
+}
+
+void CacheSystem::store_locked(Shard& shard, uint64_t hash, std::string_view key, std::string_view value) {
+    const uint32_t short_hash = static_cast<uint32_t>(hash);
+    const size_t entry_bytes = key.size() + value.size();
+    shard.policy->on_access(hash);
+
+    const size_t slot = shard.find_slot(key, short_hash);
+    if (entry_bytes > max_bytes_) {
+        // Can never fit; drop any older copy rather than serve stale data.
+        if (slot != NIL) {
+            shard.policy->on_remove(shard.slots[slot].node);
+            drop_entry(shard, slot);
+        }
+        return;
+    }
+
+    if (slot != NIL) {
+        const uint32_t index = shard.slots[slot].node;
+        std::string& stored = shard.nodes[index].value;
+        shard.bytes = shard.bytes - stored.size() + value.size();
+        bytes_.fetch_add(value.size() - stored.size(), std::memory_order_relaxed);  // wraps for shrink
+        stored.assign(value.data(), value.size());
+        shard.policy->on_hit(index);
+    } else {
+        while (shard.count > 0 && (shard.count >= shard.capacity ||
+                                   bytes_.load(std::memory_order_relaxed) + entry_bytes > max_bytes_)) {
+            evict_one(shard, hash);
+        }
+
+        // Freed nodes are reused LIFO, so this is usually the victim's
+        // node with its string capacity intact.
+        const uint32_t index = shard.acquire_node();
+        ++shard.count;
+        Node& node = shard.nodes[index];
+        node.key.assign(key.data(), key.size());
+        node.value.assign(value.data(), value.size());
+        node.hash = hash;
+        shard.bytes += entry_bytes;
+        bytes_.fetch_add(entry_bytes, std::memory_order_relaxed);
+        shard.insert_slot(index, short_hash);
+        shard.policy->on_insert(index, hash);
+    }
+}
+
+void CacheSystem::remove(std::string_view key) {
+    if (CacheTrace* trace = trace_.load(std::memory_order_relaxed)) trace->record(CacheOp::REMOVE, key);
+
+    const uint64_t hash = hash_key(key);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const size_t slot = shard.find_slot(key, static_cast<uint32_t>(hash));
+    if (slot == NIL) {
+        return;
+    }
+
+    shard.policy->on_remove(shard.slots[slot].node);
+    drop_entry(shard, slot);
+}
+
+void CacheSystem::clear() {
+    for (size_t i = 0; i < shard_count_; ++i) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.nodes.clear();
+        std::fill(shard.slots.begin(), shard.slots.end(), Slot{NIL, 0});
+        shard.policy->clear();
+        bytes_.fetch_sub(shard.bytes, std::memory_order_relaxed);
+        shard.bytes = 0;
+        shard.count = 0;
+        shard.free_head = NIL;
+    }
+}
+
+size_t CacheSystem::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total += shards_[i].count;
+    }
+    return total;
+}
+
+double CacheSystem::get_hit_rate() const {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        hits += shards_[i].hits.load(std::memory_order_relaxed);
+        misses += shards_[i].misses.load(std::memory_order_relaxed);
+    }
+    const uint64_t total = hits + misses;
+    if (total == 0) return 0.0;
+    return static_cast<double>(hits) / total;
+}
+
+size_t CacheSystem::get_shard_count() const {
+    return shard_count_;
+}
+
+size_t CacheSystem::get_capacity() const {
+    return capacity_;
+}
+
+size_t CacheSystem::get_bytes() const {
+    return bytes_.load(std::memory_order_relaxed);
+}
+
+size_t CacheSystem::get_byte_budget() const {
+    return max_bytes_;
+}
+
+CachePolicyType CacheSystem::get_policy() const {
+    return policy_;
+}
+
+void CacheSystem::set_trace(CacheTrace* trace) {
+    trace_.store(trace, std::memory_order_relaxed);
+}
+
+void CacheSystem::set_disk_tier(DiskCache* tier) {
+    disk_tier_.store(tier, std::memory_order_release);
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,138 @@
+/**
+ * Anime Aggressors Performance Engine - Cache trace recording and replay
+ */
+
+#include "cache_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace AnimeAggressors {
+
+// CacheTrace Implementation
+uint32_t CacheTrace::intern(std::string_view key) {
+    auto it = key_ids_.find(std::string(key));
+    if (it != key_ids_.end()) {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(keys_.size());
+    keys_.emplace_back(key);
+    key_ids_.emplace(keys_.back(), id);
+    return id;
+}
+
+void CacheTrace::record(CacheOp op, std::string_view key, size_t value_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back({op, intern(key), static_cast<uint32_t>(value_size)});
+}
+
+void CacheTrace::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    keys_.clear();
+    key_ids_.clear();
+}
+
+size_t CacheTrace::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.size();
+}
+
+const std::vector<CacheTrace::Event>& CacheTrace::events() const {
+    return events_;
+}
+
+const std::vector<std::string>& CacheTrace::keys() const {
+    return keys_;
+}
+
+bool CacheTrace::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    for (const Event& event : events_) {
+        switch (event.op) {
+        case CacheOp::GET: out << "G "; break;
+        case CacheOp::PUT: out << "P " << event.value_size << ' '; break;
+        case CacheOp::REMOVE: out << "R "; break;
+        }
+        out << keys_[event.key] << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool CacheTrace::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+
+    clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.size() < 3 || line[1] != ' ') {
+            return false;
+        }
+        std::string_view rest(line);
+        rest.remove_prefix(2);
+
+        Event event{CacheOp::GET, 0, 0};
+        if (line[0] == 'P') {
+            const size_t space = rest.find(' ');
+            if (space == std::string_view::npos) {
+                return false;
+            }
+            event.op = CacheOp::PUT;
+            event.value_size = static_cast<uint32_t>(std::stoul(std::string(rest.substr(0, space))));
+            rest.remove_prefix(space + 1);
+        } else if (line[0] == 'R') {
+            event.op = CacheOp::REMOVE;
+        } else if (line[0] != 'G') {
+            return false;
+        }
+        event.key = intern(rest);
+        events_.push_back(event);
+    }
+    return true;
+}
+
+CacheReplayResult replay_cache_trace(const CacheTrace& trace, CachePolicyType policy, size_t capacity,
+                                     size_t shard_count) {
+    const auto& events = trace.events();
+    const auto& keys = trace.keys();
+
+    uint32_t largest = 0;
+    for (const auto& event : events) largest = std::max(largest, event.value_size);
+    const std::string payload(largest, 'v');
+
+    CacheSystem cache(capacity, shard_count, policy);
+    std::string value;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& event : events) {
+        const std::string& key = keys[event.key];
+        switch (event.op) {
+        case CacheOp::GET:
+            cache.get(key, value);
+            break;
+        case CacheOp::PUT:
+            cache.put(key, std::string_view(payload.data(), event.value_size));
+            break;
+        case CacheOp::REMOVE:
+            cache.remove(key);
+            break;
+        }
+    }
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    CacheReplayResult result;
+    result.policy = policy;
+    result.operations = events.size();
+    result.hit_rate = cache.get_hit_rate();
+    result.ns_per_op = events.empty() ? 0.0 : elapsed_ns / static_cast<double>(events.size());
+    return result;
+}
+
+} // namespace AnimeAggressors
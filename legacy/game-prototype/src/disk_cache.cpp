@@ -0,0 +1,525 @@
+/**
+ * Anime Aggressors Performance Engine - Persistent disk cache tier
+ */
+
+#include "disk_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint32_t DATA_MAGIC = 0x43444141;    // "AADC"
+constexpr uint32_t INDEX_MAGIC = 0x49444141;   // "AADI"
+constexpr uint32_t RECORD_MAGIC = 0x52444141;  // "AADR"
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr uint32_t INDEX_VERSION = 2;
+
+enum : uint32_t {
+    RECORD_BLOB = 1,
+    RECORD_KEY = 2,
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_id;      // new on every rewrite; 0 in logs from before ids
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint64_t content_hash;
+    uint64_t payload_size;
+};
+
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t data_size;    // log length the index covers
+    uint32_t blob_count;
+    uint32_t key_count;
+    uint32_t use_clock;
+    uint32_t reserved;
+    uint64_t file_id;      // of the log the index was written for
+};
+
+struct IndexBlob {
+    uint64_t content_hash;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct IndexKey {
+    uint64_t key_hash;
+    uint64_t content_hash;
+    uint64_t key_offset;
+    uint32_t key_size;
+    uint32_t last_used;
+};
+
+// Records start 8-byte aligned so headers can be read in place.
+uint64_t padded(uint64_t size) {
+    return (size + 7) & ~uint64_t(7);
+}
+
+uint64_t record_bytes(uint64_t payload_size) {
+    return sizeof(RecordHeader) + padded(payload_size);
+}
+
+// Log size automatic compaction shrinks to.
+uint64_t compaction_target(size_t max_bytes) {
+    return max_bytes / 100 * DISK_CACHE_COMPACT_PERCENT;
+}
+
+[[noreturn]] void throw_io_error(const std::string& what, const std::string& path) {
+    throw std::runtime_error("DiskCache: " + what + " " + path + ": " + std::strerror(errno));
+}
+
+void write_all(int fd, const void* data, size_t size, uint64_t offset, const std::string& path) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw_io_error("write failed on", path);
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+}
+
+// Random, so an index left over from the log a compaction replaced never
+// matches the new one.
+uint64_t new_file_id() {
+    std::random_device device;
+    uint64_t id = (uint64_t(device()) << 32) ^ device() ^
+                  static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return id != 0 ? id : 1;
+}
+
+// Appends one record at `end` and returns the offset of its payload.
+uint64_t write_record(int fd, uint64_t& end, uint32_t type, uint64_t content_hash, std::string_view payload,
+                      const std::string& path) {
+    static const char zeros[8] = {};
+    const RecordHeader header{RECORD_MAGIC, type, content_hash, payload.size()};
+    const uint64_t payload_offset = end + sizeof(RecordHeader);
+    write_all(fd, &header, sizeof(header), end, path);
+    write_all(fd, payload.data(), payload.size(), payload_offset, path);
+    write_all(fd, zeros, padded(payload.size()) - payload.size(), payload_offset + payload.size(), path);
+    end = payload_offset + padded(payload.size());
+    return payload_offset;
+}
+
+} // namespace
+
+// DiskCache Implementation
+DiskCache::DiskCache(const std::string& directory, size_t max_bytes)
+    : directory_(directory), max_bytes_(max_bytes), fd_(-1), file_size_(0), file_id_(0), mapping_{nullptr, 0},
+      use_clock_(0), hits_(0), misses_(0), blobs_written_(0), blobs_deduplicated_(0), values_rejected_(0) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        throw std::runtime_error("DiskCache: cannot create " + directory_ + ": " + error.message());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        open_data_file();
+        if (!load_index()) {
+            blobs_.clear();
+            keys_.clear();
+            scan_log(sizeof(FileHeader));
+        }
+        if (file_size_ > max_bytes_) {
+            compact_locked(compaction_target(max_bytes_));
+        }
+    } catch (...) {
+        // The destructor won't run for a half-built cache.
+        close_data_file();
+        throw;
+    }
+}
+
+DiskCache::~DiskCache() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        write_index();
+    } catch (const std::exception&) {
+        // The log is still intact; the next open rescans it.
+    }
+    close_data_file();
+}
+
+uint64_t DiskCache::hash_bytes(std::string_view bytes) {
+    // FNV-1a over 64-bit words, then the remaining tail bytes.
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+    uint64_t hash = FNV_OFFSET ^ bytes.size();
+    size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    for (; i < bytes.size(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * FNV_PRIME;
+    }
+    return hash ^ (hash >> 29);
+}
+
+std::string DiskCache::data_path() const {
+    return directory_ + "/cache.dat";
+}
+
+std::string DiskCache::index_path() const {
+    return directory_ + "/cache.idx";
+}
+
+void DiskCache::open_data_file() {
+    const std::string path = data_path();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw_io_error("cannot open", path);
+    }
+
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        throw_io_error("cannot stat", path);
+    }
+    file_size_ = static_cast<uint64_t>(info.st_size);
+
+    FileHeader header{};
+    if (file_size_ < sizeof(header)) {
+        header = {DATA_MAGIC, FORMAT_VERSION, new_file_id()};
+        if (::ftruncate(fd_, 0) != 0) {
+            throw_io_error("cannot truncate", path);
+        }
+        write_all(fd_, &header, sizeof(header), 0, path);
+        file_size_ = sizeof(header);
+        file_id_ = header.file_id;
+        return;
+    }
+
+    std::memcpy(&header, map_range(0, sizeof(header)), sizeof(header));
+    if (header.magic != DATA_MAGIC || header.version != FORMAT_VERSION) {
+        throw std::runtime_error("DiskCache: " + path + " is not a cache log of this version");
+    }
+    file_id_ = header.file_id;
+}
+
+void DiskCache::close_data_file() {
+    if (mapping_.address != nullptr) {
+        ::munmap(mapping_.address, mapping_.length);
+        mapping_ = {nullptr, 0};
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+const char* DiskCache::map_range(uint64_t offset, uint64_t size) const {
+    if (offset + size > mapping_.length) {
+        // Replace the mapping with one at least twice as long, so a growing
+        // log is remapped a logarithmic number of times. Pages past the end
+        // of the file become readable as appends reach them. Every caller
+        // holds the lock and is done with the old pointer by its next call.
+        const size_t length = std::max<size_t>(file_size_, mapping_.length * 2);
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, 0);
+        if (address == MAP_FAILED) {
+            throw_io_error("cannot map", data_path());
+        }
+        if (mapping_.address != nullptr) {
+            ::munmap(mapping_.address, mapping_.length);
+        }
+        mapping_ = {address, length};
+    }
+    return static_cast<const char*>(mapping_.address) + offset;
+}
+
+bool DiskCache::load_index() {
+    std::ifstream in(index_path(), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    IndexHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != INDEX_MAGIC ||
+        header.version != INDEX_VERSION || header.file_id != file_id_ || header.data_size > file_size_ ||
+        header.data_size < sizeof(FileHeader)) {
+        return false;
+    }
+
+    std::vector<IndexBlob> blobs(header.blob_count);
+    std::vector<IndexKey> keys(header.key_count);
+    if (!in.read(reinterpret_cast<char*>(blobs.data()), static_cast<std::streamsize>(blobs.size() * sizeof(IndexBlob))) ||
+        !in.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(IndexKey)))) {
+        return false;
+    }
+
+    // Every entry must land on a record header of its kind carrying the same
+    // hash and size, so a stale or damaged index is rejected rather than
+    // serving some other record's bytes.
+    const auto record_matches = [&](uint64_t payload_offset, uint64_t size, uint32_t type, uint64_t content_hash) {
+        if (payload_offset < sizeof(FileHeader) + sizeof(RecordHeader) || payload_offset % 8 != 0 ||
+            size > header.data_size - payload_offset) {
+            return false;
+        }
+        RecordHeader record;
+        std::memcpy(&record, map_range(payload_offset - sizeof(RecordHeader), sizeof(record)), sizeof(record));
+        return record.magic == RECORD_MAGIC && record.type == type && record.content_hash == content_hash &&
+               record.payload_size == size;
+    };
+
+    blobs_.reserve(blobs.size());
+    for (const IndexBlob& blob : blobs) {
+        if (!record_matches(blob.offset, blob.size, RECORD_BLOB, blob.content_hash)) return false;
+        blobs_[blob.content_hash] = {blob.offset, blob.size};
+    }
+    keys_.reserve(keys.size());
+    for (const IndexKey& key : keys) {
+        if (!record_matches(key.key_offset, key.key_size, RECORD_KEY, key.content_hash) ||
+            blobs_.count(key.content_hash) == 0) {
+            return false;
+        }
+        keys_[key.key_hash] = {key.content_hash, key.key_offset, key.key_size, key.last_used};
+    }
+    use_clock_ = header.use_clock;
+
+    if (header.data_size < file_size_) {
+        scan_log(header.data_size);
+    }
+    return true;
+}
+
+void DiskCache::scan_log(uint64_t offset) {
+    while (offset + sizeof(RecordHeader) <= file_size_) {
+        RecordHeader header;
+        std::memcpy(&header, map_range(offset, sizeof(header)), sizeof(header));
+        const uint64_t payload_offset = offset + sizeof(RecordHeader);
+        if (header.magic != RECORD_MAGIC || header.payload_size > file_size_ - payload_offset ||
+            padded(header.payload_size) > file_size_ - payload_offset) {
+            break;
+        }
+
+        const std::string_view payload(map_range(payload_offset, header.payload_size), header.payload_size);
+        if (header.type == RECORD_BLOB) {
+            if (hash_bytes(payload) != header.content_hash) break;
+            blobs_[header.content_hash] = {payload_offset, header.payload_size};
+        } else if (header.type == RECORD_KEY) {
+            if (blobs_.count(header.content_hash) == 0) break;
+            keys_[hash_bytes(payload)] = {header.content_hash, payload_offset,
+                                          static_cast<uint32_t>(header.payload_size), ++use_clock_};
+        } else {
+            break;
+        }
+        offset = payload_offset + padded(header.payload_size);
+    }
+
+    if (offset < file_size_) {
+        // Torn or corrupt tail from an interrupted write: cut it off so new
+        // records append after the last good one.
+        if (::ftruncate(fd_, static_cast<off_t>(offset)) != 0) {
+            throw_io_error("cannot truncate", data_path());
+        }
+        file_size_ = offset;
+    }
+}
+
+void DiskCache::write_index() {
+    std::vector<IndexBlob> blobs;
+    blobs.reserve(blobs_.size());
+    for (const auto& [hash, blob] : blobs_) blobs.push_back({hash, blob.offset, blob.size});
+    std::sort(blobs.begin(), blobs.end(),
+              [](const IndexBlob& a, const IndexBlob& b) { return a.content_hash < b.content_hash; });
+
+    std::vector<IndexKey> keys;
+    keys.reserve(keys_.size());
+    for (const auto& [hash, key] : keys_) {
+        keys.push_back({hash, key.content_hash, key.key_offset, key.key_size, key.last_used});
+    }
+    std::sort(keys.begin(), keys.end(), [](const IndexKey& a, const IndexKey& b) { return a.key_hash < b.key_hash; });
+
+    const IndexHeader header{INDEX_MAGIC, INDEX_VERSION, file_size_, static_cast<uint32_t>(blobs.size()),
+                             static_cast<uint32_t>(keys.size()), use_clock_, 0, file_id_};
+
+    // Write beside the live index and rename over it, so a crash leaves
+    // either the old or the new index, never half of one.
+    const std::string temp_path = index_path() + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(blobs.data()), static_cast<std::streamsize>(blobs.size() * sizeof(IndexBlob)));
+        out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(IndexKey)));
+        if (!out) {
+            throw_io_error("cannot write", temp_path);
+        }
+    }
+    if (std::rename(temp_path.c_str(), index_path().c_str()) != 0) {
+        throw_io_error("cannot replace", index_path());
+    }
+}
+
+uint64_t DiskCache::append_record(uint32_t type, uint64_t content_hash, std::string_view payload) {
+    return write_record(fd_, file_size_, type, content_hash, payload, data_path());
+}
+
+bool DiskCache::key_matches(const KeyEntry& entry, std::string_view key) const {
+    return entry.key_size == key.size() && std::memcmp(map_range(entry.key_offset, entry.key_size), key.data(), key.size()) == 0;
+}
+
+bool DiskCache::get(std::string_view key, std::string& value) {
+    return read(key, [&value](std::string_view stored) { value.assign(stored.data(), stored.size()); });
+}
+
+bool DiskCache::find_locked(std::string_view key, std::string_view& value) {
+    auto it = keys_.find(hash_bytes(key));
+    if (it == keys_.end() || !key_matches(it->second, key)) {
+        ++misses_;
+        return false;
+    }
+
+    const BlobEntry& blob = blobs_.at(it->second.content_hash);
+    value = std::string_view(map_range(blob.offset, blob.size), blob.size);
+    it->second.last_used = ++use_clock_;
+    ++hits_;
+    return true;
+}
+
+void DiskCache::put(std::string_view key, std::string_view value) {
+    const uint64_t key_hash = hash_bytes(key);
+    const uint64_t content_hash = hash_bytes(value);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = keys_.find(key_hash);
+    if (sizeof(FileHeader) + record_bytes(key.size()) + record_bytes(value.size()) > compaction_target(max_bytes_)) {
+        // Compaction could never keep it, so writing it would only force a
+        // rewrite of the whole log. Drop any older copy rather than serve
+        // stale data, and persist that so a restart doesn't bring it back.
+        ++values_rejected_;
+        if (it != keys_.end() && key_matches(it->second, key)) {
+            keys_.erase(it);
+            write_index();
+        }
+        return;
+    }
+    if (it != keys_.end() && it->second.content_hash == content_hash && key_matches(it->second, key)) {
+        it->second.last_used = ++use_clock_;
+        return;
+    }
+
+    if (blobs_.count(content_hash) != 0) {
+        ++blobs_deduplicated_;
+    } else {
+        const uint64_t offset = append_record(RECORD_BLOB, content_hash, value);
+        blobs_[content_hash] = {offset, value.size()};
+        ++blobs_written_;
+    }
+    const uint64_t key_offset = append_record(RECORD_KEY, content_hash, key);
+    keys_[key_hash] = {content_hash, key_offset, static_cast<uint32_t>(key.size()), ++use_clock_};
+
+    if (file_size_ > max_bytes_) {
+        compact_locked(compaction_target(max_bytes_));
+    }
+}
+
+bool DiskCache::contains(std::string_view key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = keys_.find(hash_bytes(key));
+    return it != keys_.end() && key_matches(it->second, key);
+}
+
+void DiskCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_index();
+}
+
+void DiskCache::compact() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compact_locked(max_bytes_);
+}
+
+void DiskCache::compact_locked(uint64_t budget) {
+    std::vector<std::pair<uint64_t, KeyEntry>> by_recency(keys_.begin(), keys_.end());
+    std::sort(by_recency.begin(), by_recency.end(),
+              [](const auto& a, const auto& b) { return a.second.last_used > b.second.last_used; });
+
+    const std::string temp_path = data_path() + ".tmp";
+    const int out = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        throw_io_error("cannot open", temp_path);
+    }
+
+    std::unordered_map<uint64_t, BlobEntry> new_blobs;
+    std::unordered_map<uint64_t, KeyEntry> new_keys;
+    uint64_t end = sizeof(FileHeader);
+    try {
+        // A new id, so a crash before write_index() below leaves the old
+        // index unusable instead of pointing into the new log.
+        uint64_t file_id = new_file_id();
+        while (file_id == file_id_) file_id = new_file_id();
+        const FileHeader header{DATA_MAGIC, FORMAT_VERSION, file_id};
+        write_all(out, &header, sizeof(header), 0, temp_path);
+
+        // Most recently used first; a key that doesn't fit is skipped so
+        // smaller, older ones can still use the remaining budget.
+        for (const auto& [key_hash, key] : by_recency) {
+            const BlobEntry& blob = blobs_.at(key.content_hash);
+            const bool blob_kept = new_blobs.count(key.content_hash) != 0;
+            const uint64_t cost = record_bytes(key.key_size) + (blob_kept ? 0 : record_bytes(blob.size));
+            if (end + cost > budget) continue;
+
+            if (!blob_kept) {
+                const std::string_view bytes(map_range(blob.offset, blob.size), blob.size);
+                new_blobs[key.content_hash] = {write_record(out, end, RECORD_BLOB, key.content_hash, bytes, temp_path),
+                                               blob.size};
+            }
+            const std::string_view key_bytes(map_range(key.key_offset, key.key_size), key.key_size);
+            const uint64_t key_offset = write_record(out, end, RECORD_KEY, key.content_hash, key_bytes, temp_path);
+            new_keys[key_hash] = {key.content_hash, key_offset, key.key_size, key.last_used};
+        }
+    } catch (...) {
+        ::close(out);
+        std::remove(temp_path.c_str());
+        throw;
+    }
+    ::close(out);
+
+    close_data_file();
+    if (std::rename(temp_path.c_str(), data_path().c_str()) != 0) {
+        throw_io_error("cannot replace", data_path());
+    }
+    open_data_file();
+    blobs_ = std::move(new_blobs);
+    keys_ = std::move(new_keys);
+    write_index();
+}
+
+size_t DiskCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return keys_.size();
+}
+
+DiskCache::Stats DiskCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_, misses_, blobs_written_, blobs_deduplicated_, values_rejected_, file_size_};
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,165 @@
+/**
+ * Anime Aggressors Performance Engine - Archetype entity component system
+ */
+
+#include "ecs.h"
+#include "slab_allocator.h"
+
+#include <algorithm>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr size_t COLUMN_ALIGNMENT = 64;
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+// EcsArchetype Implementation
+EcsArchetype::EcsArchetype(ComponentMask mask, const std::array<const ComponentInfo*, MAX_COMPONENTS>& infos,
+                           SlabAllocator* allocator)
+    : mask_(mask), infos_{}, offsets_{}, chunk_capacity_(0), chunk_bytes_(ECS_CHUNK_BYTES), size_(0),
+      allocator_(allocator), add_edges_{}, remove_edges_{} {
+    size_t row_bytes = sizeof(SlotHandle);
+    for (ComponentId id = 0; id < MAX_COMPONENTS; ++id) {
+        if (!has(id)) continue;
+        components_.push_back(id);
+        infos_[id] = infos[id];
+        row_bytes += infos[id]->size;
+    }
+
+    // Entity handles first, then one aligned column per component in id
+    // order. Shrink the row count until the padded layout fits a chunk; a
+    // row too big for one chunk gets a chunk of its own.
+    auto layout_bytes = [&](uint32_t capacity) {
+        size_t offset = align_up(sizeof(SlotHandle) * capacity, COLUMN_ALIGNMENT);
+        for (ComponentId id : components_) {
+            offset = align_up(offset, std::max(COLUMN_ALIGNMENT, infos_[id]->alignment));
+            offsets_[id] = static_cast<uint32_t>(offset);
+            offset += infos_[id]->size * capacity;
+        }
+        return offset;
+    };
+
+    uint32_t capacity = static_cast<uint32_t>(std::max<size_t>(1, ECS_CHUNK_BYTES / row_bytes));
+    while (capacity > 1 && layout_bytes(capacity) > ECS_CHUNK_BYTES) --capacity;
+    chunk_capacity_ = capacity;
+    // A multiple of the alignment, which the slab allocator then honours
+    chunk_bytes_ = align_up(std::max(ECS_CHUNK_BYTES, layout_bytes(capacity)), COLUMN_ALIGNMENT);
+}
+
+EcsArchetype::~EcsArchetype() {
+    for (uint32_t row = 0; row < size_; ++row) {
+        for (ComponentId id : components_) infos_[id]->destroy(component(row, id));
+    }
+    for (unsigned char* chunk : chunks_) free_chunk(chunk);
+}
+
+unsigned char* EcsArchetype::allocate_chunk() {
+    if (allocator_) return static_cast<unsigned char*>(allocator_->allocate(chunk_bytes_));
+    return static_cast<unsigned char*>(::operator new(chunk_bytes_, std::align_val_t(COLUMN_ALIGNMENT)));
+}
+
+void EcsArchetype::free_chunk(unsigned char* chunk) {
+    if (allocator_) {
+        allocator_->deallocate(chunk, chunk_bytes_);
+    } else {
+        ::operator delete(chunk, std::align_val_t(COLUMN_ALIGNMENT));
+    }
+}
+
+uint32_t EcsArchetype::push_row(SlotHandle entity) {
+    const uint32_t row = size_;
+    const size_t chunk = row / chunk_capacity_;
+    if (chunk == chunks_.size()) chunks_.push_back(allocate_chunk());
+    reinterpret_cast<SlotHandle*>(chunks_[chunk])[row % chunk_capacity_] = entity;
+    ++size_;
+    return row;
+}
+
+SlotHandle EcsArchetype::erase_row(uint32_t row) {
+    for (ComponentId id : components_) infos_[id]->destroy(component(row, id));
+
+    const uint32_t last = size_ - 1;
+    SlotHandle moved = NULL_SLOT_HANDLE;
+    if (row != last) {
+        for (ComponentId id : components_) {
+            void* source = component(last, id);
+            infos_[id]->move_construct(component(row, id), source);
+            infos_[id]->destroy(source);
+        }
+        moved = reinterpret_cast<SlotHandle*>(chunks_[last / chunk_capacity_])[last % chunk_capacity_];
+        reinterpret_cast<SlotHandle*>(chunks_[row / chunk_capacity_])[row % chunk_capacity_] = moved;
+    }
+    --size_;
+    // Keep one spare chunk so churn around a boundary does not allocate
+    if (chunks_.size() > get_chunk_count() + 1) {
+        free_chunk(chunks_.back());
+        chunks_.pop_back();
+    }
+    return moved;
+}
+
+// EcsWorld Implementation
+EcsWorld::EcsWorld() : EcsWorld(0) {}
+
+EcsWorld::EcsWorld(size_t capacity, SlabAllocator* allocator) : infos_{}, allocator_(allocator) {
+    records_.reserve(capacity);
+    archetype_for(0);
+}
+
+EcsWorld::~EcsWorld() = default;
+
+EcsArchetype* EcsWorld::archetype_for(ComponentMask mask) {
+    auto it = archetype_index_.find(mask);
+    if (it != archetype_index_.end()) return it->second;
+
+    archetypes_.push_back(std::make_unique<EcsArchetype>(mask, infos_, allocator_));
+    EcsArchetype* archetype = archetypes_.back().get();
+    archetype_index_.emplace(mask, archetype);
+    return archetype;
+}
+
+const std::vector<EcsArchetype*>& EcsWorld::query(ComponentMask mask) {
+    QueryCache& cache = queries_[mask];
+    for (; cache.scanned < archetypes_.size(); ++cache.scanned) {
+        EcsArchetype* archetype = archetypes_[cache.scanned].get();
+        if ((archetype->get_mask() & mask) == mask) cache.archetypes.push_back(archetype);
+    }
+    return cache.archetypes;
+}
+
+bool EcsWorld::destroy(SlotHandle entity) {
+    const EntityRecord* record = records_.get(entity);
+    if (record == nullptr) return false;
+
+    const SlotHandle moved = record->archetype->erase_row(record->row);
+    if (moved != NULL_SLOT_HANDLE) records_.get(moved)->row = record->row;
+    records_.erase(entity);
+    return true;
+}
+
+void EcsWorld::move_entity(SlotHandle entity, EntityRecord& record, EcsArchetype* target) {
+    EcsArchetype* source = record.archetype;
+    const uint32_t old_row = record.row;
+    const uint32_t new_row = target->push_row(entity);
+
+    // Carry over shared components; erase_row() then destroys the moved-from
+    // objects along with any component the target lacks.
+    for (ComponentId id : source->components_) {
+        if (target->has(id)) {
+            source->infos_[id]->move_construct(target->component(new_row, id), source->component(old_row, id));
+        }
+    }
+    const SlotHandle moved = source->erase_row(old_row);
+    if (moved != NULL_SLOT_HANDLE) records_.get(moved)->row = old_row;
+
+    record.archetype = target;
+    record.row = new_row;
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,74 @@
+/**
+ * Anime Aggressors Performance Engine - Fixed timestep
+ */
+
+#include "fixed_timestep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint64_t UNITS_PER_STEP = 1'000'000'000;
+// Caps a single delta so nanoseconds * MAX_STEP_HZ stays well inside 64 bits.
+constexpr double MAX_FRAME_SECONDS = 1'000'000.0;
+
+} // namespace
+
+// FixedTimestep Implementation
+FixedTimestep::FixedTimestep() : FixedTimestep(Config()) {}
+
+FixedTimestep::FixedTimestep(const Config& config) : accumulator_(0), tick_(0), dropped_steps_(0) {
+    configure(config);
+}
+
+void FixedTimestep::configure(const Config& config) {
+    if (config.step_hz == 0 || config.step_hz > MAX_STEP_HZ) {
+        throw std::invalid_argument("FixedTimestep step_hz must be in 1.." + std::to_string(MAX_STEP_HZ));
+    }
+    if (config.max_substeps == 0) {
+        throw std::invalid_argument("FixedTimestep max_substeps must be positive");
+    }
+    config_ = config;
+    if (config_.deterministic) config_.step_hz = SIM_HZ;
+    accumulator_ = 0;
+}
+
+void FixedTimestep::reset() {
+    accumulator_ = 0;
+    tick_ = 0;
+    dropped_steps_ = 0;
+}
+
+uint32_t FixedTimestep::advance(double frame_seconds) {
+    if (config_.deterministic) {
+        ++tick_;
+        return 1;
+    }
+    if (!(frame_seconds > 0.0)) return 0;
+
+    const auto nanos = static_cast<uint64_t>(std::llround(std::min(frame_seconds, MAX_FRAME_SECONDS) * 1e9));
+    accumulator_ += nanos * config_.step_hz;
+    uint64_t steps = accumulator_ / UNITS_PER_STEP;
+    accumulator_ %= UNITS_PER_STEP;
+    if (steps > config_.max_substeps) {
+        dropped_steps_ += steps - config_.max_substeps;
+        steps = config_.max_substeps;
+    }
+    tick_ += steps;
+    return static_cast<uint32_t>(steps);
+}
+
+float FixedTimestep::get_step_seconds() const {
+    return 1.0f / static_cast<float>(config_.step_hz);
+}
+
+float FixedTimestep::get_alpha() const {
+    return static_cast<float>(static_cast<double>(accumulator_) / UNITS_PER_STEP);
+}
+
+} // namespace AnimeAggressors
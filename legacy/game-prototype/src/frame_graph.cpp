@@ -0,0 +1,208 @@
+/**
+ * Anime Aggressors Performance Engine - Frame job graph
+ */
+
+#include "frame_graph.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+double ms_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+constexpr FrameGraph::StageId NO_STAGE = ~FrameGraph::StageId(0);
+
+} // namespace
+
+// FrameGraph Implementation
+FrameGraph::FrameGraph() : compiled_(false), frame_counter_(0) {}
+
+FrameGraph::~FrameGraph() = default;
+
+FrameGraph::StageId FrameGraph::add_stage(const std::string& name, uint32_t reads, uint32_t writes, StageFn fn) {
+    if (compiled_) {
+        throw std::logic_error("FrameGraph stages must be added before the first execute()");
+    }
+    auto stage = std::make_unique<Stage>();
+    stage->name = name;
+    stage->reads = reads;
+    stage->writes = writes;
+    stage->fn = std::move(fn);
+    stages_.push_back(std::move(stage));
+    return static_cast<StageId>(stages_.size() - 1);
+}
+
+void FrameGraph::compile() {
+    roots_.clear();
+    for (StageId id = 0; id < stages_.size(); ++id) {
+        Stage& stage = *stages_[id];
+        for (StageId earlier = 0; earlier < id; ++earlier) {
+            const Stage& other = *stages_[earlier];
+            const bool conflict = (stage.writes & (other.reads | other.writes)) != 0 ||
+                                  (stage.reads & other.writes) != 0;
+            if (conflict) {
+                stage.dependencies.push_back(earlier);
+            }
+        }
+
+        // Drop edges already implied through another dependency, so the
+        // critical path walks real hand-offs rather than transitive ones.
+        std::vector<StageId> direct;
+        for (StageId dep : stage.dependencies) {
+            bool implied = false;
+            for (StageId other : stage.dependencies) {
+                if (other == dep) continue;
+                const auto& via = stages_[other]->dependencies;
+                if (std::find(via.begin(), via.end(), dep) != via.end()) {
+                    implied = true;
+                    break;
+                }
+            }
+            if (!implied) direct.push_back(dep);
+        }
+        stage.dependencies = std::move(direct);
+
+        for (StageId dep : stage.dependencies) {
+            stages_[dep]->dependents.push_back(id);
+        }
+        if (stage.dependencies.empty()) {
+            roots_.push_back(id);
+        }
+    }
+    compiled_ = true;
+}
+
+void FrameGraph::run_stage(StageId id, float delta_time, ThreadPool* pool, TaskGroup* group) {
+    Stage& stage = *stages_[id];
+    stage.worker = pool != nullptr ? pool->current_worker_index() : -1;
+    stage.start = std::chrono::steady_clock::now();
+    stage.fn(delta_time);
+    stage.end = std::chrono::steady_clock::now();
+
+    if (pool == nullptr) return;
+
+    for (StageId next : stage.dependents) {
+        if (stages_[next]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pool->submit(*group, [this, next, delta_time, pool, group] {
+                run_stage(next, delta_time, pool, group);
+            });
+        }
+    }
+}
+
+void FrameGraph::execute(float delta_time, ThreadPool* pool) {
+    if (!compiled_) compile();
+
+    const auto frame_start = std::chrono::steady_clock::now();
+    if (pool == nullptr || stages_.size() < 2) {
+        for (StageId id = 0; id < stages_.size(); ++id) {
+            run_stage(id, delta_time, nullptr, nullptr);
+        }
+    } else {
+        for (auto& stage : stages_) {
+            stage->remaining.store(static_cast<uint32_t>(stage->dependencies.size()), std::memory_order_relaxed);
+        }
+        TaskGroup group;
+        for (StageId root : roots_) {
+            pool->submit(group, [this, root, delta_time, pool, &group] {
+                run_stage(root, delta_time, pool, &group);
+            });
+        }
+        pool->wait(group);
+    }
+    build_report(frame_start, std::chrono::steady_clock::now());
+}
+
+void FrameGraph::build_report(std::chrono::steady_clock::time_point frame_start,
+                              std::chrono::steady_clock::time_point frame_end) {
+    report_.frame = ++frame_counter_;
+    report_.frame_ms = ms_between(frame_start, frame_end);
+    report_.critical_path.clear();
+    report_.stages.resize(stages_.size());
+
+    // Longest chain of measured stage durations through the dependency
+    // edges: the lower bound on frame time however many workers there are.
+    // Dependencies always precede their dependents, so one forward pass works.
+    std::vector<double> path_end(stages_.size(), 0.0);
+    std::vector<StageId> via(stages_.size(), NO_STAGE);
+    StageId cursor = 0;
+    for (StageId id = 0; id < stages_.size(); ++id) {
+        const Stage& stage = *stages_[id];
+        double ready = 0.0;
+        for (StageId dep : stage.dependencies) {
+            if (path_end[dep] > ready) {
+                ready = path_end[dep];
+                via[id] = dep;
+            }
+        }
+        path_end[id] = ready + ms_between(stage.start, stage.end);
+        if (path_end[id] > path_end[cursor]) cursor = id;
+    }
+    const double path_ms = stages_.empty() ? 0.0 : path_end[cursor];
+    for (StageId id = stages_.empty() ? NO_STAGE : cursor; id != NO_STAGE; id = via[id]) {
+        report_.critical_path.push_back(id);
+    }
+    std::reverse(report_.critical_path.begin(), report_.critical_path.end());
+    report_.critical_path_ms = path_ms;
+
+    for (StageId id = 0; id < stages_.size(); ++id) {
+        const Stage& stage = *stages_[id];
+        StageTiming& timing = report_.stages[id];
+        timing.name = stage.name;
+        timing.start_ms = ms_between(frame_start, stage.start);
+        timing.end_ms = ms_between(frame_start, stage.end);
+        timing.worker = stage.worker;
+        timing.on_critical_path = std::find(report_.critical_path.begin(), report_.critical_path.end(), id) !=
+                                  report_.critical_path.end();
+    }
+}
+
+const FrameGraph::FrameReport& FrameGraph::last_report() const {
+    return report_;
+}
+
+std::string FrameGraph::dump_critical_path() const {
+    std::string out;
+    char line[160];
+
+    std::snprintf(line, sizeof(line), "frame %llu: %.3f ms, critical path %.3f ms\n",
+                  static_cast<unsigned long long>(report_.frame), report_.frame_ms, report_.critical_path_ms);
+    out += line;
+
+    for (size_t i = 0; i < report_.critical_path.size(); ++i) {
+        const StageTiming& timing = report_.stages[report_.critical_path[i]];
+        std::snprintf(line, sizeof(line), "%s%s (%.3f)", i == 0 ? "  " : " -> ", timing.name.c_str(),
+                      timing.end_ms - timing.start_ms);
+        out += line;
+    }
+    out += "\n";
+
+    for (const StageTiming& timing : report_.stages) {
+        std::snprintf(line, sizeof(line), "  %c %-12s start %8.3f  end %8.3f  dur %8.3f  worker %d\n",
+                      timing.on_critical_path ? '*' : ' ', timing.name.c_str(), timing.start_ms, timing.end_ms,
+                      timing.end_ms - timing.start_ms, timing.worker);
+        out += line;
+    }
+    return out;
+}
+
+size_t FrameGraph::get_stage_count() const {
+    return stages_.size();
+}
+
+const std::string& FrameGraph::get_stage_name(StageId stage) const {
+    return stages_.at(stage)->name;
+}
+
+const std::vector<FrameGraph::StageId>& FrameGraph::get_dependencies(StageId stage) const {
+    return stages_.at(stage)->dependencies;
+}
+
+} // namespace AnimeAggressors
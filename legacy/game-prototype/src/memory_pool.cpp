@@ -0,0 +1,109 @@
+/**
+ * Anime Aggressors Performance Engine - Fixed-size block pools
+ */
+
+#include "memory_pool.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+// MemoryPool Implementation
+MemoryPool::MemoryPool(size_t block_size, size_t block_count, size_t alignment)
+    : block_size_(block_size), block_count_(block_count), alignment_(alignment),
+      memory_(nullptr), head_(pack(NIL, 0)), available_(block_count) {
+    if (alignment_ == 0 || (alignment_ & (alignment_ - 1)) != 0) {
+        throw std::invalid_argument("MemoryPool alignment must be a power of two");
+    }
+    if (block_count_ >= NIL) {
+        throw std::invalid_argument("MemoryPool block_count exceeds 32-bit index range");
+    }
+
+    // Every block must hold the intrusive next index and start on an
+    // aligned boundary, so round the stride up to a multiple of alignment.
+    if (block_size_ < sizeof(uint32_t)) block_size_ = sizeof(uint32_t);
+    block_size_ = (block_size_ + alignment_ - 1) & ~(alignment_ - 1);
+
+    if (block_count_ == 0) return;
+    memory_ = static_cast<char*>(::operator new(block_size_ * block_count_, std::align_val_t(alignment_)));
+
+    // Thread the free list through the blocks in address order.
+    for (size_t i = 0; i < block_count_; ++i) {
+        const uint32_t next = i + 1 < block_count_ ? static_cast<uint32_t>(i + 1) : NIL;
+        std::memcpy(block_at(static_cast<uint32_t>(i)), &next, sizeof(next));
+    }
+    head_.store(pack(0, 0), std::memory_order_relaxed);
+}
+
+MemoryPool::~MemoryPool() {
+    if (memory_ != nullptr) {
+        ::operator delete(memory_, std::align_val_t(alignment_));
+    }
+}
+
+void* MemoryPool::allocate() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    while (true) {
+        const uint32_t index = static_cast<uint32_t>(head);
+        if (index == NIL) {
+            return nullptr;
+        }
+
+        // The block may be popped and overwritten by another thread between
+        // the load above and this read; the arena stays mapped, and the tag
+        // makes the CAS below fail in that case, so the stale value is never
+        // used.
+        uint32_t next;
+        std::memcpy(&next, block_at(index), sizeof(next));
+
+        const uint64_t desired = pack(next, static_cast<uint32_t>(head >> 32) + 1);
+        if (head_.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                        std::memory_order_acquire)) {
+            available_.fetch_sub(1, std::memory_order_relaxed);
+            return block_at(index);
+        }
+    }
+}
+
+void MemoryPool::deallocate(void* ptr) {
+    if (ptr == nullptr) return;
+
+    const uint32_t index = index_of(ptr);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    while (true) {
+        const uint32_t next = static_cast<uint32_t>(head);
+        std::memcpy(ptr, &next, sizeof(next));
+
+        const uint64_t desired = pack(index, static_cast<uint32_t>(head >> 32) + 1);
+        if (head_.compare_exchange_weak(head, desired, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+            available_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+size_t MemoryPool::get_available_blocks() const {
+    return available_.load(std::memory_order_relaxed);
+}
+
+size_t MemoryPool::get_total_blocks() const {
+    return block_count_;
+}
+
+size_t MemoryPool::get_block_size() const {
+    return block_size_;
+}
+
+size_t MemoryPool::get_alignment() const {
+    return alignment_;
+}
+
+bool MemoryPool::owns(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    return memory_ != nullptr && p >= memory_ && p < memory_ + block_size_ * block_count_ &&
+           static_cast<size_t>(p - memory_) % block_size_ == 0;
+}
+
+} // namespace AnimeAggressors
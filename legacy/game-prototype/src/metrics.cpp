@@ -0,0 +1,266 @@
+/**
+ * Anime Aggressors Performance Engine - Lock-free metrics registry
+ */
+
+#include "metrics.h"
+#include "thread_slots.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint32_t SUB_BUCKET_BITS = 7;                       // 128 linear buckets
+constexpr uint64_t SUB_BUCKET_COUNT = uint64_t{1} << SUB_BUCKET_BITS;
+constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+
+// A later thread inherits an exited thread's ThreadSlots slot and with it
+// the shard, whose totals stay valid because every shard only ever
+// accumulates.
+using ShardSlots = ThreadSlots<MetricsRegistry, MAX_METRIC_THREADS>;
+
+uint32_t highest_bit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+    uint32_t bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+// Shard updates are owner-only except on the shared overflow shard, which
+// needs real read-modify-writes.
+void bump_counter(std::atomic<uint64_t>& counter, uint64_t delta, bool shared) {
+    if (shared) {
+        counter.fetch_add(delta, std::memory_order_relaxed);
+    } else {
+        owner_add(counter, delta);
+    }
+}
+
+void raise_max(std::atomic<uint64_t>& max, uint64_t value, bool shared) {
+    uint64_t current = max.load(std::memory_order_relaxed);
+    if (value <= current) return;
+    if (!shared) {
+        max.store(value, std::memory_order_relaxed);
+        return;
+    }
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+// HistogramSnapshot Implementation
+size_t HistogramSnapshot::bucket_of(uint64_t value) {
+    value = std::min(value, MAX_VALUE);
+    if (value < SUB_BUCKET_COUNT) return static_cast<size_t>(value);
+    // Keep the top SUB_BUCKET_BITS bits: the shift picks the power-of-two
+    // range and value >> shift (in [64, 128)) the linear step within it.
+    const uint32_t shift = highest_bit(value) - (SUB_BUCKET_BITS - 1);
+    return static_cast<size_t>(shift * SUB_BUCKET_HALF + (value >> shift));
+}
+
+uint64_t HistogramSnapshot::bucket_upper(size_t bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return bucket;
+    const uint64_t shift = bucket / SUB_BUCKET_HALF - 1;
+    const uint64_t mantissa = bucket - shift * SUB_BUCKET_HALF;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t HistogramSnapshot::value_at_percentile(double percentile) const {
+    // Walk the buckets rather than trusting count: shards are read without a
+    // lock, so the two can disagree by a record or two.
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) total += bucket;
+    if (total == 0) return 0;
+
+    percentile = std::max(0.0, std::min(100.0, percentile));
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) return std::min(bucket_upper(i), max);
+    }
+    return max;
+}
+
+double HistogramSnapshot::mean() const {
+    if (count == 0) return 0.0;
+    return static_cast<double>(sum) / count;
+}
+
+// MetricsRegistry Implementation
+struct alignas(64) MetricsRegistry::HistogramShard {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+    std::atomic<uint64_t> buckets[HistogramSnapshot::BUCKET_COUNT];
+
+    HistogramShard() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    }
+};
+
+struct MetricsRegistry::ThreadShard {
+    std::unique_ptr<std::atomic<uint64_t>[]> counters;
+    std::unique_ptr<std::atomic<HistogramShard*>[]> histograms;
+    size_t histogram_count;
+
+    ThreadShard(size_t max_counters, size_t max_histograms)
+        : counters(new std::atomic<uint64_t>[max_counters]),
+          histograms(new std::atomic<HistogramShard*>[max_histograms]),
+          histogram_count(max_histograms) {
+        for (size_t i = 0; i < max_counters; ++i) counters[i].store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < max_histograms; ++i) histograms[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~ThreadShard() {
+        for (size_t i = 0; i < histogram_count; ++i) {
+            delete histograms[i].load(std::memory_order_acquire);
+        }
+    }
+};
+
+MetricsRegistry::MetricsRegistry(size_t max_counters, size_t max_gauges, size_t max_histograms)
+    : max_counters_(max_counters), max_gauges_(max_gauges), max_histograms_(max_histograms),
+      shared_shard_(std::make_unique<ThreadShard>(max_counters, max_histograms)),
+      gauges_(new std::atomic<double>[max_gauges]),
+      counter_count_(0), gauge_count_(0), histogram_count_(0) {
+    for (auto& shard : shards_) shard.store(nullptr, std::memory_order_relaxed);
+    for (size_t i = 0; i < max_gauges; ++i) gauges_[i].store(0.0, std::memory_order_relaxed);
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    for (auto& shard : shards_) {
+        delete shard.load(std::memory_order_acquire);
+    }
+}
+
+MetricId MetricsRegistry::register_series(const std::string& name, Kind kind, size_t& count, size_t limit) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (const Series& series : series_) {
+        if (series.name != name) continue;
+        if (series.kind != kind) {
+            throw std::runtime_error("Metric '" + name + "' is already registered as another kind");
+        }
+        return series.id;
+    }
+    if (count >= limit) {
+        throw std::runtime_error("Metrics registry is full, cannot register '" + name + "'");
+    }
+    const MetricId id = static_cast<MetricId>(count++);
+    series_.push_back(Series{name, kind, id});
+    return id;
+}
+
+MetricId MetricsRegistry::register_counter(const std::string& name) {
+    return register_series(name, Kind::COUNTER, counter_count_, max_counters_);
+}
+
+MetricId MetricsRegistry::register_gauge(const std::string& name) {
+    return register_series(name, Kind::GAUGE, gauge_count_, max_gauges_);
+}
+
+MetricId MetricsRegistry::register_histogram(const std::string& name) {
+    return register_series(name, Kind::HISTOGRAM, histogram_count_, max_histograms_);
+}
+
+MetricsRegistry::ThreadShard* MetricsRegistry::local_shard() {
+    const int slot = ShardSlots::current();
+    if (slot < 0) return shared_shard_.get();
+
+    // Only the thread holding this slot installs its shard; acquire/release
+    // publishes it to readers.
+    std::atomic<ThreadShard*>& entry = shards_[static_cast<size_t>(slot)];
+    ThreadShard* shard = entry.load(std::memory_order_acquire);
+    if (shard == nullptr) {
+        shard = new ThreadShard(max_counters_, max_histograms_);
+        entry.store(shard, std::memory_order_release);
+    }
+    return shard;
+}
+
+MetricsRegistry::HistogramShard* MetricsRegistry::histogram_shard(ThreadShard& shard, MetricId histogram) {
+    std::atomic<HistogramShard*>& entry = shard.histograms[histogram];
+    HistogramShard* buckets = entry.load(std::memory_order_acquire);
+    if (buckets != nullptr) return buckets;
+
+    // The shared shard can race here, so install with a CAS.
+    auto fresh = std::make_unique<HistogramShard>();
+    if (entry.compare_exchange_strong(buckets, fresh.get(), std::memory_order_acq_rel)) {
+        return fresh.release();
+    }
+    return buckets;
+}
+
+void MetricsRegistry::add(MetricId counter, uint64_t delta) {
+    ThreadShard* shard = local_shard();
+    bump_counter(shard->counters[counter], delta, shard == shared_shard_.get());
+}
+
+void MetricsRegistry::set(MetricId gauge, double value) {
+    gauges_[gauge].store(value, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::record(MetricId histogram, uint64_t value_us) {
+    ThreadShard* shard = local_shard();
+    const bool shared = shard == shared_shard_.get();
+    HistogramShard* buckets = histogram_shard(*shard, histogram);
+
+    bump_counter(buckets->buckets[HistogramSnapshot::bucket_of(value_us)], 1, shared);
+    bump_counter(buckets->count, 1, shared);
+    bump_counter(buckets->sum, value_us, shared);
+    raise_max(buckets->max, value_us, shared);
+}
+
+void MetricsRegistry::record_seconds(MetricId histogram, double seconds) {
+    record(histogram, seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e6 + 0.5) : 0);
+}
+
+uint64_t MetricsRegistry::get_counter(MetricId counter) const {
+    uint64_t total = shared_shard_->counters[counter].load(std::memory_order_relaxed);
+    for (const auto& entry : shards_) {
+        const ThreadShard* shard = entry.load(std::memory_order_acquire);
+        if (shard != nullptr) total += shard->counters[counter].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double MetricsRegistry::get_gauge(MetricId gauge) const {
+    return gauges_[gauge].load(std::memory_order_relaxed);
+}
+
+HistogramSnapshot MetricsRegistry::get_histogram(MetricId histogram) const {
+    HistogramSnapshot snapshot;
+    snapshot.buckets.assign(HistogramSnapshot::BUCKET_COUNT, 0);
+
+    auto merge = [&](const ThreadShard* shard) {
+        if (shard == nullptr) return;
+        const HistogramShard* buckets = shard->histograms[histogram].load(std::memory_order_acquire);
+        if (buckets == nullptr) return;
+        snapshot.count += buckets->count.load(std::memory_order_relaxed);
+        snapshot.sum += buckets->sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, buckets->max.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < HistogramSnapshot::BUCKET_COUNT; ++i) {
+            snapshot.buckets[i] += buckets->buckets[i].load(std::memory_order_relaxed);
+        }
+    };
+
+    merge(shared_shard_.get());
+    for (const auto& entry : shards_) {
+        merge(entry.load(std::memory_order_acquire));
+    }
+    return snapshot;
+}
+
+std::vector<MetricsRegistry::Series> MetricsRegistry::get_series() const {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    return series_;
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,410 @@
+/**
+ * Anime Aggressors Performance Engine - Background metrics exporter
+ */
+
+#include "metrics_exporter.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr size_t MAX_CONNECTIONS = 64;
+constexpr size_t MAX_REQUEST_BYTES = 8192;
+
+struct ExportQuantile {
+    double percentile;
+    const char* label;
+};
+
+const ExportQuantile EXPORT_QUANTILES[] = {{50.0, "0.5"}, {95.0, "0.95"}, {99.0, "0.99"}};
+
+[[noreturn]] void throw_socket_error(const std::string& what) {
+    throw std::runtime_error("MetricsExporter: " + what + ": " + std::strerror(errno));
+}
+
+void set_nonblocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+// OpenMetrics names are [a-zA-Z_:][a-zA-Z0-9_:]*.
+std::string sanitize_name(const std::string& prefix, const std::string& name) {
+    std::string result = prefix + name;
+    for (char& c : result) {
+        const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':';
+        if (!valid) c = '_';
+    }
+    if (result.empty() || (result[0] >= '0' && result[0] <= '9')) result.insert(0, 1, '_');
+    return result;
+}
+
+void append_uint(std::string& out, uint64_t value) {
+    char buffer[24];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+void append_double(std::string& out, double value) {
+    // %g would print "nan"/"inf", which OpenMetrics parsers reject.
+    if (std::isnan(value)) {
+        out.append("NaN");
+        return;
+    }
+    if (std::isinf(value)) {
+        out.append(value > 0 ? "+Inf" : "-Inf");
+        return;
+    }
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+} // namespace
+
+struct MetricsExporter::Connection {
+    int fd;
+    bool http;                                 // answer only after a request arrives
+    std::string request;
+    std::string header;
+    std::shared_ptr<const std::string> body;   // null until the response is chosen
+    size_t sent;                               // bytes of header + body written
+    std::chrono::steady_clock::time_point deadline;   // closed if still idle then
+};
+
+// MetricsExporter Implementation
+MetricsExporter::MetricsExporter(MetricsRegistry& registry, const Options& options)
+    : registry_(registry), options_(options), http_fd_(-1), unix_fd_(-1), http_port_(0),
+      wake_pipe_{-1, -1}, latest_(std::make_shared<const std::string>()),
+      snapshots_(0), series_(0), bytes_(0), last_render_ms_(0.0), scrapes_(0), write_errors_(0),
+      idle_closes_(0), stopping_(false) {
+    if (options_.interval.count() <= 0) {
+        throw std::invalid_argument("MetricsExporter: interval must be positive");
+    }
+
+    try {
+        if (::pipe(wake_pipe_) != 0) throw_socket_error("cannot create wake pipe");
+        set_nonblocking(wake_pipe_[0]);
+        set_nonblocking(wake_pipe_[1]);
+
+        if (options_.http_port >= 0) {
+            http_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (http_fd_ < 0) throw_socket_error("cannot create HTTP socket");
+            const int reuse = 1;
+            ::setsockopt(http_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(static_cast<uint16_t>(options_.http_port));
+            if (::bind(http_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                throw_socket_error("cannot bind 127.0.0.1:" + std::to_string(options_.http_port));
+            }
+            if (::listen(http_fd_, 16) != 0) throw_socket_error("cannot listen for HTTP");
+
+            socklen_t length = sizeof(address);
+            ::getsockname(http_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+            http_port_ = ntohs(address.sin_port);
+            set_nonblocking(http_fd_);
+        }
+
+        if (!options_.unix_socket_path.empty()) {
+            sockaddr_un address{};
+            if (options_.unix_socket_path.size() >= sizeof(address.sun_path)) {
+                throw std::runtime_error("MetricsExporter: socket path too long: " + options_.unix_socket_path);
+            }
+            unix_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (unix_fd_ < 0) throw_socket_error("cannot create Unix socket");
+
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, options_.unix_socket_path.c_str(), options_.unix_socket_path.size() + 1);
+            ::unlink(options_.unix_socket_path.c_str());   // stale socket from a previous run
+            if (::bind(unix_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                throw_socket_error("cannot bind " + options_.unix_socket_path);
+            }
+            if (::listen(unix_fd_, 16) != 0) throw_socket_error("cannot listen on " + options_.unix_socket_path);
+            set_nonblocking(unix_fd_);
+        }
+    } catch (...) {
+        close_fds();
+        throw;
+    }
+
+    thread_ = std::thread([this] { run(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    stopping_.store(true, std::memory_order_release);
+    const char wake = 1;
+    (void)!::write(wake_pipe_[1], &wake, 1);
+    if (thread_.joinable()) thread_.join();
+
+    for (const Connection& connection : connections_) ::close(connection.fd);
+    close_fds();
+}
+
+void MetricsExporter::close_fds() {
+    if (http_fd_ >= 0) ::close(http_fd_);
+    if (unix_fd_ >= 0) {
+        ::close(unix_fd_);
+        ::unlink(options_.unix_socket_path.c_str());
+    }
+    if (wake_pipe_[0] >= 0) ::close(wake_pipe_[0]);
+    if (wake_pipe_[1] >= 0) ::close(wake_pipe_[1]);
+    http_fd_ = unix_fd_ = wake_pipe_[0] = wake_pipe_[1] = -1;
+}
+
+uint16_t MetricsExporter::get_http_port() const {
+    return http_port_;
+}
+
+std::shared_ptr<const std::string> MetricsExporter::latest() const {
+    std::lock_guard<std::mutex> lock(latest_mutex_);
+    return latest_;
+}
+
+MetricsExporter::Stats MetricsExporter::get_stats() const {
+    return Stats{snapshots_.load(std::memory_order_relaxed), series_.load(std::memory_order_relaxed),
+                 bytes_.load(std::memory_order_relaxed), last_render_ms_.load(std::memory_order_relaxed),
+                 scrapes_.load(std::memory_order_relaxed), write_errors_.load(std::memory_order_relaxed),
+                 idle_closes_.load(std::memory_order_relaxed)};
+}
+
+void MetricsExporter::run() {
+    using clock = std::chrono::steady_clock;
+    auto next_snapshot = clock::now();
+    std::vector<pollfd> fds;
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        const auto now = clock::now();
+        if (now >= next_snapshot) {
+            export_snapshot();
+            // Skip missed ticks instead of rendering back to back.
+            next_snapshot += options_.interval;
+            if (next_snapshot <= clock::now()) next_snapshot = clock::now() + options_.interval;
+        }
+
+        fds.clear();
+        fds.push_back(pollfd{wake_pipe_[0], POLLIN, 0});
+        if (http_fd_ >= 0) fds.push_back(pollfd{http_fd_, POLLIN, 0});
+        if (unix_fd_ >= 0) fds.push_back(pollfd{unix_fd_, POLLIN, 0});
+        const size_t first_connection = fds.size();
+        for (const Connection& connection : connections_) {
+            fds.push_back(pollfd{connection.fd, static_cast<short>(connection.body ? POLLOUT : POLLIN), 0});
+        }
+
+        // Wake for the next snapshot or the first idle deadline.
+        auto wake_at = next_snapshot;
+        for (const Connection& connection : connections_) wake_at = std::min(wake_at, connection.deadline);
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(wake_at - clock::now());
+        const int timeout = static_cast<int>(std::max<int64_t>(0, wait.count() + 1));
+        if (::poll(fds.data(), fds.size(), timeout) < 0) continue;
+
+        if (fds[0].revents != 0) {
+            char drain[64];
+            while (::read(wake_pipe_[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        // Service before accepting so fds[] still lines up with connections_.
+        const auto polled = clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < connections_.size(); ++i) {
+            Connection& connection = connections_[i];
+            bool keep = true;
+            if (fds[first_connection + i].revents != 0) {
+                keep = service(connection);
+            } else if (polled >= connection.deadline) {
+                ::close(connection.fd);
+                idle_closes_.fetch_add(1, std::memory_order_relaxed);
+                keep = false;
+            }
+            if (keep) {
+                if (kept != i) connections_[kept] = std::move(connections_[i]);
+                ++kept;
+            }
+        }
+        connections_.resize(kept);
+
+        for (size_t i = 1; i < first_connection; ++i) {
+            if (fds[i].revents & POLLIN) accept_connections(fds[i].fd, fds[i].fd == http_fd_);
+        }
+    }
+}
+
+void MetricsExporter::export_snapshot() {
+    const auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const std::string> text = render();
+    const auto end = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(latest_mutex_);
+        latest_ = text;
+    }
+    last_render_ms_.store(std::chrono::duration<double, std::milli>(end - start).count(), std::memory_order_relaxed);
+    bytes_.store(text->size(), std::memory_order_relaxed);
+    snapshots_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!options_.file_path.empty()) write_file(*text);
+}
+
+std::shared_ptr<const std::string> MetricsExporter::render() {
+    const std::vector<MetricsRegistry::Series> series = registry_.get_series();
+    while (names_.size() < series.size()) {
+        names_.push_back(sanitize_name(options_.prefix, series[names_.size()].name));
+    }
+
+    auto text = std::make_shared<std::string>();
+    // Most lines are a short name and a number; reserving up front avoids
+    // regrowing a multi-megabyte buffer.
+    text->reserve(bytes_.load(std::memory_order_relaxed) + series.size() * 16 + 1024);
+
+    for (size_t i = 0; i < series.size(); ++i) {
+        const std::string& name = names_[i];
+        switch (series[i].kind) {
+            case MetricsRegistry::Kind::COUNTER: {
+                // The family name drops a _total suffix; the sample adds it.
+                const size_t family_length = name.size() > 6 && name.compare(name.size() - 6, 6, "_total") == 0
+                                                 ? name.size() - 6 : name.size();
+                text->append("# TYPE ").append(name, 0, family_length).append(" counter\n");
+                text->append(name, 0, family_length).append("_total ");
+                append_uint(*text, registry_.get_counter(series[i].id));
+                text->push_back('\n');
+                break;
+            }
+            case MetricsRegistry::Kind::GAUGE:
+                text->append("# TYPE ").append(name).append(" gauge\n");
+                text->append(name).push_back(' ');
+                append_double(*text, registry_.get_gauge(series[i].id));
+                text->push_back('\n');
+                break;
+            case MetricsRegistry::Kind::HISTOGRAM: {
+                const HistogramSnapshot histogram = registry_.get_histogram(series[i].id);
+                uint64_t count = 0;
+                for (uint64_t bucket : histogram.buckets) count += bucket;
+
+                text->append("# TYPE ").append(name).append(" summary\n");
+                for (const ExportQuantile& quantile : EXPORT_QUANTILES) {
+                    text->append(name).append("{quantile=\"").append(quantile.label).append("\"} ");
+                    append_uint(*text, histogram.value_at_percentile(quantile.percentile));
+                    text->push_back('\n');
+                }
+                text->append(name).append("_sum ");
+                append_uint(*text, histogram.sum);
+                text->append("\n").append(name).append("_count ");
+                append_uint(*text, count);
+                text->append("\n# TYPE ").append(name).append("_max gauge\n").append(name).append("_max ");
+                append_uint(*text, histogram.max);
+                text->push_back('\n');
+                break;
+            }
+        }
+    }
+    text->append("# EOF\n");
+
+    series_.store(series.size(), std::memory_order_relaxed);
+    return text;
+}
+
+void MetricsExporter::write_file(const std::string& text) {
+    // Write-then-rename so readers never see a half-written snapshot.
+    const std::string temp_path = options_.file_path + ".tmp";
+    const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    size_t written = 0;
+    while (written < text.size()) {
+        const ssize_t result = ::write(fd, text.data() + written, text.size() - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) break;
+        written += static_cast<size_t>(result);
+    }
+    ::close(fd);
+
+    if (written != text.size() || ::rename(temp_path.c_str(), options_.file_path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MetricsExporter::accept_connections(int listen_fd, bool http) {
+    while (true) {
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) return;   // EAGAIN: backlog drained
+        if (connections_.size() >= MAX_CONNECTIONS) {
+            ::close(fd);
+            continue;
+        }
+        set_nonblocking(fd);
+
+        Connection connection{fd, http, {}, {}, nullptr, 0,
+                              std::chrono::steady_clock::now() + options_.interval};
+        if (!http) connection.body = latest();
+        connections_.push_back(std::move(connection));
+    }
+}
+
+bool MetricsExporter::service(Connection& connection) {
+    if (!connection.body) {
+        char buffer[1024];
+        const ssize_t received = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return true;
+        if (received <= 0 || connection.request.size() + static_cast<size_t>(received) > MAX_REQUEST_BYTES) {
+            ::close(connection.fd);
+            return false;
+        }
+        connection.request.append(buffer, static_cast<size_t>(received));
+        connection.deadline = std::chrono::steady_clock::now() + options_.interval;
+        if (connection.request.find("\r\n\r\n") == std::string::npos &&
+            connection.request.find("\n\n") == std::string::npos) {
+            return true;
+        }
+
+        connection.body = latest();
+        connection.header = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                            "Content-Length: " + std::to_string(connection.body->size()) + "\r\n"
+                            "Connection: close\r\n\r\n";
+    }
+
+    const size_t total = connection.header.size() + connection.body->size();
+    while (connection.sent < total) {
+        const bool in_header = connection.sent < connection.header.size();
+        const char* data = in_header ? connection.header.data() + connection.sent
+                                     : connection.body->data() + (connection.sent - connection.header.size());
+        const size_t length = in_header ? connection.header.size() - connection.sent : total - connection.sent;
+        const ssize_t result = ::send(connection.fd, data, length, MSG_NOSIGNAL);
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return true;
+        if (result <= 0) {
+            ::close(connection.fd);
+            return false;
+        }
+        connection.sent += static_cast<size_t>(result);
+        connection.deadline = std::chrono::steady_clock::now() + options_.interval;
+    }
+
+    scrapes_.fetch_add(1, std::memory_order_relaxed);
+    ::close(connection.fd);
+    return false;
+}
+
+} // namespace AnimeAggressors
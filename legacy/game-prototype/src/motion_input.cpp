@@ -0,0 +1,526 @@
+/**
+ * Anime Aggressors Performance Engine - Motion input
+ */
+
+#include "motion_input.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint8_t ALL_BUTTONS = MOTION_PUNCH | MOTION_KICK;
+constexpr uint16_t NO_AGE = UINT16_MAX;
+constexpr uint32_t AGE_BITS = 8;
+constexpr uint32_t AGE_MASK = (1u << AGE_BITS) - 1;
+constexpr uint32_t NO_STATE = UINT32_MAX;
+constexpr uint64_t NO_TRANSITION = UINT64_MAX;
+constexpr size_t FIRST_TRANSITION_SLOTS = size_t(1) << 12;
+constexpr size_t FIRST_STATE_SLOTS = size_t(1) << 12;
+
+// MAX_MOTION_TABLE_BYTES is split in half. Transitions get the largest
+// power-of-two table that fits theirs, kept at most half full; a state
+// costs its key plus an offset, an accept and up to four index slots,
+// since the index doubles at half full.
+constexpr size_t TRANSITION_SLOT_BYTES = sizeof(uint64_t) + sizeof(uint32_t);
+constexpr size_t STATE_BYTES = 6 * sizeof(uint32_t);
+
+constexpr size_t floor_power_of_two(size_t value) {
+    size_t power = 1;
+    while (power * 2 <= value) power *= 2;
+    return power;
+}
+
+constexpr size_t MAX_TRANSITIONS = floor_power_of_two(MAX_MOTION_TABLE_BYTES / 2 / TRANSITION_SLOT_BYTES) / 2;
+constexpr size_t MAX_STATE_BYTES = MAX_MOTION_TABLE_BYTES / 2;
+
+size_t transition_slot(uint64_t key, size_t mask) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return static_cast<size_t>(key) & mask;
+}
+
+size_t key_hash(const uint32_t* key, size_t size) {
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ key[i]) * 1099511628211ull;
+    return static_cast<size_t>(hash ^ hash >> 29);
+}
+
+// Numpad direction seen facing right; anything outside 1-9 reads as neutral.
+constexpr uint8_t MIRRORED[16] = {5, 3, 2, 1, 6, 5, 4, 9, 8, 7, 5, 5, 5, 5, 5, 5};
+constexpr uint8_t SANITIZED[16] = {5, 1, 2, 3, 4, 5, 6, 7, 8, 9, 5, 5, 5, 5, 5, 5};
+
+// What a step tests on one frame, without its window.
+struct Predicate {
+    uint16_t directions;
+    uint8_t buttons;
+    bool chord;
+    int charge;     // index into the charges, or -1
+
+    bool operator<(const Predicate& other) const {
+        if (directions != other.directions) return directions < other.directions;
+        if (buttons != other.buttons) return buttons < other.buttons;
+        if (chord != other.chord) return chord < other.chord;
+        return charge < other.charge;
+    }
+
+    bool matches(uint8_t direction, uint8_t pressed, uint8_t held, uint32_t full_charges) const {
+        if (!(directions & motion_direction(direction))) return false;
+        if (buttons) {
+            if (!(pressed & buttons)) return false;
+            if (chord && (held & buttons) != buttons) return false;
+        }
+        return charge < 0 || (full_charges >> charge & 1u);
+    }
+};
+
+struct TrieNode {
+    uint32_t predicate = 0;
+    uint8_t window = 0;
+    uint8_t expiry = 0;      // oldest age a next step, or the repeat check, still needs
+    uint32_t command = NO_MOTION_COMMAND;
+    std::vector<uint32_t> children;
+};
+
+uint8_t parse_button(const std::string& notation, size_t& i) {
+    static const struct {
+        const char* name;
+        uint8_t buttons;
+    } names[] = {{"LP", MOTION_LP}, {"MP", MOTION_MP}, {"HP", MOTION_HP}, {"LK", MOTION_LK},
+                 {"MK", MOTION_MK}, {"HK", MOTION_HK}, {"P", MOTION_PUNCH}, {"K", MOTION_KICK}};
+    for (const auto& name : names) {
+        if (notation.compare(i, std::char_traits<char>::length(name.name), name.name) == 0) {
+            i += std::char_traits<char>::length(name.name);
+            return name.buttons;
+        }
+    }
+    throw std::invalid_argument("Unknown button in motion \"" + notation + "\"");
+}
+
+// The charge directions for a numpad digit: the column or row it leans to.
+uint16_t charge_directions(uint8_t numpad) {
+    switch (numpad) {
+        case 2: return motion_direction(1) | motion_direction(2) | motion_direction(3);
+        case 4: return motion_direction(1) | motion_direction(4) | motion_direction(7);
+        case 6: return motion_direction(3) | motion_direction(6) | motion_direction(9);
+        case 8: return motion_direction(7) | motion_direction(8) | motion_direction(9);
+        default: return motion_direction(numpad);
+    }
+}
+
+} // namespace
+
+// Notation Implementation
+MotionCommand parse_motion_command(uint32_t move_id, const std::string& notation, uint8_t priority) {
+    MotionCommand command;
+    command.move_id = move_id;
+    command.priority = priority;
+    const auto fail = [&notation]() {
+        return std::invalid_argument("Malformed motion \"" + notation + "\"");
+    };
+
+    size_t i = 0;
+    while (i < notation.size()) {
+        const char c = notation[i];
+        if (c == ' ') {
+            ++i;
+            continue;
+        }
+        MotionStep step;
+        if (c >= '1' && c <= '9') {
+            step.directions = motion_direction(static_cast<uint8_t>(c - '0'));
+            ++i;
+        } else if (c == '[') {
+            if (i + 2 >= notation.size() || notation[i + 1] < '1' || notation[i + 1] > '9' || notation[i + 2] != ']') {
+                throw fail();
+            }
+            step.directions = charge_directions(static_cast<uint8_t>(notation[i + 1] - '0'));
+            step.charge_frames = MOTION_CHARGE_FRAMES;
+            i += 3;
+        }
+        // Buttons, on their own or after "+"
+        const bool stick = c == '[' || (c >= '1' && c <= '9');
+        if (stick && (i >= notation.size() || notation[i] != '+')) {
+            command.steps.push_back(step);
+            continue;
+        }
+        if (stick) ++i;
+        if (i >= notation.size()) throw fail();
+        step.buttons = parse_button(notation, i);
+        while (i < notation.size() && notation[i] == '+') {
+            ++i;
+            if (i >= notation.size()) throw fail();
+            // A chord names single buttons; P and K mean any one of three
+            if (!step.chord && (step.buttons & (step.buttons - 1))) throw fail();
+            const uint8_t button = parse_button(notation, i);
+            if (button & (button - 1)) throw fail();
+            step.buttons |= button;
+            step.chord = true;
+        }
+        command.steps.push_back(step);
+    }
+    if (command.steps.empty()) throw fail();
+    return command;
+}
+
+// MotionAutomaton Implementation
+MotionAutomaton::MotionAutomaton() : MotionAutomaton(std::vector<MotionCommand>()) {}
+
+MotionAutomaton::MotionAutomaton(const std::vector<MotionCommand>& commands, uint16_t timeout_frames)
+    : commands_(commands), timeout_frames_(timeout_frames) {
+    if (timeout_frames_ < 2) throw std::invalid_argument("Motion timeout must be at least 2 frames");
+    // Charges and predicates, each kept once
+    std::vector<Predicate> predicates;
+    std::map<Predicate, uint32_t> predicate_ids;
+    std::vector<std::vector<uint32_t>> step_predicates(commands_.size());
+    for (size_t c = 0; c < commands_.size(); ++c) {
+        const MotionCommand& command = commands_[c];
+        if (command.steps.empty()) throw std::invalid_argument("Motion command has no steps");
+        for (size_t s = 0; s < command.steps.size(); ++s) {
+            const MotionStep& step = command.steps[s];
+            if (!(step.directions & MOTION_ANY_DIRECTION) || (step.directions & ~MOTION_ANY_DIRECTION) ||
+                (step.buttons & ~ALL_BUTTONS) || (s > 0 && step.window == 0)) {
+                throw std::invalid_argument("Invalid motion step");
+            }
+            Predicate predicate{step.directions, step.buttons, step.chord && step.buttons != 0, -1};
+            if (step.charge_frames) {
+                size_t charge = 0;
+                while (charge < charges_.size() && (charges_[charge].directions != step.directions ||
+                                                    charges_[charge].frames != step.charge_frames)) {
+                    ++charge;
+                }
+                if (charge == charges_.size()) {
+                    if (charges_.size() == MAX_MOTION_CHARGES) throw std::length_error("Too many motion charges");
+                    charges_.push_back({step.directions, step.charge_frames});
+                }
+                predicate.charge = static_cast<int>(charge);
+            }
+            auto inserted = predicate_ids.emplace(predicate, static_cast<uint32_t>(predicates.size()));
+            if (inserted.second) predicates.push_back(predicate);
+            step_predicates[c].push_back(inserted.first->second);
+        }
+    }
+
+    // Trie of shared prefixes; node 0 is the root, always live
+    std::vector<TrieNode> nodes(1);
+    for (size_t c = 0; c < commands_.size(); ++c) {
+        uint32_t node = 0;
+        for (size_t s = 0; s < commands_[c].steps.size(); ++s) {
+            const uint32_t predicate = step_predicates[c][s];
+            const uint8_t window = s > 0 ? commands_[c].steps[s].window : 0;
+            uint32_t next = 0;
+            for (uint32_t child : nodes[node].children) {
+                if (nodes[child].predicate == predicate && nodes[child].window == window) next = child;
+            }
+            if (next == 0) {
+                next = static_cast<uint32_t>(nodes.size());
+                nodes[node].children.push_back(next);
+                nodes.emplace_back();
+                nodes[next].predicate = predicate;
+                nodes[next].window = window;
+                nodes[node].expiry = std::max(nodes[node].expiry, window);
+            }
+            node = next;
+        }
+        if (outranks(static_cast<uint32_t>(c), nodes[node].command)) nodes[node].command = static_cast<uint32_t>(c);
+        // A completed node lives on at age 0 only, where the next input
+        // sees it matched and does not read holding the last step as a repeat
+    }
+
+    // Stick classes: directions every predicate treats alike
+    std::vector<uint8_t> direction_reps;
+    {
+        std::map<std::vector<bool>, uint8_t> classes;
+        for (uint8_t direction = 1; direction <= 9; ++direction) {
+            std::vector<bool> signature;
+            for (const Predicate& predicate : predicates) {
+                signature.push_back((predicate.directions & motion_direction(direction)) != 0);
+            }
+            auto inserted = classes.emplace(signature, static_cast<uint8_t>(direction_reps.size()));
+            if (inserted.second) direction_reps.push_back(direction);
+            direction_class_[direction] = inserted.first->second;
+        }
+        for (size_t i = 0; i < 16; ++i) direction_class_[i] = direction_class_[SANITIZED[i]];
+    }
+
+    // Button classes over every pressed/held pair
+    std::vector<uint16_t> button_reps;
+    button_class_.assign(size_t(1) << 12, 0);
+    {
+        std::map<std::vector<bool>, uint16_t> classes;
+        for (uint16_t value = 0; value < (1u << 12); ++value) {
+            const uint8_t pressed = static_cast<uint8_t>(value >> 6);
+            const uint8_t held = static_cast<uint8_t>(value & ALL_BUTTONS);
+            std::vector<bool> signature;
+            for (const Predicate& predicate : predicates) {
+                if (!predicate.buttons) continue;
+                signature.push_back((pressed & predicate.buttons) &&
+                                    (!predicate.chord || (held & predicate.buttons) == predicate.buttons));
+            }
+            auto inserted = classes.emplace(signature, static_cast<uint16_t>(button_reps.size()));
+            if (inserted.second) button_reps.push_back(value);
+            button_class_[value] = inserted.first->second;
+        }
+    }
+    button_classes_ = static_cast<uint32_t>(button_reps.size());
+    charge_classes_ = 1u << charges_.size();
+
+    // Symbol classes: the combinations no predicate tells apart
+    std::vector<std::vector<bool>> class_matches;
+    {
+        std::map<std::vector<bool>, uint32_t> classes;
+        symbol_class_.resize(direction_reps.size() * button_classes_ * charge_classes_);
+        for (size_t d = 0; d < direction_reps.size(); ++d) {
+            for (size_t b = 0; b < button_classes_; ++b) {
+                const uint8_t pressed = static_cast<uint8_t>(button_reps[b] >> 6);
+                const uint8_t held = static_cast<uint8_t>(button_reps[b] & ALL_BUTTONS);
+                for (uint32_t full = 0; full < charge_classes_; ++full) {
+                    std::vector<bool> signature;
+                    for (const Predicate& predicate : predicates) {
+                        signature.push_back(predicate.matches(direction_reps[d], pressed, held, full));
+                    }
+                    auto inserted = classes.emplace(signature, static_cast<uint32_t>(class_matches.size()));
+                    if (inserted.second) class_matches.push_back(signature);
+                    symbol_class_[(d * button_classes_ + b) * charge_classes_ + full] = inserted.first->second;
+                }
+            }
+        }
+    }
+    class_count_ = static_cast<uint32_t>(class_matches.size());
+
+    // Flat tables for expand(): nodes with their children in one run, and
+    // per class which predicates hold
+    nodes_.resize(nodes.size());
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        nodes_[n] = {nodes[n].predicate, nodes[n].window, nodes[n].expiry, nodes[n].command,
+                     static_cast<uint32_t>(children_.size()), static_cast<uint32_t>(nodes[n].children.size())};
+        children_.insert(children_.end(), nodes[n].children.begin(), nodes[n].children.end());
+    }
+    predicate_count_ = static_cast<uint32_t>(predicates.size());
+    for (const std::vector<bool>& matches : class_matches) {
+        class_matches_.insert(class_matches_.end(), matches.begin(), matches.end());
+    }
+    live_ages_.assign(nodes_.size(), NO_AGE);
+    matched_last_.assign(nodes_.size(), 0);
+    reset_states();
+}
+
+bool MotionAutomaton::outranks(uint32_t a, uint32_t b) const {
+    if (b == NO_MOTION_COMMAND) return true;
+    if (commands_[a].priority != commands_[b].priority) return commands_[a].priority > commands_[b].priority;
+    if (commands_[a].steps.size() != commands_[b].steps.size()) {
+        return commands_[a].steps.size() > commands_[b].steps.size();
+    }
+    return a < b;
+}
+
+void MotionAutomaton::reset_states() {
+    state_items_.clear();
+    state_offsets_.assign(1, 0);
+    state_slots_.assign(FIRST_STATE_SLOTS, NO_STATE);
+    transition_keys_.assign(FIRST_TRANSITION_SLOTS, NO_TRANSITION);
+    transition_targets_.assign(FIRST_TRANSITION_SLOTS, NO_STATE);
+    transition_count_ = 0;
+    accepts_.clear();
+    ++generation_;
+    add_state({NO_MOTION_COMMAND});
+}
+
+uint32_t MotionAutomaton::find_state(const std::vector<uint32_t>& key) const {
+    const size_t mask = state_slots_.size() - 1;
+    for (size_t slot = key_hash(key.data(), key.size()) & mask;; slot = (slot + 1) & mask) {
+        const uint32_t id = state_slots_[slot];
+        if (id == NO_STATE) return NO_STATE;
+        const uint32_t* begin = state_items_.data() + state_offsets_[id];
+        const uint32_t* end = state_items_.data() + state_offsets_[id + 1];
+        if (std::equal(begin, end, key.begin(), key.end())) return id;
+    }
+}
+
+bool MotionAutomaton::state_fits(size_t words) const {
+    return (state_items_.size() + words) * sizeof(uint32_t) + (accepts_.size() + 1) * STATE_BYTES <= MAX_STATE_BYTES;
+}
+
+uint32_t MotionAutomaton::add_state(const std::vector<uint32_t>& key) {
+    const uint32_t id = static_cast<uint32_t>(accepts_.size());
+    state_items_.insert(state_items_.end(), key.begin(), key.end());
+    state_offsets_.push_back(static_cast<uint32_t>(state_items_.size()));
+    accepts_.push_back(key.back());
+    if ((accepts_.size() + 1) * 2 > state_slots_.size()) {
+        state_slots_.assign(state_slots_.size() * 2, NO_STATE);
+        for (uint32_t s = 0; s < id; ++s) index_state(s);
+    }
+    index_state(id);
+    return id;
+}
+
+void MotionAutomaton::index_state(uint32_t id) {
+    const size_t mask = state_slots_.size() - 1;
+    const uint32_t* key = state_items_.data() + state_offsets_[id];
+    size_t slot = key_hash(key, state_offsets_[id + 1] - state_offsets_[id]) & mask;
+    while (state_slots_[slot] != NO_STATE) slot = (slot + 1) & mask;
+    state_slots_[slot] = id;
+}
+
+uint32_t MotionAutomaton::find_transition(uint64_t key) const {
+    const size_t mask = transition_keys_.size() - 1;
+    for (size_t slot = transition_slot(key, mask);; slot = (slot + 1) & mask) {
+        if (transition_keys_[slot] == key) return transition_targets_[slot];
+        if (transition_keys_[slot] == NO_TRANSITION) return NO_STATE;
+    }
+}
+
+void MotionAutomaton::add_transition(uint64_t key, uint32_t target) {
+    if ((transition_count_ + 1) * 2 > transition_keys_.size()) {
+        std::vector<uint64_t> keys(transition_keys_.size() * 2, NO_TRANSITION);
+        std::vector<uint32_t> targets(keys.size(), NO_STATE);
+        keys.swap(transition_keys_);
+        targets.swap(transition_targets_);
+        transition_count_ = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != NO_TRANSITION) add_transition(keys[i], targets[i]);
+        }
+    }
+    const size_t mask = transition_keys_.size() - 1;
+    size_t slot = transition_slot(key, mask);
+    while (transition_keys_[slot] != NO_TRANSITION) slot = (slot + 1) & mask;
+    transition_keys_[slot] = key;
+    transition_targets_[slot] = target;
+    ++transition_count_;
+}
+
+// One step of the subset construction. A state is its live (node, age)
+// pairs sorted by node, age counted in inputs, then the command it fired.
+// On a new input every node it matches is entered at age 0 and the rest
+// age by one until no next step could still follow them; the command fired
+// is the best one whose last step did not match the input before. On a
+// timeout only the nodes the held input matches live on.
+uint32_t MotionAutomaton::expand(uint32_t state, uint32_t symbol) {
+    // The key may move as states are added, but only intern() adds them
+    const uint32_t* items = state_items_.data() + state_offsets_[state];
+    const size_t item_count = state_offsets_[state + 1] - state_offsets_[state];
+    uint32_t fired = NO_MOTION_COMMAND;
+    live_.clear();
+    const auto set_age = [this](uint32_t node, uint16_t age) {
+        if (live_ages_[node] == NO_AGE) live_.push_back(node);
+        live_ages_[node] = std::min(live_ages_[node], age);
+    };
+    if (symbol == class_count_) {
+        for (size_t i = 0; i + 1 < item_count; ++i) {
+            if ((items[i] & AGE_MASK) == 0) set_age(items[i] >> AGE_BITS, 0);
+        }
+        return intern(state, symbol, fired);
+    }
+
+    const uint8_t* matches = class_matches_.data() + size_t(symbol) * predicate_count_;
+    for (size_t i = 0; i + 1 < item_count; ++i) {
+        if ((items[i] & AGE_MASK) == 0) matched_last_[items[i] >> AGE_BITS] = 1;
+    }
+    // The root's children are first steps, which may come at any time
+    const auto enter_children = [&](const Node& parent, uint32_t age, bool timed) {
+        for (uint32_t c = parent.first_child; c < parent.first_child + parent.child_count; ++c) {
+            const Node& child = nodes_[children_[c]];
+            if (!matches[child.predicate] || (timed && age > child.window)) continue;
+            set_age(children_[c], 0);
+            if (child.command != NO_MOTION_COMMAND && !matched_last_[children_[c]] && outranks(child.command, fired)) {
+                fired = child.command;
+            }
+        }
+    };
+    enter_children(nodes_[0], 0, false);
+    for (size_t i = 0; i + 1 < item_count; ++i) {
+        const uint32_t node = items[i] >> AGE_BITS;
+        const uint32_t age = (items[i] & AGE_MASK) + 1;
+        if (age <= nodes_[node].expiry) set_age(node, static_cast<uint16_t>(age));
+        enter_children(nodes_[node], age, true);
+    }
+    for (size_t i = 0; i + 1 < item_count; ++i) matched_last_[items[i] >> AGE_BITS] = 0;
+    return intern(state, symbol, fired);
+}
+
+// Looks up or adds the state made of live_ and `fired`, and records the
+// transition to it.
+uint32_t MotionAutomaton::intern(uint32_t state, uint32_t symbol, uint32_t fired) {
+    std::sort(live_.begin(), live_.end());
+    key_.clear();
+    for (uint32_t node : live_) {
+        key_.push_back(node << AGE_BITS | live_ages_[node]);
+        live_ages_[node] = NO_AGE;
+    }
+    key_.push_back(fired);
+
+    const uint32_t found = find_state(key_);
+    if ((found == NO_STATE && !state_fits(key_.size())) || transition_count_ == MAX_TRANSITIONS) {
+        // Full: start over, keeping only where this reader is going
+        reset_states();
+        ++stats_.flushes;
+        return add_state(key_);
+    }
+    const uint32_t next = found != NO_STATE ? found : add_state(key_);
+    add_transition(uint64_t(state) << 32 | symbol, next);
+    return next;
+}
+
+uint32_t MotionAutomaton::step(MotionReader& reader, const MotionInput& input) {
+    const uint8_t direction = input.facing_left ? MIRRORED[input.direction & 15] : SANITIZED[input.direction & 15];
+    const uint8_t held = input.buttons & ALL_BUTTONS;
+    const uint8_t pressed = held & ~reader.held_buttons;
+    reader.held_buttons = held;
+
+    uint32_t full = 0;
+    for (size_t i = 0; i < charges_.size(); ++i) {
+        uint8_t& frames = reader.charge[i];
+        frames = (charges_[i].directions & motion_direction(direction))
+                     ? static_cast<uint8_t>(std::min<uint32_t>(frames + 1u, charges_[i].frames))
+                     : 0;
+        if (frames == charges_[i].frames) full |= 1u << i;
+    }
+    const uint32_t stick = full << 4 | direction;
+    const uint32_t buttons = direction_class_[direction] * button_classes_ + button_class_[pressed << 6 | held];
+    uint32_t symbol = symbol_class_[buttons * charge_classes_ + full];
+
+    // A reader from before a flush, or from another automaton, starts over
+    if (reader.generation != generation_ || reader.state >= accepts_.size()) {
+        reader.state = 0;
+        reader.generation = generation_;
+        reader.stick = NO_STATE;
+    }
+    ++stats_.frames;
+    if (!pressed && stick == reader.stick) {
+        // Same stick, no press: only time passes
+        if (reader.held_frames >= timeout_frames_ || ++reader.held_frames != timeout_frames_) {
+            return NO_MOTION_COMMAND;
+        }
+        symbol = class_count_;
+    } else {
+        reader.stick = stick;
+        reader.held_frames = 1;
+    }
+    ++stats_.transitions_taken;
+    uint32_t next = find_transition(uint64_t(reader.state) << 32 | symbol);
+    if (next == NO_STATE) {
+        ++stats_.expansions;
+        next = expand(reader.state, symbol);
+        reader.generation = generation_;
+    }
+    reader.state = next;
+    return accepts_[next];
+}
+
+MotionAutomaton::Stats MotionAutomaton::get_stats() const {
+    Stats stats = stats_;
+    stats.states = accepts_.size();
+    stats.classes = class_count_;
+    stats.transitions = transition_count_;
+    stats.table_bytes = transition_keys_.size() * TRANSITION_SLOT_BYTES +
+                        (state_items_.size() + state_offsets_.size() + state_slots_.size() + accepts_.size() +
+                         symbol_class_.size() + children_.size()) * sizeof(uint32_t) +
+                        nodes_.size() * sizeof(Node) + class_matches_.size() + button_class_.size() * sizeof(uint16_t);
+    return stats;
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,216 @@
+/**
+ * Anime Aggressors Performance Engine - Particle system
+ */
+
+#include "particle_system.h"
+#include "stage_timing.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr size_t STREAM_ALIGNMENT_FLOATS = 16;     // one cache line
+constexpr size_t MIN_PARTICLES_PER_TASK = 8192;
+constexpr size_t TASKS_PER_THREAD = 2;
+constexpr float MIN_LIFETIME = 1.0f / 1000.0f;
+
+} // namespace
+
+// ParticleSystem Implementation
+ParticleSystem::ParticleSystem(size_t capacity, uint32_t seed)
+    : capacity_(capacity),
+      stride_((capacity + STREAM_ALIGNMENT_FLOATS - 1) / STREAM_ALIGNMENT_FLOATS * STREAM_ALIGNMENT_FLOATS),
+      streams_(stride_ * STREAM_COUNT + STREAM_ALIGNMENT_FLOATS), dead_(capacity), count_(0), gravity_{0.0f, -9.81f, 0.0f}, thread_pool_(nullptr),
+      rng_state_(seed != 0 ? seed : 1), pending_spawned_(0), pending_dropped_(0) {
+    const auto address = reinterpret_cast<uintptr_t>(streams_.data());
+    const uintptr_t line = STREAM_ALIGNMENT_FLOATS * sizeof(float);
+    base_ = streams_.data() + ((line - address % line) % line) / sizeof(float);
+}
+
+ParticleEmitterId ParticleSystem::add_emitter(const ParticleEmitterDesc& desc) {
+    if (!(desc.lifetime > 0.0f)) {
+        throw std::invalid_argument("ParticleEmitterDesc lifetime must be positive");
+    }
+    return emitters_.insert(Emitter{desc, 0.0f});
+}
+
+bool ParticleSystem::remove_emitter(ParticleEmitterId emitter) {
+    return emitters_.erase(emitter);
+}
+
+ParticleEmitterDesc* ParticleSystem::get_emitter(ParticleEmitterId emitter) {
+    Emitter* found = emitters_.get(emitter);
+    return found != nullptr ? &found->desc : nullptr;
+}
+
+size_t ParticleSystem::burst(ParticleEmitterId emitter, size_t count) {
+    const Emitter* found = emitters_.get(emitter);
+    return found != nullptr ? spawn(found->desc, count) : 0;
+}
+
+void ParticleSystem::clear() {
+    count_ = 0;
+    for (Emitter& emitter : emitters_) emitter.pending = 0.0f;
+}
+
+void ParticleSystem::set_gravity(const float gravity[3]) {
+    std::copy(gravity, gravity + 3, gravity_);
+}
+
+void ParticleSystem::set_thread_pool(ThreadPool* pool) {
+    thread_pool_ = pool;
+}
+
+void ParticleSystem::update(float delta_time) {
+    auto start = std::chrono::steady_clock::now();
+    for (Emitter& emitter : emitters_) {
+        emitter.pending += emitter.desc.rate * delta_time;
+        const float whole = std::floor(emitter.pending);
+        emitter.pending -= whole;
+        spawn(emitter.desc, static_cast<size_t>(whole));
+    }
+    stats_.emit_us = elapsed_us(start);
+
+    // Ranges start on cache-line boundaries so no two tasks share a line.
+    // Each range lists its dead particles in its own slice of dead_.
+    start = std::chrono::steady_clock::now();
+    const size_t max_ranges = thread_pool_ != nullptr ? thread_pool_->get_thread_count() * TASKS_PER_THREAD : 1;
+    if (range_dead_.size() < max_ranges) range_dead_.resize(max_ranges);
+    const size_t tasks = std::max<size_t>(1, std::min(max_ranges, count_ / MIN_PARTICLES_PER_TASK));
+    const size_t per_task = (count_ + tasks - 1) / tasks;
+    const size_t chunk = std::max(STREAM_ALIGNMENT_FLOATS, (per_task + STREAM_ALIGNMENT_FLOATS - 1) /
+                                                               STREAM_ALIGNMENT_FLOATS * STREAM_ALIGNMENT_FLOATS);
+    const size_t ranges = std::max<size_t>(1, (count_ + chunk - 1) / chunk);
+    if (ranges == 1) {
+        range_dead_[0] = simulate(0, count_, delta_time);
+    } else {
+        TaskGroup group;
+        for (size_t r = 1; r < ranges; ++r) {
+            thread_pool_->submit(group, [this, r, chunk, delta_time] {
+                range_dead_[r] = simulate(r * chunk, std::min(count_, (r + 1) * chunk), delta_time);
+            });
+        }
+        range_dead_[0] = simulate(0, chunk, delta_time);
+        thread_pool_->wait(group);
+    }
+    stats_.simulate_us = elapsed_us(start);
+
+    start = std::chrono::steady_clock::now();
+    stats_.died = compact(ranges, chunk);
+    stats_.compact_us = elapsed_us(start);
+
+    stats_.alive = count_;
+    stats_.spawned = pending_spawned_;
+    stats_.dropped = pending_dropped_;
+    stats_.tasks = ranges;
+    pending_spawned_ = 0;
+    pending_dropped_ = 0;
+}
+
+ParticleRenderData ParticleSystem::get_render_data() const {
+    return ParticleRenderData{
+        {stream(POSITION_X), stream(POSITION_Y), stream(POSITION_Z)},
+        {stream(COLOR_R), stream(COLOR_G), stream(COLOR_B), stream(COLOR_A)},
+        count_,
+    };
+}
+
+size_t ParticleSystem::spawn(const ParticleEmitterDesc& desc, size_t count) {
+    const size_t fits = std::min(count, capacity_ - count_);
+    pending_spawned_ += fits;
+    pending_dropped_ += count - fits;
+
+    float* velocity[3] = {stream(VELOCITY_X), stream(VELOCITY_Y), stream(VELOCITY_Z)};
+    float* position[3] = {stream(POSITION_X), stream(POSITION_Y), stream(POSITION_Z)};
+    float* color[4] = {stream(COLOR_R), stream(COLOR_G), stream(COLOR_B), stream(COLOR_A)};
+    float* fade[4] = {stream(FADE_R), stream(FADE_G), stream(FADE_B), stream(FADE_A)};
+    float* life = stream(LIFE);
+    float* gravity_scale = stream(GRAVITY_SCALE);
+
+    for (size_t i = count_; i < count_ + fits; ++i) {
+        const float lifetime = std::max(MIN_LIFETIME, desc.lifetime + desc.lifetime_spread * random_signed());
+        for (int axis = 0; axis < 3; ++axis) {
+            position[axis][i] = desc.position[axis];
+            velocity[axis][i] = desc.velocity[axis] + desc.velocity_spread[axis] * random_signed();
+        }
+        for (int channel = 0; channel < 4; ++channel) {
+            color[channel][i] = desc.start_color[channel];
+            fade[channel][i] = (desc.end_color[channel] - desc.start_color[channel]) / lifetime;
+        }
+        life[i] = lifetime;
+        gravity_scale[i] = desc.gravity_scale;
+    }
+    count_ += fits;
+    return fits;
+}
+
+// xorshift32 mapped to [-1, 1)
+float ParticleSystem::random_signed() {
+    rng_state_ ^= rng_state_ << 13;
+    rng_state_ ^= rng_state_ >> 17;
+    rng_state_ ^= rng_state_ << 5;
+    return static_cast<float>(rng_state_ >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+size_t ParticleSystem::simulate(size_t begin, size_t end, float delta_time) {
+    const size_t count = end - begin;
+    if (count == 0) return 0;
+
+    const Vec3SoA position{stream(POSITION_X) + begin, stream(POSITION_Y) + begin, stream(POSITION_Z) + begin};
+    const Vec3SoA velocity{stream(VELOCITY_X) + begin, stream(VELOCITY_Y) + begin, stream(VELOCITY_Z) + begin};
+    float* const axes[3] = {velocity.x, velocity.y, velocity.z};
+    const float* gravity_scale = stream(GRAVITY_SCALE) + begin;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (gravity_[axis] != 0.0f) {
+            batch_multiply_add(axes[axis], axes[axis], gravity_scale, gravity_[axis] * delta_time, count);
+        }
+    }
+    batch_multiply_add(position, position, velocity, delta_time, count);
+
+    for (size_t channel = 0; channel < 4; ++channel) {
+        float* color = stream(static_cast<Stream>(COLOR_R + channel)) + begin;
+        const float* fade = stream(static_cast<Stream>(FADE_R + channel)) + begin;
+        batch_multiply_add(color, color, fade, delta_time, count);
+    }
+    float* life = stream(LIFE);
+    batch_add(life + begin, life + begin, -delta_time, count);
+
+    // Branch-free append while the life stream is still in cache.
+    uint32_t* dead = dead_.data() + begin;
+    size_t dead_count = 0;
+    for (size_t i = begin; i < end; ++i) {
+        dead[dead_count] = static_cast<uint32_t>(i);
+        dead_count += life[i] <= 0.0f;
+    }
+    return dead_count;
+}
+
+// Fills each hole, lowest first, with the last live particle, stream by
+// stream. Dead particles at the tail are simply dropped.
+size_t ParticleSystem::compact(size_t ranges, size_t chunk) {
+    const float* life = stream(LIFE);
+    const size_t before = count_;
+    for (size_t r = 0; r < ranges; ++r) {
+        const uint32_t* dead = dead_.data() + r * chunk;
+        for (size_t d = 0; d < range_dead_[r]; ++d) {
+            const size_t hole = dead[d];
+            if (hole >= count_) return before - count_;
+            --count_;
+            while (count_ > hole && life[count_] <= 0.0f) --count_;
+            if (count_ == hole) return before - count_;
+            for (size_t s = 0; s < STREAM_COUNT; ++s) {
+                float* values = base_ + s * stride_;
+                values[hole] = values[count_];
+            }
+        }
+    }
+    return before - count_;
+}
+
+} // namespace AnimeAggressors
@@ -4,280 +4,129 @@
  */
 
 #include "performance_engine.h"
+#include "mpsc_ring.h"
+
 #include <iostream>
 #include <algorithm>
+#include <cfloat>
 #include <cmath>
 #include <chrono>
+#include <stdexcept>
 
 namespace AnimeAggressors {
 
-// MemoryPool Implementation
-MemoryPool::MemoryPool(size_t block_size, size_t block_count)
-    : block_size_(block_size), block_count_(block_count) {
-    memory_.resize(block_size * block_count);
-    
-    // Initialize free blocks queue
-    for (size_t i = 0; i < block_count; ++i) {
-        free_blocks_.push(memory_.data() + i * block_size);
-    }
-}
-
-MemoryPool::~MemoryPool() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    while (!free_blocks_.empty()) {
-        free_blocks_.pop();
-    }
-}
-
-void* MemoryPool::allocate() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (free_blocks_.empty()) {
-        return nullptr;
-    }
-    
-    void* ptr = free_blocks_.front();
-    free_blocks_.pop();
-    return ptr;
-}
-
-void MemoryPool::deallocate(void* ptr) {
-    if (ptr == nullptr) return;
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    free_blocks_.push(ptr);
-}
-
-size_t MemoryPool::get_available_blocks() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return free_blocks_.size();
-}
-
-size_t MemoryPool::get_total_blocks() const {
-    return block_count_;
-}
-
-// ThreadPool Implementation
-ThreadPool::ThreadPool(size_t thread_count) : stop_(false) {
-    for (size_t i = 0; i < thread_count; ++i) {
-        workers_.emplace_back([this] {
-            while (true) {
-                std::function<void()> task;
-                
-                {
-                    std::unique_lock<std::mutex> lock(queue_mutex_);
-                    condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
-                    
-                    if (stop_ && tasks_.empty()) {
-                        return;
-                    }
-                    
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                }
-                
-                task();
-            }
-        });
-    }
-}
-
-ThreadPool::~ThreadPool() {
-    shutdown();
-}
-
-template<typename F, typename... Args>
-auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type> {
-    using return_type = typename std::result_of<F(Args...)>::type;
-    
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-    );
-    
-    std::future<return_type> res = task->get_future();
-    
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (stop_) {
-            throw std::runtime_error("enqueue on stopped ThreadPool");
-        }
-        
-        tasks_.emplace([task] { (*task)(); });
-    }
-    
-    condition_.notify_one();
-    return res;
-}
-
-void ThreadPool::shutdown() {
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        stop_ = true;
-    }
-    
-    condition_.notify_all();
-    
-    for (std::thread& worker : workers_) {
-        if (worker.joinable()) {
-            worker.join();
-        }
-    }
-}
-
-size_t ThreadPool::get_thread_count() const {
-    return workers_.size();
-}
-
-// CacheSystem Implementation
-CacheSystem::CacheSystem(size_t max_size) : max_size_(max_size) {
-    head_ = std::make_shared<CacheNode>();
-    tail_ = std::make_shared<CacheNode>();
-    head_->next = tail_;
-    tail_->prev = head_;
-}
-
-CacheSystem::~CacheSystem() {
-    clear();
+// Analytics Implementation
+Analytics::Analytics() {
+    ids_.frame_count = registry_.register_counter("frame_count");
+    ids_.fps = registry_.register_gauge("fps");
+    ids_.frame_time = registry_.register_gauge("frame_time_seconds");
+    ids_.frame_time_us = registry_.register_histogram("frame_time_us");
+    ids_.entity_count = registry_.register_gauge("entity_count");
+    ids_.particle_count = registry_.register_gauge("particle_count");
+    ids_.draw_calls = registry_.register_gauge("draw_calls");
+    ids_.visible_entities = registry_.register_gauge("visible_entities");
+    ids_.culled_entities = registry_.register_gauge("culled_entities");
+    ids_.audio_voices = registry_.register_gauge("audio_voices");
+    ids_.audio_virtual_voices = registry_.register_gauge("audio_virtual_voices");
+    ids_.audio_block_us = registry_.register_gauge("audio_block_us");
+    ids_.input_latency_us = registry_.register_histogram("input_latency_us");
+    ids_.memory_usage = registry_.register_gauge("memory_usage_bytes");
+    ids_.cache_hits = registry_.register_counter("cache_hits");
+    ids_.cache_misses = registry_.register_counter("cache_misses");
 }
 
-bool CacheSystem::get(const std::string& key, std::string& value) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto it = cache_map_.find(key);
-    if (it == cache_map_.end()) {
-        misses_++;
-        return false;
-    }
-    
-    // Move to head (LRU)
-    auto node = it->second;
-    node->prev->next = node->next;
-    node->next->prev = node->prev;
-    
-    node->next = head_->next;
-    node->prev = head_;
-    head_->next->prev = node;
-    head_->next = node;
-    
-    value = node->value;
-    hits_++;
-    return true;
-}
+Analytics::~Analytics() = default;
 
-void CacheSystem::put(const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto it = cache_map_.find(key);
-    if (it != cache_map_.end()) {
-        // Update existing
-        it->second->value = value;
-        it->second->timestamp = std::chrono::high_resolution_clock::now();
-        return;
-    }
-    
-    // Add new
-    if (cache_map_.size() >= max_size_) {
-        // Remove least recently used
-        auto lru = tail_->prev;
-        lru->prev->next = tail_;
-        tail_->prev = lru->prev;
-        cache_map_.erase(lru->key);
-    }
-    
-    auto node = std::make_shared<CacheNode>();
-    node->key = key;
-    node->value = value;
-    node->timestamp = std::chrono::high_resolution_clock::now();
-    
-    node->next = head_->next;
-    node->prev = head_;
-    head_->next->prev = node;
-    head_->next = node;
+void Analytics::record_frame_time(double frame_time) {
+    const double fps = 1.0 / frame_time;
+    registry_.set(ids_.frame_time, frame_time);
+    registry_.set(ids_.fps, fps);
+    registry_.add(ids_.frame_count);
+    registry_.record_seconds(ids_.frame_time_us, frame_time);
     
-    cache_map_[key] = node;
+    check_performance_thresholds(frame_time, fps);
 }
 
-void CacheSystem::remove(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto it = cache_map_.find(key);
-    if (it == cache_map_.end()) {
-        return;
-    }
-    
-    auto node = it->second;
-    node->prev->next = node->next;
-    node->next->prev = node->prev;
-    cache_map_.erase(it);
+void Analytics::record_entity_count(uint64_t count) {
+    registry_.set(ids_.entity_count, static_cast<double>(count));
 }
 
-void CacheSystem::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    cache_map_.clear();
-    head_->next = tail_;
-    tail_->prev = head_;
+void Analytics::record_particle_count(uint64_t count) {
+    registry_.set(ids_.particle_count, static_cast<double>(count));
 }
 
-size_t CacheSystem::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return cache_map_.size();
+void Analytics::record_draw_calls(uint64_t count) {
+    registry_.set(ids_.draw_calls, static_cast<double>(count));
 }
 
-double CacheSystem::get_hit_rate() const {
-    uint64_t total = hits_ + misses_;
-    if (total == 0) return 0.0;
-    return static_cast<double>(hits_) / total;
+void Analytics::record_visibility(uint64_t visible, uint64_t culled) {
+    registry_.set(ids_.visible_entities, static_cast<double>(visible));
+    registry_.set(ids_.culled_entities, static_cast<double>(culled));
 }
 
-// Analytics Implementation
-Analytics::Analytics() {
-    metrics_.frame_count = 0;
-    metrics_.fps = 0.0;
-    metrics_.frame_time = 0.0;
-    metrics_.entity_count = 0;
-    metrics_.particle_count = 0;
-    metrics_.draw_calls = 0;
-    metrics_.memory_usage = 0;
-    metrics_.cache_hits = 0;
-    metrics_.cache_misses = 0;
+void Analytics::record_audio(uint64_t real_voices, uint64_t virtual_voices, double block_us) {
+    registry_.set(ids_.audio_voices, static_cast<double>(real_voices));
+    registry_.set(ids_.audio_virtual_voices, static_cast<double>(virtual_voices));
+    registry_.set(ids_.audio_block_us, block_us);
 }
 
-Analytics::~Analytics() = default;
-
-void Analytics::record_frame_time(double frame_time) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    metrics_.frame_time = frame_time;
-    metrics_.fps = 1.0 / frame_time;
-    metrics_.frame_count++;
-    
-    check_performance_thresholds();
+void Analytics::record_input_latency(double seconds) {
+    registry_.record_seconds(ids_.input_latency_us, seconds);
 }
 
-void Analytics::record_entity_count(uint64_t count) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    metrics_.entity_count = count;
+void Analytics::record_memory_usage(uint64_t usage) {
+    registry_.set(ids_.memory_usage, static_cast<double>(usage));
 }
 
-void Analytics::record_draw_calls(uint64_t count) {
+void Analytics::record_memory_usage(uint32_t block_size, uint64_t live_bytes, uint64_t peak_bytes) {
     std::lock_guard<std::mutex> lock(mutex_);
-    metrics_.draw_calls = count;
+    memory_classes_[block_size] = MemoryClassUsage{block_size, live_bytes, peak_bytes};
 }
 
-void Analytics::record_memory_usage(uint64_t usage) {
+void Analytics::record_memory_usage(const std::vector<MemoryClassUsage>& classes) {
     std::lock_guard<std::mutex> lock(mutex_);
-    metrics_.memory_usage = usage;
+    for (const MemoryClassUsage& usage : classes) memory_classes_[usage.block_size] = usage;
 }
 
 void Analytics::record_cache_hit() {
-    metrics_.cache_hits++;
+    registry_.add(ids_.cache_hits);
 }
 
 void Analytics::record_cache_miss() {
-    metrics_.cache_misses++;
+    registry_.add(ids_.cache_misses);
 }
 
 PerformanceMetrics Analytics::get_metrics() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return metrics_;
+    PerformanceMetrics metrics;
+    metrics.frame_count = registry_.get_counter(ids_.frame_count);
+    metrics.fps = registry_.get_gauge(ids_.fps);
+    metrics.frame_time = registry_.get_gauge(ids_.frame_time);
+    metrics.entity_count = static_cast<uint64_t>(registry_.get_gauge(ids_.entity_count));
+    metrics.particle_count = static_cast<uint64_t>(registry_.get_gauge(ids_.particle_count));
+    metrics.draw_calls = static_cast<uint64_t>(registry_.get_gauge(ids_.draw_calls));
+    metrics.visible_entities = static_cast<uint64_t>(registry_.get_gauge(ids_.visible_entities));
+    metrics.culled_entities = static_cast<uint64_t>(registry_.get_gauge(ids_.culled_entities));
+    metrics.audio_voices = static_cast<uint64_t>(registry_.get_gauge(ids_.audio_voices));
+    metrics.audio_virtual_voices = static_cast<uint64_t>(registry_.get_gauge(ids_.audio_virtual_voices));
+    metrics.audio_block_us = registry_.get_gauge(ids_.audio_block_us);
+    metrics.memory_usage = static_cast<uint64_t>(registry_.get_gauge(ids_.memory_usage));
+    metrics.cache_hits = registry_.get_counter(ids_.cache_hits);
+    metrics.cache_misses = registry_.get_counter(ids_.cache_misses);
+    
+    const HistogramSnapshot frame_times = registry_.get_histogram(ids_.frame_time_us);
+    metrics.frame_time_p50_us = frame_times.value_at_percentile(50.0);
+    metrics.frame_time_p95_us = frame_times.value_at_percentile(95.0);
+    metrics.frame_time_p99_us = frame_times.value_at_percentile(99.0);
+    metrics.frame_time_max_us = frame_times.max;
+    
+    const HistogramSnapshot input_latencies = registry_.get_histogram(ids_.input_latency_us);
+    metrics.input_latency_p50_us = input_latencies.value_at_percentile(50.0);
+    metrics.input_latency_p99_us = input_latencies.value_at_percentile(99.0);
+    return metrics;
+}
+
+HistogramSnapshot Analytics::get_frame_time_histogram() const {
+    return registry_.get_histogram(ids_.frame_time_us);
 }
 
 std::vector<PerformanceAlert> Analytics::get_alerts() const {
@@ -290,22 +139,38 @@ void Analytics::clear_alerts() {
     alerts_.clear();
 }
 
-void Analytics::check_performance_thresholds() {
-    // Check for performance issues
-    if (metrics_.fps < 30.0) {
-        add_alert("Low FPS detected: " + std::to_string(metrics_.fps), 8);
+std::vector<MemoryClassUsage> Analytics::get_memory_class_usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<MemoryClassUsage> usage;
+    usage.reserve(memory_classes_.size());
+    for (const auto& entry : memory_classes_) {
+        usage.push_back(entry.second);
+    }
+    return usage;
+}
+
+MetricsRegistry& Analytics::get_registry() {
+    return registry_;
+}
+
+void Analytics::check_performance_thresholds(double frame_time, double fps) {
+    // Check for performance issues; only a firing alert takes the mutex
+    if (fps < 30.0) {
+        add_alert("Low FPS detected: " + std::to_string(fps), 8);
     }
     
-    if (metrics_.frame_time > 0.033) { // 30 FPS threshold
-        add_alert("High frame time: " + std::to_string(metrics_.frame_time), 7);
+    if (frame_time > 0.033) { // 30 FPS threshold
+        add_alert("High frame time: " + std::to_string(frame_time), 7);
     }
     
-    if (metrics_.entity_count > MAX_ENTITIES * 0.8) {
-        add_alert("High entity count: " + std::to_string(metrics_.entity_count), 6);
+    const double entity_count = registry_.get_gauge(ids_.entity_count);
+    if (entity_count > MAX_ENTITIES * 0.8) {
+        add_alert("High entity count: " + std::to_string(static_cast<uint64_t>(entity_count)), 6);
     }
     
-    if (metrics_.memory_usage > 1024 * 1024 * 1024) { // 1GB threshold
-        add_alert("High memory usage: " + std::to_string(metrics_.memory_usage), 9);
+    const double memory_usage = registry_.get_gauge(ids_.memory_usage);
+    if (memory_usage > 1024.0 * 1024 * 1024) { // 1GB threshold
+        add_alert("High memory usage: " + std::to_string(static_cast<uint64_t>(memory_usage)), 9);
     }
 }
 
@@ -317,6 +182,7 @@ void Analytics::add_alert(const std::string& message, uint8_t severity) {
     alert.severity = severity;
     alert.resolved = false;
     
+    std::lock_guard<std::mutex> lock(mutex_);
     alerts_.push_back(alert);
 }
 
@@ -339,11 +205,35 @@ void FightingSystem::update_combat(float delta_time) {
     }
 }
 
-void FightingSystem::process_input(const std::string& input, uint32_t player_id) {
+uint32_t FightingSystem::load_move_list(const std::vector<MotionCommand>& commands) {
+    MotionAutomaton automaton(commands);
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Process input for combat
-    // This would include move execution, combo detection, etc.
+    move_lists_.push_back(std::move(automaton));
+    return static_cast<uint32_t>(move_lists_.size() - 1);
+}
+
+void FightingSystem::set_player_move_list(uint32_t player_id, uint32_t move_list) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (move_list >= move_lists_.size()) {
+        throw std::invalid_argument("FightingSystem: move list " + std::to_string(move_list) + " is not loaded");
+    }
+    if (player_id >= players_.size()) players_.resize(player_id + 1);
+    players_[player_id].move_list = move_list;
+    players_[player_id].reader = MotionReader();
+}
+
+uint32_t FightingSystem::process_input(const MotionInput& input, uint32_t player_id) {
+    uint32_t move_id = NO_MOTION_COMMAND;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (player_id >= players_.size() || players_[player_id].move_list == NO_MOTION_COMMAND) return move_id;
+        PlayerMotion& player = players_[player_id];
+        MotionAutomaton& automaton = move_lists_[player.move_list];
+        const uint32_t command = automaton.step(player.reader, input);
+        if (command != NO_MOTION_COMMAND) move_id = automaton.get_command(command).move_id;
+    }
+    if (move_id != NO_MOTION_COMMAND) execute_move(move_id, player_id);
+    return move_id;
 }
 
 void FightingSystem::execute_move(uint32_t move_id, uint32_t player_id) {
@@ -376,62 +266,177 @@ uint32_t FightingSystem::get_entity_count() const {
 }
 
 // InputSystem Implementation
-InputSystem::InputSystem() = default;
+InputSystem::InputSystem()
+    : frame_time_ns_(0), input_handlers_(MAX_INPUT_KEYS), events_(std::make_unique<MpscRing<InputEvent>>(INPUT_EVENT_CAPACITY)), dropped_events_(0) {
+    waiting_.reserve(INPUT_EVENT_CAPACITY);
+    frame_events_.reserve(INPUT_EVENT_CAPACITY);
+}
+
 InputSystem::~InputSystem() = default;
 
 void InputSystem::process_input_frame() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    process_input_frame(input_timestamp_now());
+}
+
+void InputSystem::process_input_frame(uint64_t deadline_ns) {
+    frame_time_ns_ = input_timestamp_now();
+    just_pressed_.reset();
+    just_released_.reset();
+    previous_mouse_position_ = mouse_position_;
+    frame_events_.clear();
+    
+    const size_t already_waiting = waiting_.size();
+    InputEvent event;
+    while (events_->try_pop(event)) waiting_.push_back(event);
+    // Devices post concurrently, so the ring is only roughly in time order;
+    // an insertion sort puts the few new events in place without allocating
+    for (size_t i = already_waiting; i < waiting_.size(); ++i) {
+        const InputEvent moving = waiting_[i];
+        size_t j = i;
+        for (; j > 0 && waiting_[j - 1].timestamp_ns > moving.timestamp_ns; --j) waiting_[j] = waiting_[j - 1];
+        waiting_[j] = moving;
+    }
+    
+    size_t due = 0;
+    while (due < waiting_.size() && waiting_[due].timestamp_ns <= deadline_ns) {
+        apply(waiting_[due]);
+        frame_events_.push_back(waiting_[due]);
+        ++due;
+    }
+    waiting_.erase(waiting_.begin(), waiting_.begin() + due);
+    
+    ++stats_.frames;
+    stats_.events += due;
+    stats_.waiting_events = waiting_.size();
+    if (due > 0) {
+        const uint64_t newest = frame_events_.back().timestamp_ns;
+        stats_.last_latency_us = frame_time_ns_ > newest ? (frame_time_ns_ - newest) / 1000.0 : 0.0;
+        const uint64_t oldest = frame_events_.front().timestamp_ns;
+        const double oldest_us = frame_time_ns_ > oldest ? (frame_time_ns_ - oldest) / 1000.0 : 0.0;
+        stats_.max_latency_us = std::max(stats_.max_latency_us, oldest_us);
+    }
     
-    // Process input for current frame
-    // This would include keyboard, mouse, gamepad input
+    if (just_pressed_.none()) return;
+    for (size_t key = 0; key < MAX_INPUT_KEYS; ++key) {
+        if (just_pressed_[key] && input_handlers_[key]) input_handlers_[key]();
+    }
+}
+
+void InputSystem::apply(const InputEvent& event) {
+    switch (event.type) {
+        case InputEventType::KEY_DOWN:
+            // Repeats while held are not new presses
+            if (!pressed_[event.key]) {
+                pressed_.set(event.key);
+                just_pressed_.set(event.key);
+            }
+            break;
+        case InputEventType::KEY_UP:
+            if (pressed_[event.key]) {
+                pressed_.reset(event.key);
+                just_released_.set(event.key);
+            }
+            break;
+        case InputEventType::MOUSE_MOVE:
+            mouse_position_ = Vector3D(event.x, event.y, 0.0f);
+            break;
+    }
 }
 
 void InputSystem::register_input_handler(const std::string& input, std::function<void()> handler) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    input_handlers_[input] = handler;
+    input_handlers_[intern_key(input)] = std::move(handler);
 }
 
 void InputSystem::unregister_input_handler(const std::string& input) {
+    const KeyCode key = find_key(input);
+    if (key != NO_KEY) input_handlers_[key] = nullptr;
+}
+
+KeyCode InputSystem::intern_key(const std::string& key) {
     std::lock_guard<std::mutex> lock(mutex_);
-    input_handlers_.erase(input);
+    auto it = key_codes_.find(key);
+    if (it != key_codes_.end()) return it->second;
+    if (key_names_.size() >= MAX_INPUT_KEYS) {
+        throw std::length_error("InputSystem: more than " + std::to_string(MAX_INPUT_KEYS) + " keys");
+    }
+    const KeyCode code = static_cast<KeyCode>(key_names_.size());
+    key_codes_.emplace(key, code);
+    key_names_.push_back(key);
+    return code;
 }
 
-bool InputSystem::is_key_pressed(const std::string& key) const {
+KeyCode InputSystem::find_key(const std::string& key) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = key_states_.find(key);
-    return it != key_states_.end() && it->second;
+    auto it = key_codes_.find(key);
+    return it != key_codes_.end() ? it->second : NO_KEY;
 }
 
-bool InputSystem::is_key_just_pressed(const std::string& key) const {
+std::string InputSystem::get_key_name(KeyCode key) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = key_states_.find(key);
-    auto prev_it = previous_key_states_.find(key);
-    return it != key_states_.end() && it->second && 
-           (prev_it == previous_key_states_.end() || !prev_it->second);
+    return key < key_names_.size() ? key_names_[key] : std::string();
+}
+
+bool InputSystem::post_key(KeyCode key, bool down, uint64_t timestamp_ns) {
+    if (key >= MAX_INPUT_KEYS) return false;
+    const InputEvent event{down ? InputEventType::KEY_DOWN : InputEventType::KEY_UP, key, 0.0f, 0.0f, timestamp_ns};
+    if (events_->try_push(event)) return true;
+    dropped_events_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool InputSystem::post_mouse_move(float x, float y, uint64_t timestamp_ns) {
+    const InputEvent event{InputEventType::MOUSE_MOVE, NO_KEY, x, y, timestamp_ns};
+    if (events_->try_push(event)) return true;
+    dropped_events_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool InputSystem::is_key_pressed(KeyCode key) const {
+    return key < MAX_INPUT_KEYS && pressed_[key];
+}
+
+bool InputSystem::is_key_just_pressed(KeyCode key) const {
+    return key < MAX_INPUT_KEYS && just_pressed_[key];
+}
+
+bool InputSystem::is_key_just_released(KeyCode key) const {
+    return key < MAX_INPUT_KEYS && just_released_[key];
+}
+
+bool InputSystem::is_key_pressed(const std::string& key) const {
+    return is_key_pressed(find_key(key));
+}
+
+bool InputSystem::is_key_just_pressed(const std::string& key) const {
+    return is_key_just_pressed(find_key(key));
 }
 
 bool InputSystem::is_key_just_released(const std::string& key) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = key_states_.find(key);
-    auto prev_it = previous_key_states_.find(key);
-    return it != key_states_.end() && !it->second && 
-           (prev_it != previous_key_states_.end() && prev_it->second);
+    return is_key_just_released(find_key(key));
 }
 
 Vector3D InputSystem::get_mouse_position() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return mouse_position_;
 }
 
 Vector3D InputSystem::get_mouse_delta() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return mouse_position_ - previous_mouse_position_;
 }
 
+InputSystem::Stats InputSystem::get_stats() const {
+    Stats stats = stats_;
+    stats.dropped_events = dropped_events_.load(std::memory_order_relaxed);
+    return stats;
+}
+
 // GraphicsEngine Implementation
 GraphicsEngine::GraphicsEngine() 
     : initialized_(false), viewport_width_(1920), viewport_height_(1080),
-      lighting_enabled_(true), shadows_enabled_(true), anti_aliasing_enabled_(true) {
+      fov_y_(1.0471976f), near_distance_(0.1f), far_distance_(1000.0f),
+      lighting_enabled_(true), shadows_enabled_(true), anti_aliasing_enabled_(true),
+      commands_(MAX_ENTITIES), backend_(std::make_unique<HeadlessRenderBackend>()),
+      particles_{{nullptr, nullptr, nullptr}, {nullptr, nullptr, nullptr, nullptr}, 0},
+      view_forward_(0.0f, 0.0f, 1.0f) {
 }
 
 GraphicsEngine::~GraphicsEngine() {
@@ -458,13 +463,41 @@ void GraphicsEngine::shutdown() {
     initialized_ = false;
 }
 
+void GraphicsEngine::begin_frame() {
+    commands_.clear();
+    particles_.count = 0;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    view_position_ = camera_position_;
+    const Vector3D forward = (camera_target_ - camera_position_).normalized();
+    view_forward_ = forward.magnitude() > 0.0f ? forward : Vector3D(0.0f, 0.0f, 1.0f);
+}
+
 void GraphicsEngine::render_frame() {
     if (!initialized_) return;
     
-    // Render frame
-    // This would include scene rendering, post-processing, etc.
+    // Opaque batches, then particles, then transparent and UI batches
+    commands_.sort();
+    backend_->begin_frame();
+    uint64_t draws = 0;
+    bool particles_drawn = false;
+    const RenderInstance* instances = commands_.get_sorted_instances().data();
+    for (const DrawBatch& batch : commands_.get_batches()) {
+        if (!particles_drawn && batch.layer >= RENDER_LAYER_TRANSPARENT) {
+            backend_->draw_particles(particles_);
+            draws += particles_.count > 0;
+            particles_drawn = true;
+        }
+        backend_->draw_instanced(batch, instances + batch.first_instance);
+        ++draws;
+    }
+    if (!particles_drawn) {
+        backend_->draw_particles(particles_);
+        draws += particles_.count > 0;
+    }
+    backend_->end_frame();
     
-    draw_calls_ = 0; // Reset for next frame
+    draw_calls_ = draws;
 }
 
 void GraphicsEngine::set_viewport(int width, int height) {
@@ -479,31 +512,84 @@ void GraphicsEngine::set_camera(const Vector3D& position, const Vector3D& target
     camera_target_ = target;
 }
 
+void GraphicsEngine::set_projection(float fov_y, float near_distance, float far_distance) {
+    const float eye[3] = {0.0f, 0.0f, 0.0f};
+    const float target[3] = {0.0f, 0.0f, 1.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    make_frustum(eye, target, up, fov_y, 1.0f, near_distance, far_distance);   // validates
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    fov_y_ = fov_y;
+    near_distance_ = near_distance;
+    far_distance_ = far_distance;
+}
+
+Frustum GraphicsEngine::get_frustum() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const float eye[3] = {camera_position_.x, camera_position_.y, camera_position_.z};
+    const float target[3] = {camera_target_.x, camera_target_.y, camera_target_.z};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    const float aspect = viewport_width_ > 0 && viewport_height_ > 0
+        ? static_cast<float>(viewport_width_) / static_cast<float>(viewport_height_) : 1.0f;
+    return make_frustum(eye, target, up, fov_y_, aspect, near_distance_, far_distance_);
+}
+
 void GraphicsEngine::draw_entity(const Entity& entity) {
+    RenderableComponent renderable;
+    renderable.mesh = entity.type;
+    draw_entity(entity, renderable);
+}
+
+void GraphicsEngine::draw_entity(const Entity& entity, const RenderableComponent& renderable) {
     if (!initialized_) return;
     
-    // Draw entity
-    // This would include mesh rendering, texture application, etc.
-    
-    draw_calls_++;
+    const Transform& t = entity.transform;
+    const RenderInstance instance{
+        {t.position.x, t.position.y, t.position.z},
+        {t.scale.x, t.scale.y, t.scale.z},
+        {t.rotation.x, t.rotation.y, t.rotation.z, t.rotation.w},
+        entity.id,
+    };
+    commands_.add(renderable.layer, renderable.material, renderable.mesh, view_depth(t.position), instance);
 }
 
-void GraphicsEngine::draw_particles(const std::vector<Vector3D>& positions) {
+void GraphicsEngine::draw_particles(const ParticleRenderData& particles) {
     if (!initialized_) return;
     
-    // Draw particles
-    // This would include particle system rendering, etc.
-    
-    draw_calls_++;
+    particles_ = particles;
 }
 
 void GraphicsEngine::draw_ui_element(const std::string& element_id, const Vector3D& position) {
     if (!initialized_) return;
     
-    // Draw UI element
-    // This would include UI rendering, etc.
-    
-    draw_calls_++;
+    // Each distinct element is its own material on a shared quad (mesh 0)
+    auto it = ui_materials_.find(element_id);
+    if (it == ui_materials_.end()) {
+        it = ui_materials_.emplace(element_id, static_cast<uint32_t>(ui_materials_.size())).first;
+    }
+    const RenderInstance instance{{position.x, position.y, position.z}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 1.0f}, 0};
+    commands_.add(RENDER_LAYER_UI, it->second, 0, 0.0f, instance);
+}
+
+void GraphicsEngine::set_backend(std::unique_ptr<RenderBackend> backend) {
+    backend_ = std::move(backend);
+}
+
+RenderBackend& GraphicsEngine::get_backend() {
+    return *backend_;
+}
+
+const RenderCommandBuffer& GraphicsEngine::get_command_buffer() const {
+    return commands_;
+}
+
+uint64_t GraphicsEngine::get_draw_calls() const {
+    return draw_calls_;
+}
+
+float GraphicsEngine::view_depth(const Vector3D& position) const {
+    const Vector3D offset = position - view_position_;
+    return offset.x * view_forward_.x + offset.y * view_forward_.y + offset.z * view_forward_.z;
 }
 
 void GraphicsEngine::set_lighting_enabled(bool enabled) {
@@ -523,7 +609,10 @@ void GraphicsEngine::set_anti_aliasing_enabled(bool enabled) {
 
 // AudioEngine Implementation
 AudioEngine::AudioEngine() 
-    : initialized_(false), master_volume_(1.0f), sfx_volume_(1.0f), music_volume_(1.0f) {
+    : initialized_(false), master_volume_(1.0f), sfx_volume_(1.0f), music_volume_(1.0f),
+      listener_forward_(0.0f, 0.0f, -1.0f), listener_up_(0.0f, 1.0f, 0.0f),
+      sink_(std::make_unique<NullAudioSink>()), mixer_(MAX_SOUNDS), current_music_(NO_SOUND) {
+    mixer_.set_max_real_voices(MAX_REAL_SOUNDS);
 }
 
 AudioEngine::~AudioEngine() {
@@ -535,86 +624,175 @@ AudioEngine::~AudioEngine() {
 void AudioEngine::initialize() {
     if (initialized_) return;
     
-    // Initialize audio system
-    // This would include audio device setup, etc.
-    
+    std::lock_guard<std::mutex> lock(mutex_);
+    mixer_.start_thread(*sink_);
     initialized_ = true;
 }
 
 void AudioEngine::shutdown() {
     if (!initialized_) return;
     
-    // Cleanup audio resources
-    // This would include audio device cleanup, etc.
-    
+    std::lock_guard<std::mutex> lock(mutex_);
+    mixer_.stop_thread();
     initialized_ = false;
 }
 
 void AudioEngine::update_audio() {
     if (!initialized_) return;
     
-    // Update audio system
-    // This would include 3D audio processing, etc.
+    std::lock_guard<std::mutex> lock(mutex_);
+    mixer_.update();
+    if (!mixer_.is_playing(current_music_)) current_music_ = NO_SOUND;
 }
 
-void AudioEngine::play_sound(const std::string& sound_id, const Vector3D& position) {
+void AudioEngine::process_contacts(const ContactEventBuffer& events) {
     if (!initialized_) return;
     
+    for (const ContactEvent& event : events.get_events()) {
+        // Both sides of a contact carry it; sound it once
+        if (event.phase == ContactPhase::BEGIN && event.entity < event.other) {
+            play_sound("impact", Vector3D(event.point[0], event.point[1], event.point[2]));
+        }
+    }
+}
+
+void AudioEngine::register_sound(const std::string& sound_id, std::vector<float> samples) {
+    if (samples.empty()) {
+        throw std::invalid_argument("AudioEngine: sound " + sound_id + " has no samples");
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    playing_sounds_[sound_id] = true;
-    
-    // Play sound at position
-    // This would include 3D audio positioning, etc.
+    // Voices read the samples from the mixer thread, so a clip is never replaced
+    if (!sounds_.emplace(sound_id, std::move(samples)).second) {
+        throw std::invalid_argument("AudioEngine: sound " + sound_id + " is already registered");
+    }
 }
 
-void AudioEngine::play_music(const std::string& music_id, bool loop) {
-    if (!initialized_) return;
+bool AudioEngine::has_sound(const std::string& sound_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sounds_.count(sound_id) != 0;
+}
+
+SoundHandle AudioEngine::play_sound(const std::string& sound_id, const Vector3D& position, float volume,
+                                    uint8_t priority) {
+    VoiceParams params;
+    params.gain = volume;
+    params.priority = priority;
+    params.position[0] = position.x;
+    params.position[1] = position.y;
+    params.position[2] = position.z;
     
     std::lock_guard<std::mutex> lock(mutex_);
-    current_music_ = music_id;
+    return play_clip(sound_id, params);
+}
+
+SoundHandle AudioEngine::play_music(const std::string& music_id, bool loop) {
+    VoiceParams params;
+    params.bus = AUDIO_BUS_MUSIC;
+    params.positional = false;
+    params.loop = loop;
+    params.priority = UINT8_MAX;
     
-    // Play music
-    // This would include music playback, etc.
+    std::lock_guard<std::mutex> lock(mutex_);
+    mixer_.stop(current_music_);
+    current_music_ = play_clip(music_id, params);
+    return current_music_;
 }
 
-void AudioEngine::stop_sound(const std::string& sound_id) {
+void AudioEngine::stop_sound(SoundHandle sound) {
     std::lock_guard<std::mutex> lock(mutex_);
-    playing_sounds_.erase(sound_id);
+    mixer_.stop(sound);
 }
 
 void AudioEngine::stop_music() {
     std::lock_guard<std::mutex> lock(mutex_);
-    current_music_.clear();
+    mixer_.stop(current_music_);
+    current_music_ = NO_SOUND;
+}
+
+void AudioEngine::set_sound_position(SoundHandle sound, const Vector3D& position) {
+    const float point[3] = {position.x, position.y, position.z};
+    std::lock_guard<std::mutex> lock(mutex_);
+    mixer_.set_voice_position(sound, point);
+}
+
+bool AudioEngine::is_playing(SoundHandle sound) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mixer_.is_playing(sound);
+}
+
+size_t AudioEngine::get_playing_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mixer_.playing_count();
 }
 
 void AudioEngine::set_master_volume(float volume) {
     std::lock_guard<std::mutex> lock(mutex_);
     master_volume_ = clamp(volume, 0.0f, 1.0f);
+    mixer_.set_master_gain(master_volume_);
 }
 
 void AudioEngine::set_sfx_volume(float volume) {
     std::lock_guard<std::mutex> lock(mutex_);
     sfx_volume_ = clamp(volume, 0.0f, 1.0f);
+    mixer_.set_bus_gain(AUDIO_BUS_SFX, sfx_volume_);
 }
 
 void AudioEngine::set_music_volume(float volume) {
     std::lock_guard<std::mutex> lock(mutex_);
     music_volume_ = clamp(volume, 0.0f, 1.0f);
+    mixer_.set_bus_gain(AUDIO_BUS_MUSIC, music_volume_);
 }
 
 void AudioEngine::set_listener_position(const Vector3D& position) {
     std::lock_guard<std::mutex> lock(mutex_);
     listener_position_ = position;
+    send_listener();
 }
 
 void AudioEngine::set_listener_orientation(const Vector3D& forward, const Vector3D& up) {
     std::lock_guard<std::mutex> lock(mutex_);
     listener_forward_ = forward;
     listener_up_ = up;
+    send_listener();
+}
+
+void AudioEngine::set_max_real_sounds(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mixer_.set_max_real_voices(count);
+}
+
+void AudioEngine::set_sink(std::unique_ptr<AudioSink> sink) {
+    if (!sink) {
+        throw std::invalid_argument("AudioEngine: sink must not be null");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool running = mixer_.thread_running();
+    mixer_.stop_thread();
+    sink_ = std::move(sink);
+    if (running) mixer_.start_thread(*sink_);
+}
+
+AudioMixer::Stats AudioEngine::get_mixer_stats() const {
+    return mixer_.get_stats();
+}
+
+SoundHandle AudioEngine::play_clip(const std::string& sound_id, const VoiceParams& params) {
+    if (!initialized_) return NO_SOUND;
+    auto it = sounds_.find(sound_id);
+    if (it == sounds_.end()) return NO_SOUND;
+    return mixer_.play(AudioClip{it->second.data(), it->second.size()}, params);
+}
+
+void AudioEngine::send_listener() {
+    const float position[3] = {listener_position_.x, listener_position_.y, listener_position_.z};
+    const float forward[3] = {listener_forward_.x, listener_forward_.y, listener_forward_.z};
+    const float up[3] = {listener_up_.x, listener_up_.y, listener_up_.z};
+    mixer_.set_listener(position, forward, up);
 }
 
 // PhysicsEngine Implementation
-PhysicsEngine::PhysicsEngine() : initialized_(false), gravity_(0.0f, -9.81f, 0.0f) {
+PhysicsEngine::PhysicsEngine()
+    : initialized_(false), gravity_(0.0f, -9.81f, 0.0f), world_(MAX_ENTITIES), thread_pool_(nullptr) {
 }
 
 PhysicsEngine::~PhysicsEngine() {
@@ -626,17 +804,14 @@ PhysicsEngine::~PhysicsEngine() {
 void PhysicsEngine::initialize() {
     if (initialized_) return;
     
-    // Initialize physics system
-    // This would include physics world setup, etc.
-    
     initialized_ = true;
 }
 
 void PhysicsEngine::shutdown() {
     if (!initialized_) return;
     
-    // Cleanup physics resources
-    // This would include physics world cleanup, etc.
+    std::lock_guard<std::mutex> lock(mutex_);
+    world_.clear();
     
     initialized_ = false;
 }
@@ -644,60 +819,81 @@ void PhysicsEngine::shutdown() {
 void PhysicsEngine::update_physics(float delta_time) {
     if (!initialized_) return;
     
-    // Update physics simulation
-    // This would include collision detection, rigid body updates, etc.
+    std::lock_guard<std::mutex> lock(mutex_);
+    const float gravity[3] = {gravity_.x, gravity_.y, gravity_.z};
+    world_.step(delta_time, gravity, thread_pool_);
 }
 
-void PhysicsEngine::add_rigid_body(uint32_t entity_id, const Vector3D& position, const Vector3D& size) {
+void PhysicsEngine::add_rigid_body(uint32_t entity_id, const Vector3D& position, const Vector3D& size, uint32_t flags) {
     if (!initialized_) return;
     
+    RigidBodyDesc desc;
+    desc.position[0] = position.x;
+    desc.position[1] = position.y;
+    desc.position[2] = position.z;
+    desc.half_extents[0] = size.x * 0.5f;
+    desc.half_extents[1] = size.y * 0.5f;
+    desc.half_extents[2] = size.z * 0.5f;
+    desc.flags = flags;
+    
     std::lock_guard<std::mutex> lock(mutex_);
-    // Add rigid body to physics world
-    // This would include physics body creation, etc.
+    world_.add_body(entity_id, desc);
 }
 
 void PhysicsEngine::remove_rigid_body(uint32_t entity_id) {
     std::lock_guard<std::mutex> lock(mutex_);
-    rigid_bodies_.erase(entity_id);
+    world_.remove_body(entity_id);
 }
 
 void PhysicsEngine::set_rigid_body_velocity(uint32_t entity_id, const Vector3D& velocity) {
     if (!initialized_) return;
     
     std::lock_guard<std::mutex> lock(mutex_);
-    // Set rigid body velocity
-    // This would include physics body velocity updates, etc.
+    RigidBodyStore& bodies = world_.get_bodies();
+    const uint32_t index = bodies.index_of(entity_id);
+    if (index == NO_RIGID_BODY || (bodies.flags()[index] & RIGID_BODY_STATIC) != 0) return;
+    
+    const Vec3SoA velocities = bodies.velocities();
+    velocities.x[index] = velocity.x;
+    velocities.y[index] = velocity.y;
+    velocities.z[index] = velocity.z;
 }
 
 Vector3D PhysicsEngine::get_rigid_body_position(uint32_t entity_id) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = rigid_bodies_.find(entity_id);
-    if (it != rigid_bodies_.end()) {
-        // Get position from physics body
-        // This would include physics body position queries, etc.
-        return Vector3D();
-    }
-    return Vector3D();
+    const RigidBodyStore& bodies = world_.get_bodies();
+    const uint32_t index = bodies.index_of(entity_id);
+    if (index == NO_RIGID_BODY) return Vector3D();
+    return Vector3D(bodies.position(0)[index], bodies.position(1)[index], bodies.position(2)[index]);
 }
 
-void PhysicsEngine::add_collision_detector(uint32_t entity_id, std::function<void(uint32_t, uint32_t)> callback) {
+void PhysicsEngine::set_gravity(const Vector3D& gravity) {
     std::lock_guard<std::mutex> lock(mutex_);
-    collision_callbacks_[entity_id] = callback;
+    gravity_ = gravity;
 }
 
-void PhysicsEngine::remove_collision_detector(uint32_t entity_id) {
+Vector3D PhysicsEngine::get_gravity() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    collision_callbacks_.erase(entity_id);
+    return gravity_;
 }
 
-void PhysicsEngine::set_gravity(const Vector3D& gravity) {
+void PhysicsEngine::set_thread_pool(ThreadPool* pool) {
     std::lock_guard<std::mutex> lock(mutex_);
-    gravity_ = gravity;
+    thread_pool_ = pool;
 }
 
-Vector3D PhysicsEngine::get_gravity() const {
+std::vector<Contact> PhysicsEngine::get_contacts() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return gravity_;
+    return world_.get_contacts();
+}
+
+PhysicsWorld::Stats PhysicsEngine::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return world_.get_stats();
+}
+
+const ContactEventBuffer& PhysicsEngine::get_contact_events() const {
+    return world_.get_contact_events();
 }
 
 // AIEngine Implementation
@@ -764,7 +960,8 @@ uint8_t AIEngine::get_difficulty() const {
 // PerformanceEngine Implementation
 PerformanceEngine::PerformanceEngine() 
     : initialized_(false), target_fps_(60), vsync_enabled_(true), multithreading_enabled_(true),
-      next_entity_id_(1) {
+      slab_allocator_(std::make_unique<SlabAllocator>()), sim_steps_counter_(0), sim_dropped_steps_counter_(0),
+      input_deadline_ns_(0), frames_since_memory_report_(0), world_(MAX_ENTITIES, slab_allocator_.get()) {
 }
 
 PerformanceEngine::~PerformanceEngine() {
@@ -782,10 +979,12 @@ void PerformanceEngine::initialize() {
     graphics_engine_ = std::make_unique<GraphicsEngine>();
     audio_engine_ = std::make_unique<AudioEngine>();
     physics_engine_ = std::make_unique<PhysicsEngine>();
+    particle_system_ = std::make_unique<ParticleSystem>(MAX_PARTICLES);
     ai_engine_ = std::make_unique<AIEngine>();
     memory_pool_ = std::make_unique<MemoryPool>(1024, 10000); // 1KB blocks, 10K blocks
     thread_pool_ = std::make_unique<ThreadPool>();
     cache_system_ = std::make_unique<CacheSystem>();
+    async_cache_ = std::make_unique<AsyncCache>(*cache_system_, *thread_pool_);
     analytics_ = std::make_unique<Analytics>();
     
     // Initialize subsystems
@@ -793,6 +992,10 @@ void PerformanceEngine::initialize() {
     audio_engine_->initialize();
     physics_engine_->initialize();
     ai_engine_->initialize();
+    physics_engine_->set_thread_pool(multithreading_enabled_ ? thread_pool_.get() : nullptr);
+    particle_system_->set_thread_pool(multithreading_enabled_ ? thread_pool_.get() : nullptr);
+    
+    build_frame_graph();
     
     initialized_ = true;
 }
@@ -806,16 +1009,22 @@ void PerformanceEngine::shutdown() {
     if (audio_engine_) audio_engine_->shutdown();
     if (graphics_engine_) graphics_engine_->shutdown();
     
-    // Clear systems
+    // Clear systems; pending asset loads finish before the pool and cache go
+    async_cache_.reset();
+    if (cache_system_) cache_system_->set_disk_tier(nullptr);
+    disk_cache_.reset();
     fighting_system_.reset();
     input_system_.reset();
     graphics_engine_.reset();
     audio_engine_.reset();
     physics_engine_.reset();
+    particle_system_.reset();
     ai_engine_.reset();
     memory_pool_.reset();
+    frame_graph_.reset();
     thread_pool_.reset();
     cache_system_.reset();
+    metrics_exporter_.reset();
     analytics_.reset();
     
     initialized_ = false;
@@ -825,16 +1034,30 @@ void PerformanceEngine::update(float delta_time) {
     if (!initialized_) return;
     
     auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // Update all systems
-    if (input_system_) input_system_->process_input_frame();
-    if (fighting_system_) fighting_system_->update_combat(delta_time);
-    if (physics_engine_) physics_engine_->update_physics(delta_time);
-    if (ai_engine_) ai_engine_->update_ai(delta_time);
-    if (audio_engine_) audio_engine_->update_audio();
-    
-    // Update entities
-    update_entities(delta_time);
+    const uint64_t input_now_ns = input_timestamp_now();
+    
+    // Update all systems once per fixed step; independent stages run
+    // concurrently on the pool
+    const uint64_t dropped_before = timestep_.get_dropped_steps();
+    const uint32_t steps = timestep_.advance(delta_time);
+    const float step_seconds = timestep_.get_step_seconds();
+    for (uint32_t step = 0; step < steps; ++step) {
+        // Each step takes the input stamped up to the end of its slice of
+        // the frame; the leftover alpha is time no step has covered yet
+        const double ahead_steps = (steps - 1 - step) + timestep_.get_alpha();
+        const uint64_t ahead_ns = static_cast<uint64_t>(ahead_steps * step_seconds * 1e9);
+        input_deadline_ns_ = input_now_ns > ahead_ns ? input_now_ns - ahead_ns : 0;
+        frame_graph_->execute(step_seconds, multithreading_enabled_ ? thread_pool_.get() : nullptr);
+        
+        if (analytics_) {
+            MetricsRegistry& registry = analytics_->get_registry();
+            const FrameGraph::FrameReport& report = frame_graph_->last_report();
+            for (size_t i = 0; i < report.stages.size(); ++i) {
+                const FrameGraph::StageTiming& timing = report.stages[i];
+                registry.record_seconds(stage_timers_[i], (timing.end_ms - timing.start_ms) / 1000.0);
+            }
+        }
+    }
     
     // Optimize performance
     optimize_performance();
@@ -844,23 +1067,39 @@ void PerformanceEngine::update(float delta_time) {
     auto frame_time = std::chrono::duration<double>(end_time - start_time).count();
     
     if (analytics_) {
+        MetricsRegistry& registry = analytics_->get_registry();
+        registry.add(sim_steps_counter_, steps);
+        registry.add(sim_dropped_steps_counter_, timestep_.get_dropped_steps() - dropped_before);
         analytics_->record_frame_time(frame_time);
-        analytics_->record_entity_count(entities_.size());
+        analytics_->record_entity_count(world_.size());
+        analytics_->record_particle_count(particle_system_->size());
+        const AudioMixer::Stats audio = audio_engine_->get_mixer_stats();
+        analytics_->record_audio(audio.real_voices, audio.virtual_voices, audio.last_block_us);
+        // Merging the allocator's per-thread counters walks every cache
+        // slot, so it is sampled rather than paid every frame
+        if (++frames_since_memory_report_ >= MEMORY_REPORT_FRAMES) {
+            frames_since_memory_report_ = 0;
+            report_memory_usage();
+        }
     }
 }
 
 void PerformanceEngine::render() {
     if (!initialized_ || !graphics_engine_) return;
     
-    // Render all entities
+    // Record all entities
+    graphics_engine_->begin_frame();
     render_entities();
     
+    // Render particles from the last step's streams
+    graphics_engine_->draw_particles(particle_system_->get_render_data());
+    
     // Render frame
     graphics_engine_->render_frame();
     
     // Record draw calls
     if (analytics_) {
-        analytics_->record_draw_calls(graphics_engine_->draw_calls_);
+        analytics_->record_draw_calls(graphics_engine_->get_draw_calls());
     }
 }
 
@@ -885,6 +1124,10 @@ PhysicsEngine& PerformanceEngine::get_physics_engine() {
     return *physics_engine_;
 }
 
+ParticleSystem& PerformanceEngine::get_particle_system() {
+    return *particle_system_;
+}
+
 AIEngine& PerformanceEngine::get_ai_engine() {
     return *ai_engine_;
 }
@@ -893,18 +1136,49 @@ MemoryPool& PerformanceEngine::get_memory_pool() {
     return *memory_pool_;
 }
 
+SlabAllocator& PerformanceEngine::get_slab_allocator() {
+    return *slab_allocator_;
+}
+
 ThreadPool& PerformanceEngine::get_thread_pool() {
     return *thread_pool_;
 }
 
+FrameGraph& PerformanceEngine::get_frame_graph() {
+    return *frame_graph_;
+}
+
 CacheSystem& PerformanceEngine::get_cache_system() {
     return *cache_system_;
 }
 
+AsyncCache& PerformanceEngine::get_async_cache() {
+    return *async_cache_;
+}
+
+void PerformanceEngine::enable_disk_cache(const std::string& directory, size_t max_bytes) {
+    if (!initialized_) return;
+
+    cache_system_->set_disk_tier(nullptr);
+    disk_cache_ = std::make_unique<DiskCache>(directory, max_bytes);
+    cache_system_->set_disk_tier(disk_cache_.get());
+}
+
 Analytics& PerformanceEngine::get_analytics() {
     return *analytics_;
 }
 
+void PerformanceEngine::enable_metrics_export(const MetricsExporter::Options& options) {
+    if (!initialized_) return;
+
+    metrics_exporter_.reset();
+    metrics_exporter_ = std::make_unique<MetricsExporter>(analytics_->get_registry(), options);
+}
+
+MetricsExporter* PerformanceEngine::get_metrics_exporter() {
+    return metrics_exporter_.get();
+}
+
 // Performance monitoring
 PerformanceMetrics PerformanceEngine::get_performance_metrics() const {
     if (analytics_) {
@@ -930,58 +1204,40 @@ void PerformanceEngine::clear_performance_alerts() {
 uint32_t PerformanceEngine::create_entity() {
     std::lock_guard<std::mutex> lock(entity_mutex_);
     
-    uint32_t id;
-    if (!free_entity_ids_.empty()) {
-        id = free_entity_ids_.front();
-        free_entity_ids_.pop();
-    } else {
-        id = next_entity_id_++;
-    }
-    
-    Entity entity;
-    entity.id = id;
-    entity.active = true;
-    entities_.push_back(entity);
+    const SlotHandle handle = world_.create(Entity());
+    Entity* entity = world_.get<Entity>(handle);
+    entity->id = handle;
+    entity->active = true;
     
-    return id;
+    return handle;
 }
 
 void PerformanceEngine::destroy_entity(uint32_t entity_id) {
     std::lock_guard<std::mutex> lock(entity_mutex_);
-    
-    auto it = std::find_if(entities_.begin(), entities_.end(),
-        [entity_id](const Entity& e) { return e.id == entity_id; });
-    
-    if (it != entities_.end()) {
-        it->active = false;
-        free_entity_ids_.push(entity_id);
-    }
+    world_.destroy(entity_id);
 }
 
 Entity* PerformanceEngine::get_entity(uint32_t entity_id) {
     std::lock_guard<std::mutex> lock(entity_mutex_);
-    
-    auto it = std::find_if(entities_.begin(), entities_.end(),
-        [entity_id](const Entity& e) { return e.id == entity_id; });
-    
-    if (it != entities_.end()) {
-        return &(*it);
-    }
-    return nullptr;
+    return world_.get<Entity>(entity_id);
 }
 
 std::vector<Entity*> PerformanceEngine::get_all_entities() {
     std::lock_guard<std::mutex> lock(entity_mutex_);
     
     std::vector<Entity*> result;
-    for (auto& entity : entities_) {
+    world_.each<Entity>([&result](Entity& entity) {
         if (entity.active) {
             result.push_back(&entity);
         }
-    }
+    });
     return result;
 }
 
+EcsWorld& PerformanceEngine::get_world() {
+    return world_;
+}
+
 // Performance optimization
 void PerformanceEngine::set_target_fps(uint32_t fps) {
     target_fps_ = fps;
@@ -993,17 +1249,101 @@ void PerformanceEngine::set_vsync_enabled(bool enabled) {
 
 void PerformanceEngine::set_multithreading_enabled(bool enabled) {
     multithreading_enabled_ = enabled;
+    if (physics_engine_) physics_engine_->set_thread_pool(enabled ? thread_pool_.get() : nullptr);
+    if (particle_system_) particle_system_->set_thread_pool(enabled ? thread_pool_.get() : nullptr);
 }
 
-void PerformanceEngine::update_entities(float delta_time) {
+void PerformanceEngine::set_fixed_timestep(const FixedTimestep::Config& config) {
+    timestep_.configure(config);
+}
+
+const FixedTimestep& PerformanceEngine::get_fixed_timestep() const {
+    return timestep_;
+}
+
+float PerformanceEngine::get_interpolation_alpha() const {
+    return timestep_.get_alpha();
+}
+
+void PerformanceEngine::set_lod_distances(const float distances[MAX_LOD_LEVELS - 1]) {
     std::lock_guard<std::mutex> lock(entity_mutex_);
-    
-    for (auto& entity : entities_) {
-        if (entity.active) {
-            // Update entity logic
-            // This would include position updates, animation updates, etc.
+    culling_.set_lod_distances(distances);
+}
+
+const std::vector<VisibleEntity>& PerformanceEngine::get_visible_entities() const {
+    return visible_entities_;
+}
+
+void PerformanceEngine::build_frame_graph() {
+    frame_graph_ = std::make_unique<FrameGraph>();
+
+    // Declared in the old serial order. Physics and AI only read the combat
+    // state, so they fan out after fighting and join at entities. Audio waits
+    // for physics to sound this step's contacts. Particles only follow combat
+    // and overlap everything after it.
+    frame_graph_->add_stage("input", 0, FRAME_RESOURCE_INPUT, [this](float) {
+        input_system_->process_input_frame(input_deadline_ns_);
+        const uint64_t frame_time_ns = input_system_->get_frame_time_ns();
+        for (const InputEvent& event : input_system_->get_frame_events()) {
+            if (frame_time_ns > event.timestamp_ns) {
+                analytics_->record_input_latency((frame_time_ns - event.timestamp_ns) / 1e9);
+            }
         }
+    });
+    frame_graph_->add_stage("fighting", FRAME_RESOURCE_INPUT, FRAME_RESOURCE_COMBAT, [this](float dt) {
+        fighting_system_->update_combat(dt);
+    });
+    frame_graph_->add_stage("physics", FRAME_RESOURCE_COMBAT, FRAME_RESOURCE_PHYSICS, [this](float dt) {
+        physics_engine_->update_physics(dt);
+    });
+    frame_graph_->add_stage("ai", FRAME_RESOURCE_COMBAT, FRAME_RESOURCE_AI, [this](float dt) {
+        ai_engine_->update_ai(dt);
+    });
+    frame_graph_->add_stage("audio", FRAME_RESOURCE_COMBAT | FRAME_RESOURCE_PHYSICS, FRAME_RESOURCE_AUDIO,
+                            [this](float) {
+        audio_engine_->process_contacts(physics_engine_->get_contact_events());
+        audio_engine_->update_audio();
+    });
+    frame_graph_->add_stage("entities", FRAME_RESOURCE_PHYSICS | FRAME_RESOURCE_AI, FRAME_RESOURCE_ENTITIES,
+                            [this](float dt) { update_entities(dt); });
+    frame_graph_->add_stage("particles", FRAME_RESOURCE_COMBAT, FRAME_RESOURCE_PARTICLES, [this](float dt) {
+        particle_system_->update(dt);
+    });
+
+    // One microsecond histogram per stage, e.g. "stage_physics_us"
+    stage_timers_.clear();
+    for (FrameGraph::StageId id = 0; id < frame_graph_->get_stage_count(); ++id) {
+        stage_timers_.push_back(
+            analytics_->get_registry().register_histogram("stage_" + frame_graph_->get_stage_name(id) + "_us"));
     }
+    sim_steps_counter_ = analytics_->get_registry().register_counter("sim_steps");
+    sim_dropped_steps_counter_ = analytics_->get_registry().register_counter("sim_dropped_steps");
+}
+
+void PerformanceEngine::update_entities(float delta_time) {
+    std::lock_guard<std::mutex> lock(entity_mutex_);
+    
+    // Only entities with a velocity move; the query skips the rest. Each
+    // chunk is gathered into SoA streams, integrated with batch math, and
+    // scattered back. Inactive entities integrate a zero velocity.
+    world_.each_chunk<Entity, VelocityComponent>(
+        [this, delta_time](size_t rows, const SlotHandle*, Entity* entities, VelocityComponent* velocities) {
+            if (motion_scratch_.size() < rows * 6) motion_scratch_.resize(rows * 6);
+            float* streams = motion_scratch_.data();
+            const Vec3SoA position{streams, streams + rows, streams + rows * 2};
+            const Vec3SoA velocity{streams + rows * 3, streams + rows * 4, streams + rows * 5};
+            
+            for (size_t i = 0; i < rows; ++i) {
+                const Vector3D& p = entities[i].transform.position;
+                const Vector3D v = entities[i].active ? velocities[i].linear : Vector3D();
+                position.x[i] = p.x; position.y[i] = p.y; position.z[i] = p.z;
+                velocity.x[i] = v.x; velocity.y[i] = v.y; velocity.z[i] = v.z;
+            }
+            batch_multiply_add(position, position, velocity, delta_time, rows);
+            for (size_t i = 0; i < rows; ++i) {
+                entities[i].transform.position = Vector3D(position.x[i], position.y[i], position.z[i]);
+            }
+        });
 }
 
 void PerformanceEngine::render_entities() {
@@ -1011,16 +1351,76 @@ void PerformanceEngine::render_entities() {
     
     std::lock_guard<std::mutex> lock(entity_mutex_);
     
-    for (const auto& entity : entities_) {
-        if (entity.active) {
-            graphics_engine_->draw_entity(entity);
+    // Only what the last cull kept; each picks its mesh from its LOD chain
+    for (const VisibleEntity& visible : visible_entities_) {
+        const Entity* entity = world_.get<Entity>(visible.entity);
+        if (entity == nullptr || !entity->active) continue;   // destroyed or disabled since
+        
+        RenderableComponent renderable;
+        if (const RenderableComponent* component = world_.get<RenderableComponent>(visible.entity)) {
+            renderable = *component;
+        } else {
+            renderable.mesh = entity->type;
         }
+        const uint32_t lod_count = std::max<uint32_t>(renderable.lod_count, 1);
+        renderable.mesh += std::min(visible.lod, lod_count - 1);
+        graphics_engine_->draw_entity(*entity, renderable);
     }
 }
 
 void PerformanceEngine::optimize_performance() {
-    // Performance optimization logic
-    // This would include LOD management, culling, etc.
+    if (!graphics_engine_) return;
+    
+    std::lock_guard<std::mutex> lock(entity_mutex_);
+    
+    // Test every entity's box where it ended the frame, one batch pass per
+    // chunk. Anything holding get_entity() can move an entity, so knowing
+    // which boxes changed means reading them all, and testing them outright
+    // costs less than pushing them into a CullingBvh. Entities are unit
+    // meshes scaled by their transform; half the scaled diagonal bounds them
+    // at any rotation. Inactive entities get an extent that never passes.
+    const Frustum frustum = graphics_engine_->get_frustum();
+    visible_entities_.clear();
+    size_t active = 0;
+    world_.each_chunk<Entity>([this, &frustum, &active](size_t rows, const SlotHandle* handles,
+                                                         const Entity* entities) {
+        if (culling_scratch_.size() < rows * 6) culling_scratch_.resize(rows * 6);
+        float* streams = culling_scratch_.data();
+        const Vec3SoA center{streams, streams + rows, streams + rows * 2};
+        const Vec3SoA extent{streams + rows * 3, streams + rows * 4, streams + rows * 5};
+        
+        for (size_t i = 0; i < rows; ++i) {
+            const Transform& t = entities[i].transform;
+            const float radius = entities[i].active ? t.scale.magnitude() * 0.5f : -FLT_MAX;
+            center.x[i] = t.position.x; center.y[i] = t.position.y; center.z[i] = t.position.z;
+            extent.x[i] = radius; extent.y[i] = radius; extent.z[i] = radius;
+            active += entities[i].active;
+        }
+        culling_.cull(frustum, handles, center, extent, rows, visible_entities_);
+    });
+    
+    if (analytics_) {
+        analytics_->record_visibility(visible_entities_.size(), active - visible_entities_.size());
+    }
+}
+
+void PerformanceEngine::report_memory_usage() {
+    uint64_t total = 0;
+
+    // Entity chunks live in the slab allocator
+    memory_report_.clear();
+    for (const auto& size_class : slab_allocator_->get_stats()) {
+        memory_report_.push_back({size_class.block_size, size_class.live_bytes, size_class.peak_bytes});
+        total += size_class.live_bytes;
+    }
+    analytics_->record_memory_usage(memory_report_);
+
+    if (memory_pool_) {
+        total += (memory_pool_->get_total_blocks() - memory_pool_->get_available_blocks()) *
+                 memory_pool_->get_block_size();
+    }
+
+    analytics_->record_memory_usage(total);
 }
 
 } // namespace AnimeAggressors
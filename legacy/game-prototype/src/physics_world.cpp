@@ -0,0 +1,530 @@
+/**
+ * Anime Aggressors Performance Engine - Rigid body world
+ */
+
+#include "physics_world.h"
+#include "radix_sort.h"
+#include "stage_timing.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+// Broadphase grid: cells span about CELL_EXTENTS mean body widths on each
+// cross axis, with at least MIN_BODIES_PER_CELL bodies per cell on average.
+constexpr double CELL_EXTENTS = 4.0;
+constexpr size_t MIN_BODIES_PER_CELL = 64;
+constexpr size_t MAX_CELLS_PER_AXIS = 64;
+// Buckets (runs of cells) per pool thread, so a dense region does not
+// serialize the sweep.
+constexpr size_t BUCKETS_PER_THREAD = 4;
+// Switch sweep axis only when another axis spreads bodies this much more.
+constexpr double AXIS_SWITCH_RATIO = 1.5;
+// Insertion sort gives up (and falls back to std::sort) past this many moves
+// per body, e.g. after a mass teleport.
+constexpr size_t MAX_SORT_MOVES_PER_BODY = 8;
+constexpr size_t NARROWPHASE_BLOCK = 64;
+
+// Runs fn(bucket) for every bucket, forking onto `pool` when there is one.
+template<typename F>
+void for_each_bucket(size_t buckets, ThreadPool* pool, F&& fn) {
+    if (pool == nullptr || buckets < 2) {
+        for (size_t bucket = 0; bucket < buckets; ++bucket) fn(bucket);
+        return;
+    }
+    TaskGroup group;
+    for (size_t bucket = 1; bucket < buckets; ++bucket) {
+        pool->submit(group, [&fn, bucket] { fn(bucket); });
+    }
+    fn(0);
+    pool->wait(group);
+}
+
+} // namespace
+
+// RigidBodyStore Implementation
+RigidBodyStore::RigidBodyStore(size_t capacity) {
+    for (int axis = 0; axis < 3; ++axis) {
+        position_[axis].reserve(capacity);
+        velocity_[axis].reserve(capacity);
+        half_extents_[axis].reserve(capacity);
+        min_[axis].reserve(capacity);
+        max_[axis].reserve(capacity);
+    }
+    gravity_scale_.reserve(capacity);
+    flags_.reserve(capacity);
+    entity_ids_.reserve(capacity);
+    index_.reserve(capacity);
+}
+
+uint32_t RigidBodyStore::add(uint32_t entity_id, const RigidBodyDesc& desc) {
+    if (index_.count(entity_id) != 0) {
+        throw std::invalid_argument("RigidBodyStore: entity already has a rigid body");
+    }
+    const uint32_t index = static_cast<uint32_t>(entity_ids_.size());
+    const bool is_static = (desc.flags & RIGID_BODY_STATIC) != 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        position_[axis].push_back(desc.position[axis]);
+        velocity_[axis].push_back(is_static ? 0.0f : desc.velocity[axis]);
+        half_extents_[axis].push_back(desc.half_extents[axis]);
+        min_[axis].push_back(desc.position[axis] - desc.half_extents[axis]);
+        max_[axis].push_back(desc.position[axis] + desc.half_extents[axis]);
+    }
+    gravity_scale_.push_back((desc.flags & (RIGID_BODY_STATIC | RIGID_BODY_NO_GRAVITY)) != 0 ? 0.0f : 1.0f);
+    flags_.push_back(desc.flags);
+    entity_ids_.push_back(entity_id);
+    index_.emplace(entity_id, index);
+    return index;
+}
+
+bool RigidBodyStore::remove(uint32_t entity_id, uint32_t& moved_from) {
+    moved_from = NO_RIGID_BODY;
+    auto it = index_.find(entity_id);
+    if (it == index_.end()) return false;
+
+    const uint32_t index = it->second;
+    const uint32_t last = static_cast<uint32_t>(entity_ids_.size() - 1);
+    index_.erase(it);
+    if (index != last) {
+        auto move_last = [index](auto& stream) {
+            stream[index] = stream.back();
+        };
+        for (int axis = 0; axis < 3; ++axis) {
+            move_last(position_[axis]);
+            move_last(velocity_[axis]);
+            move_last(half_extents_[axis]);
+            move_last(min_[axis]);
+            move_last(max_[axis]);
+        }
+        move_last(gravity_scale_);
+        move_last(flags_);
+        move_last(entity_ids_);
+        index_[entity_ids_[index]] = index;
+        moved_from = last;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        position_[axis].pop_back();
+        velocity_[axis].pop_back();
+        half_extents_[axis].pop_back();
+        min_[axis].pop_back();
+        max_[axis].pop_back();
+    }
+    gravity_scale_.pop_back();
+    flags_.pop_back();
+    entity_ids_.pop_back();
+    return true;
+}
+
+uint32_t RigidBodyStore::index_of(uint32_t entity_id) const {
+    auto it = index_.find(entity_id);
+    return it != index_.end() ? it->second : NO_RIGID_BODY;
+}
+
+void RigidBodyStore::clear() {
+    for (int axis = 0; axis < 3; ++axis) {
+        position_[axis].clear();
+        velocity_[axis].clear();
+        half_extents_[axis].clear();
+        min_[axis].clear();
+        max_[axis].clear();
+    }
+    gravity_scale_.clear();
+    flags_.clear();
+    entity_ids_.clear();
+    index_.clear();
+}
+
+void RigidBodyStore::integrate(float delta_time, const float gravity[3]) {
+    const size_t count = size();
+    for (int axis = 0; axis < 3; ++axis) {
+        batch_multiply_add(velocity_[axis].data(), velocity_[axis].data(), gravity_scale_.data(),
+                           gravity[axis] * delta_time, count);
+    }
+    batch_multiply_add(positions(), positions(), velocities(), delta_time, count);
+    update_bounds();
+}
+
+void RigidBodyStore::update_bounds() {
+    const size_t count = size();
+    const Vec3SoA lower{min_[0].data(), min_[1].data(), min_[2].data()};
+    const Vec3SoA upper{max_[0].data(), max_[1].data(), max_[2].data()};
+    batch_multiply_add(lower, positions(), half_extents(), -1.0f, count);
+    batch_add(upper, positions(), half_extents(), count);
+}
+
+// SweepAndPrune Implementation
+void SweepAndPrune::on_add(uint32_t index) {
+    // Appended out of order; the next sort moves it into place.
+    order_.push_back(index);
+}
+
+void SweepAndPrune::on_remove(uint32_t removed, uint32_t moved_from) {
+    auto it = std::find(order_.begin(), order_.end(), removed);
+    if (it != order_.end()) order_.erase(it);
+    if (moved_from != NO_RIGID_BODY) {
+        std::replace(order_.begin(), order_.end(), moved_from, removed);
+    }
+}
+
+void SweepAndPrune::clear() {
+    order_.clear();
+    for (auto& pairs : bucket_pairs_) pairs.clear();
+    bucket_count_ = 0;
+    needs_full_sort_ = true;
+}
+
+void SweepAndPrune::choose_axis_and_grid(const RigidBodyStore& bodies) {
+    const size_t count = bodies.size();
+    if (count < 2) {
+        cell_count_[0] = cell_count_[1] = 1;
+        return;
+    }
+
+    double variance[3], mean_extent[3];
+    float lowest[3], highest[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        const float* lower = bodies.min(axis);
+        const float* upper = bodies.max(axis);
+        double sum = 0.0, sum_sq = 0.0, extent = 0.0;
+        float low = lower[0], high = upper[0];
+        for (size_t i = 0; i < count; ++i) {
+            const double centre = 0.5 * (static_cast<double>(lower[i]) + upper[i]);
+            sum += centre;
+            sum_sq += centre * centre;
+            extent += upper[i] - lower[i];
+            low = std::min(low, lower[i]);
+            high = std::max(high, upper[i]);
+        }
+        const double mean = sum / count;
+        variance[axis] = sum_sq / count - mean * mean;
+        mean_extent[axis] = extent / count;
+        lowest[axis] = low;
+        highest[axis] = high;
+    }
+
+    const int best = static_cast<int>(std::max_element(variance, variance + 3) - variance);
+    if (best != axis_ && variance[best] > variance[axis_] * AXIS_SWITCH_RATIO) {
+        axis_ = best;
+        needs_full_sort_ = true;
+    }
+
+    // Cells about CELL_EXTENTS mean bodies wide, but never so many that a
+    // cell averages fewer than MIN_BODIES_PER_CELL bodies.
+    for (int cross = 0; cross < 2; ++cross) {
+        const int axis = (axis_ + 1 + cross) % 3;
+        const double range = static_cast<double>(highest[axis]) - lowest[axis];
+        const double cells = mean_extent[axis] > 0.0 ? range / (CELL_EXTENTS * mean_extent[axis]) : 1.0;
+        cell_count_[cross] = static_cast<size_t>(std::clamp(cells, 1.0, static_cast<double>(MAX_CELLS_PER_AXIS)));
+        cell_origin_[cross] = lowest[axis];
+    }
+    const size_t max_cells = std::max<size_t>(1, count / MIN_BODIES_PER_CELL);
+    while (cell_count_[0] * cell_count_[1] > max_cells) {
+        --cell_count_[cell_count_[0] >= cell_count_[1] ? 0 : 1];
+    }
+    for (int cross = 0; cross < 2; ++cross) {
+        const int axis = (axis_ + 1 + cross) % 3;
+        const float range = highest[axis] - lowest[axis];
+        inverse_cell_size_[cross] = range > 0.0f ? cell_count_[cross] / range : 0.0f;
+    }
+}
+
+void SweepAndPrune::sort(const RigidBodyStore& bodies) {
+    const float* key = bodies.min(axis_);
+    const size_t count = order_.size();
+    stats_.swaps = 0;
+    stats_.full_sort = needs_full_sort_;
+
+    if (!needs_full_sort_) {
+        const size_t budget = count * MAX_SORT_MOVES_PER_BODY;
+        for (size_t i = 1; i < count && !stats_.full_sort; ++i) {
+            const uint32_t body = order_[i];
+            const float value = key[body];
+            size_t j = i;
+            for (; j > 0 && key[order_[j - 1]] > value; --j) order_[j] = order_[j - 1];
+            order_[j] = body;
+            stats_.swaps += i - j;
+            if (stats_.swaps > budget) stats_.full_sort = true;
+        }
+    }
+    if (stats_.full_sort) {
+        std::sort(order_.begin(), order_.end(), [key](uint32_t a, uint32_t b) { return key[a] < key[b]; });
+    }
+    needs_full_sort_ = false;
+}
+
+size_t SweepAndPrune::cell_of(int cross, float value) const {
+    const float cell = (value - cell_origin_[cross]) * inverse_cell_size_[cross];
+    if (!(cell > 0.0f)) return 0;
+    return std::min(static_cast<size_t>(cell), cell_count_[cross] - 1);
+}
+
+void SweepAndPrune::bin(const RigidBodyStore& bodies) {
+    const size_t cells = cell_count_[0] * cell_count_[1];
+    if (cells_.size() < cells) cells_.resize(cells);
+    for (size_t cell = 0; cell < cells; ++cell) cells_[cell].clear();
+
+    const int u_axis = (axis_ + 1) % 3;
+    const int v_axis = (axis_ + 2) % 3;
+    const float* lower[3] = {bodies.min(axis_), bodies.min(u_axis), bodies.min(v_axis)};
+    const float* upper[3] = {bodies.max(axis_), bodies.max(u_axis), bodies.max(v_axis)};
+    const uint32_t* flags = bodies.flags();
+    for (uint32_t body : order_) {
+        const CellEntry entry{lower[0][body],
+                              upper[0][body],
+                              {lower[1][body], lower[2][body]},
+                              {upper[1][body], upper[2][body]},
+                              body,
+                              (flags[body] & RIGID_BODY_STATIC) != 0};
+        const size_t u_end = cell_of(0, entry.cross_max[0]);
+        const size_t v_begin = cell_of(1, entry.cross_min[1]);
+        const size_t v_end = cell_of(1, entry.cross_max[1]);
+        for (size_t u = cell_of(0, entry.cross_min[0]); u <= u_end; ++u) {
+            for (size_t v = v_begin; v <= v_end; ++v) {
+                cells_[u * cell_count_[1] + v].push_back(entry);
+            }
+        }
+    }
+}
+
+void SweepAndPrune::sweep(size_t bucket, size_t cell_begin, size_t cell_end) {
+    std::vector<BodyPair>& pairs = bucket_pairs_[bucket];
+    pairs.clear();
+
+    for (size_t cell = cell_begin; cell < cell_end; ++cell) {
+        const CellEntry* members = cells_[cell].data();
+        const size_t size = cells_[cell].size();
+        const size_t cell_u = cell / cell_count_[1];
+        const size_t cell_v = cell % cell_count_[1];
+        for (size_t a = 0; a < size; ++a) {
+            const CellEntry& i = members[a];
+            for (size_t b = a + 1; b < size && members[b].min <= i.max; ++b) {
+                const CellEntry& j = members[b];
+                const bool separated = (j.cross_min[0] > i.cross_max[0]) | (i.cross_min[0] > j.cross_max[0]) |
+                                       (j.cross_min[1] > i.cross_max[1]) | (i.cross_min[1] > j.cross_max[1]);
+                if (separated | (i.is_static & j.is_static)) continue;
+                if (cell_of(0, std::max(i.cross_min[0], j.cross_min[0])) != cell_u ||
+                    cell_of(1, std::max(i.cross_min[1], j.cross_min[1])) != cell_v) {
+                    continue;
+                }
+                pairs.push_back({i.body, j.body});
+            }
+        }
+    }
+}
+
+void SweepAndPrune::update(const RigidBodyStore& bodies, ThreadPool* pool) {
+    choose_axis_and_grid(bodies);
+    sort(bodies);
+    bin(bodies);
+
+    const size_t cells = cell_count_[0] * cell_count_[1];
+    size_t buckets = 1;
+    if (pool != nullptr) {
+        buckets = std::clamp<size_t>(pool->get_thread_count() * BUCKETS_PER_THREAD, 1, cells);
+    }
+    if (bucket_pairs_.size() < buckets) bucket_pairs_.resize(buckets);
+    bucket_count_ = buckets;
+
+    for_each_bucket(buckets, pool, [this, cells, buckets](size_t bucket) {
+        sweep(bucket, cells * bucket / buckets, cells * (bucket + 1) / buckets);
+    });
+
+    stats_.axis = axis_;
+    stats_.cells = cells;
+    stats_.buckets = buckets;
+    stats_.candidate_pairs = 0;
+    for (size_t bucket = 0; bucket < buckets; ++bucket) stats_.candidate_pairs += bucket_pairs_[bucket].size();
+}
+
+// Narrowphase
+void narrowphase(const RigidBodyStore& bodies, const BodyPair* pairs, size_t count, std::vector<Contact>& contacts) {
+    const uint32_t* entity_ids = bodies.entity_ids();
+    float a_min[3][NARROWPHASE_BLOCK], a_max[3][NARROWPHASE_BLOCK];
+    float b_min[3][NARROWPHASE_BLOCK], b_max[3][NARROWPHASE_BLOCK];
+    float overlap[3][NARROWPHASE_BLOCK];
+
+    for (size_t base = 0; base < count; base += NARROWPHASE_BLOCK) {
+        const size_t block = std::min(NARROWPHASE_BLOCK, count - base);
+        for (int axis = 0; axis < 3; ++axis) {
+            const float* lower = bodies.min(axis);
+            const float* upper = bodies.max(axis);
+            for (size_t k = 0; k < block; ++k) {
+                const BodyPair& pair = pairs[base + k];
+                a_min[axis][k] = lower[pair.a];
+                a_max[axis][k] = upper[pair.a];
+                b_min[axis][k] = lower[pair.b];
+                b_max[axis][k] = upper[pair.b];
+            }
+            for (size_t k = 0; k < block; ++k) {
+                overlap[axis][k] = std::min(a_max[axis][k], b_max[axis][k]) - std::max(a_min[axis][k], b_min[axis][k]);
+            }
+        }
+
+        for (size_t k = 0; k < block; ++k) {
+            if (!(overlap[0][k] > 0.0f && overlap[1][k] > 0.0f && overlap[2][k] > 0.0f)) continue;
+
+            int axis = overlap[1][k] < overlap[0][k] ? 1 : 0;
+            if (overlap[2][k] < overlap[axis][k]) axis = 2;
+            const float centre_delta = (b_min[axis][k] + b_max[axis][k]) - (a_min[axis][k] + a_max[axis][k]);
+
+            const BodyPair& pair = pairs[base + k];
+            uint32_t entity_a = entity_ids[pair.a];
+            uint32_t entity_b = entity_ids[pair.b];
+            float sign = centre_delta < 0.0f ? -1.0f : 1.0f;
+            if (entity_b < entity_a) {
+                std::swap(entity_a, entity_b);
+                sign = -sign;
+            }
+            Contact contact{entity_a, entity_b, {0.0f, 0.0f, 0.0f}, {}, overlap[axis][k]};
+            contact.normal[axis] = sign;
+            for (int point_axis = 0; point_axis < 3; ++point_axis) {
+                contact.point[point_axis] =
+                    std::max(a_min[point_axis][k], b_min[point_axis][k]) + overlap[point_axis][k] * 0.5f;
+            }
+            contacts.push_back(contact);
+        }
+    }
+}
+
+// ContactEventBuffer Implementation
+namespace {
+
+uint64_t pair_key(const Contact& contact) {
+    return (static_cast<uint64_t>(contact.entity_a) << 32) | contact.entity_b;
+}
+
+uint64_t event_key(const ContactEvent& event) {
+    return (static_cast<uint64_t>(event.entity) << 32) | event.other;
+}
+
+ContactEvent make_event(const Contact& contact, ContactPhase phase, bool b_side) {
+    const float sign = b_side ? -1.0f : 1.0f;
+    return ContactEvent{b_side ? contact.entity_b : contact.entity_a,
+                        b_side ? contact.entity_a : contact.entity_b,
+                        phase,
+                        {contact.normal[0] * sign, contact.normal[1] * sign, contact.normal[2] * sign},
+                        {contact.point[0], contact.point[1], contact.point[2]},
+                        contact.depth};
+}
+
+} // namespace
+
+void ContactEventBuffer::update(const std::vector<Contact>& contacts) {
+    current_.assign(contacts.begin(), contacts.end());
+    radix_sort(current_, contact_scratch_, pair_key);
+
+    // Merge the two sorted pair lists. The a-side events come out already
+    // in (entity, other) order; the b-sides are sorted separately and the
+    // two runs merged.
+    a_side_.clear();
+    b_side_.clear();
+    counts_[0] = counts_[1] = counts_[2] = 0;
+    size_t before = 0, now = 0;
+    while (before < previous_.size() || now < current_.size()) {
+        ContactPhase phase;
+        const Contact* contact;
+        if (now == current_.size() ||
+            (before < previous_.size() && pair_key(previous_[before]) < pair_key(current_[now]))) {
+            phase = ContactPhase::END;
+            contact = &previous_[before++];
+        } else if (before == previous_.size() || pair_key(current_[now]) < pair_key(previous_[before])) {
+            phase = ContactPhase::BEGIN;
+            contact = &current_[now++];
+        } else {
+            phase = ContactPhase::PERSIST;
+            contact = &current_[now++];
+            ++before;
+        }
+        a_side_.push_back(make_event(*contact, phase, false));
+        b_side_.push_back(make_event(*contact, phase, true));
+        ++counts_[static_cast<size_t>(phase)];
+    }
+    radix_sort(b_side_, event_scratch_, event_key);
+
+    events_.resize(a_side_.size() + b_side_.size());
+    std::merge(a_side_.begin(), a_side_.end(), b_side_.begin(), b_side_.end(), events_.begin(),
+               [](const ContactEvent& lhs, const ContactEvent& rhs) { return event_key(lhs) < event_key(rhs); });
+    previous_.swap(current_);
+}
+
+void ContactEventBuffer::clear() {
+    previous_.clear();
+    current_.clear();
+    events_.clear();
+    counts_[0] = counts_[1] = counts_[2] = 0;
+}
+
+ContactEventRange ContactEventBuffer::get_events_for(uint32_t entity) const {
+    const ContactEvent* first = events_.data();
+    const ContactEvent* last = first + events_.size();
+    first = std::lower_bound(first, last, entity, [](const ContactEvent& event, uint32_t id) { return event.entity < id; });
+    last = std::upper_bound(first, last, entity, [](uint32_t id, const ContactEvent& event) { return id < event.entity; });
+    return {first, last};
+}
+
+// PhysicsWorld Implementation
+PhysicsWorld::PhysicsWorld(size_t capacity) : bodies_(capacity) {
+}
+
+uint32_t PhysicsWorld::add_body(uint32_t entity_id, const RigidBodyDesc& desc) {
+    const uint32_t index = bodies_.add(entity_id, desc);
+    broadphase_.on_add(index);
+    return index;
+}
+
+bool PhysicsWorld::remove_body(uint32_t entity_id) {
+    const uint32_t index = bodies_.index_of(entity_id);
+    uint32_t moved_from;
+    if (!bodies_.remove(entity_id, moved_from)) return false;
+    broadphase_.on_remove(index, moved_from);
+    return true;
+}
+
+void PhysicsWorld::clear() {
+    bodies_.clear();
+    broadphase_.clear();
+    contacts_.clear();
+    contact_events_.clear();
+}
+
+void PhysicsWorld::step(float delta_time, const float gravity[3], ThreadPool* pool) {
+    auto start = std::chrono::steady_clock::now();
+    bodies_.integrate(delta_time, gravity);
+    stats_.integrate_us = elapsed_us(start);
+
+    start = std::chrono::steady_clock::now();
+    broadphase_.update(bodies_, pool);
+    stats_.broadphase_us = elapsed_us(start);
+
+    start = std::chrono::steady_clock::now();
+    const size_t buckets = broadphase_.get_bucket_count();
+    if (bucket_contacts_.size() < buckets) bucket_contacts_.resize(buckets);
+    for_each_bucket(buckets, pool, [this](size_t bucket) {
+        const std::vector<BodyPair>& pairs = broadphase_.get_bucket_pairs(bucket);
+        bucket_contacts_[bucket].clear();
+        narrowphase(bodies_, pairs.data(), pairs.size(), bucket_contacts_[bucket]);
+    });
+    contacts_.clear();
+    for (size_t bucket = 0; bucket < buckets; ++bucket) {
+        contacts_.insert(contacts_.end(), bucket_contacts_[bucket].begin(), bucket_contacts_[bucket].end());
+    }
+    stats_.narrowphase_us = elapsed_us(start);
+
+    start = std::chrono::steady_clock::now();
+    contact_events_.update(contacts_);
+    stats_.contact_events_us = elapsed_us(start);
+
+    const SweepAndPrune::Stats& sweep = broadphase_.get_stats();
+    stats_.bodies = bodies_.size();
+    stats_.candidate_pairs = sweep.candidate_pairs;
+    stats_.contacts = contacts_.size();
+    stats_.sort_swaps = sweep.swaps;
+    stats_.sweep_axis = sweep.axis;
+}
+
+} // namespace AnimeAggressors
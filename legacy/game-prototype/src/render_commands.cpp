@@ -0,0 +1,125 @@
+/**
+ * Anime Aggressors Performance Engine - Render command buffer
+ */
+
+#include "render_commands.h"
+#include "particle_system.h"
+#include "radix_sort.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint64_t DEPTH_MASK = (1u << 24) - 1;
+
+uint64_t depth_bits(float depth) {
+    if (!(depth > 0.0f)) return 0;
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return (bits >> 7) & DEPTH_MASK;   // below the sign bit, so 24 of the 31 magnitude bits
+}
+
+uint8_t key_layer(uint64_t key) {
+    return static_cast<uint8_t>(key >> 56);
+}
+
+// Material and mesh as one 32-bit value, wherever the layer keeps them.
+uint32_t key_material_mesh(uint64_t key) {
+    return key_layer(key) < RENDER_LAYER_TRANSPARENT ? static_cast<uint32_t>(key >> 24)
+                                                      : static_cast<uint32_t>(key);
+}
+
+} // namespace
+
+// HeadlessRenderBackend Implementation
+void HeadlessRenderBackend::begin_frame() {
+    current_ = FrameCounts();
+}
+
+void HeadlessRenderBackend::draw_instanced(const DrawBatch& batch, const RenderInstance*) {
+    ++current_.draw_calls;
+    current_.instances += batch.instance_count;
+}
+
+void HeadlessRenderBackend::draw_particles(const ParticleRenderData& particles) {
+    if (particles.count == 0) return;
+    ++current_.draw_calls;
+    current_.particles += particles.count;
+}
+
+void HeadlessRenderBackend::end_frame() {
+    last_frame_ = current_;
+    ++frames_;
+}
+
+// RenderCommandBuffer Implementation
+RenderCommandBuffer::RenderCommandBuffer(size_t capacity) : sorted_(true) {
+    commands_.reserve(capacity);
+    scratch_.reserve(capacity);
+    instances_.reserve(capacity);
+    sorted_instances_.reserve(capacity);
+}
+
+void RenderCommandBuffer::clear() {
+    commands_.clear();
+    instances_.clear();
+    sorted_instances_.clear();
+    batches_.clear();
+    sorted_ = true;
+}
+
+uint64_t RenderCommandBuffer::make_key(uint8_t layer, uint32_t material, uint32_t mesh, float depth) {
+    const uint64_t material_mesh = (uint64_t(material) << 16) | mesh;
+    if (layer < RENDER_LAYER_TRANSPARENT) {
+        return (uint64_t(layer) << 56) | (material_mesh << 24) | depth_bits(depth);
+    }
+    return (uint64_t(layer) << 56) | ((DEPTH_MASK - depth_bits(depth)) << 32) | material_mesh;
+}
+
+void RenderCommandBuffer::add(uint8_t layer, uint32_t material, uint32_t mesh, float depth,
+                              const RenderInstance& instance) {
+    if (material >= MAX_RENDER_MATERIALS || mesh >= MAX_RENDER_MESHES) {
+        throw std::invalid_argument("RenderCommandBuffer material and mesh ids must fit in 16 bits");
+    }
+    commands_.push_back(RenderCommand{make_key(layer, material, mesh, depth), static_cast<uint32_t>(instances_.size())});
+    instances_.push_back(instance);
+    sorted_ = false;
+}
+
+void RenderCommandBuffer::sort() {
+    if (sorted_) return;
+    radix_sort(commands_, scratch_, [](const RenderCommand& command) { return command.key; });
+
+    sorted_instances_.resize(commands_.size());
+    batches_.clear();
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        const uint64_t key = commands_[i].key;
+        sorted_instances_[i] = instances_[commands_[i].instance];
+
+        const uint8_t layer = key_layer(key);
+        const uint32_t material_mesh = key_material_mesh(key);
+        if (!batches_.empty()) {
+            DrawBatch& last = batches_.back();
+            if (last.layer == layer && ((last.material << 16) | last.mesh) == material_mesh &&
+                last.instance_count < MAX_INSTANCES_PER_DRAW) {
+                ++last.instance_count;
+                continue;
+            }
+        }
+        batches_.push_back(DrawBatch{layer, material_mesh >> 16, material_mesh & 0xFFFF, static_cast<uint32_t>(i), 1});
+    }
+    sorted_ = true;
+}
+
+size_t RenderCommandBuffer::submit(RenderBackend& backend) {
+    sort();
+    for (const DrawBatch& batch : batches_) {
+        backend.draw_instanced(batch, sorted_instances_.data() + batch.first_instance);
+    }
+    return batches_.size();
+}
+
+} // namespace AnimeAggressors
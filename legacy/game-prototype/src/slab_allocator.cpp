@@ -0,0 +1,269 @@
+/**
+ * Anime Aggressors Performance Engine - Size-class slab allocator
+ */
+
+#include "slab_allocator.h"
+#include "thread_slots.h"
+
+#include <algorithm>
+#include <array>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr std::array<uint32_t, SlabAllocator::NUM_SIZE_CLASSES> CLASS_SIZES = {
+    16,    32,    48,    64,    96,    128,   192,   256,   384,   512,   768,   1024,
+    1536,  2048,  3072,  4096,  6144,  8192,  12288, 16384, 24576, 32768, 49152, 65536,
+};
+
+constexpr size_t MAGAZINE_CAPACITY = 64;
+constexpr size_t MIN_SLAB_BYTES = 64 * 1024;
+constexpr size_t SLAB_ALIGNMENT = 64;
+
+// Fewer cached blocks for big classes so idle threads don't pin megabytes.
+constexpr size_t magazine_capacity(size_t size_class) {
+    const size_t by_bytes = (256 * 1024) / CLASS_SIZES[size_class];
+    return std::max<size_t>(4, std::min(MAGAZINE_CAPACITY, by_bytes));
+}
+
+// Dense lookup for requests up to 1KB, indexed by (size - 1) / 16.
+constexpr std::array<uint8_t, 64> build_small_lookup() {
+    std::array<uint8_t, 64> table{};
+    size_t size_class = 0;
+    for (size_t i = 0; i < table.size(); ++i) {
+        const size_t size = (i + 1) * 16;
+        while (CLASS_SIZES[size_class] < size) ++size_class;
+        table[i] = static_cast<uint8_t>(size_class);
+    }
+    return table;
+}
+constexpr std::array<uint8_t, 64> SMALL_LOOKUP = build_small_lookup();
+
+// Thread cache slots, shared by every SlabAllocator in the process.
+using CacheSlots = ThreadSlots<SlabAllocator, SlabAllocator::MAX_THREAD_CACHES>;
+
+void* next_of(void* block) {
+    return *static_cast<void**>(block);
+}
+
+void set_next(void* block, void* next) {
+    *static_cast<void**>(block) = next;
+}
+
+void raise_peak(std::atomic<uint64_t>& peak, uint64_t value) {
+    uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+struct SlabAllocator::ThreadCache {
+    struct Magazine {
+        size_t count = 0;
+        void* items[MAGAZINE_CAPACITY];
+    };
+
+    Magazine magazines[NUM_SIZE_CLASSES];
+    std::atomic<int64_t> live_blocks[NUM_SIZE_CLASSES];
+
+    ThreadCache() {
+        for (auto& live : live_blocks) live.store(0, std::memory_order_relaxed);
+    }
+};
+
+// SlabAllocator Implementation
+SlabAllocator::SlabAllocator() {
+    for (auto& cache : caches_) cache.store(nullptr, std::memory_order_relaxed);
+    for (auto& live : shared_live_blocks_) live.store(0, std::memory_order_relaxed);
+}
+
+SlabAllocator::~SlabAllocator() {
+    for (auto& cache : caches_) {
+        delete cache.load(std::memory_order_acquire);
+    }
+    for (auto& size_class : classes_) {
+        for (void* slab : size_class.slabs) {
+            ::operator delete(slab, std::align_val_t(SLAB_ALIGNMENT));
+        }
+    }
+}
+
+size_t SlabAllocator::size_class_of(size_t size) {
+    if (size == 0) return 0;
+    if (size <= 1024) return SMALL_LOOKUP[(size - 1) / 16];
+    size_t size_class = SMALL_LOOKUP[63];
+    while (size_class < NUM_SIZE_CLASSES && CLASS_SIZES[size_class] < size) ++size_class;
+    return size_class;
+}
+
+size_t SlabAllocator::class_block_size(size_t size_class) {
+    return size_class < NUM_SIZE_CLASSES ? CLASS_SIZES[size_class] : 0;
+}
+
+SlabAllocator::ThreadCache* SlabAllocator::local_cache() {
+    const int slot = CacheSlots::current();
+    if (slot < 0) return nullptr;
+
+    // Only the thread holding this slot ever installs its cache, so a plain
+    // load/store is enough; acquire/release publishes it to get_stats().
+    std::atomic<ThreadCache*>& entry = caches_[static_cast<size_t>(slot)];
+    ThreadCache* cache = entry.load(std::memory_order_acquire);
+    if (cache == nullptr) {
+        cache = new ThreadCache();
+        entry.store(cache, std::memory_order_release);
+    }
+    return cache;
+}
+
+size_t SlabAllocator::refill(size_t size_class, void** out, size_t wanted) {
+    SizeClass& sc = classes_[size_class];
+    const size_t block = CLASS_SIZES[size_class];
+
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    size_t got = 0;
+    while (got < wanted && sc.depot_head != nullptr) {
+        void* head = sc.depot_head;
+        sc.depot_head = next_of(head);
+        --sc.depot_count;
+        out[got++] = head;
+    }
+
+    while (got < wanted) {
+        if (sc.bump + block > sc.bump_end) {
+            const size_t slab_bytes = std::max(MIN_SLAB_BYTES, block * 4);
+            char* slab = static_cast<char*>(::operator new(slab_bytes, std::align_val_t(SLAB_ALIGNMENT)));
+            sc.slabs.push_back(slab);
+            sc.bump = slab;
+            sc.bump_end = slab + slab_bytes;
+            sc.reserved_bytes.fetch_add(slab_bytes, std::memory_order_relaxed);
+        }
+        out[got++] = sc.bump;
+        sc.bump += block;
+    }
+    return got;
+}
+
+void SlabAllocator::flush(size_t size_class, void* const* blocks, size_t count) {
+    if (count == 0) return;
+
+    // Link the batch outside the lock, then splice it in with one store.
+    for (size_t i = 0; i + 1 < count; ++i) set_next(blocks[i], blocks[i + 1]);
+
+    SizeClass& sc = classes_[size_class];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    set_next(blocks[count - 1], sc.depot_head);
+    sc.depot_head = blocks[0];
+    sc.depot_count += count;
+}
+
+void* SlabAllocator::allocate(size_t size) {
+    if (size > MAX_SMALL_SIZE) {
+        void* ptr = ::operator new(size, std::align_val_t(SLAB_ALIGNMENT));
+        const int64_t live = large_live_bytes_.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) +
+                             static_cast<int64_t>(size);
+        raise_peak(large_peak_bytes_, static_cast<uint64_t>(live));
+        return ptr;
+    }
+
+    const size_t size_class = size_class_of(size);
+    ThreadCache* cache = local_cache();
+    if (cache == nullptr) {
+        void* block = nullptr;
+        refill(size_class, &block, 1);
+        shared_live_blocks_[size_class].fetch_add(1, std::memory_order_relaxed);
+        raise_peak(classes_[size_class].peak_bytes, class_live_bytes(size_class));
+        return block;
+    }
+
+    ThreadCache::Magazine& magazine = cache->magazines[size_class];
+    const bool refilled = magazine.count == 0;
+    if (refilled) {
+        magazine.count = refill(size_class, magazine.items, magazine_capacity(size_class) / 2);
+    }
+    owner_add<int64_t>(cache->live_blocks[size_class], 1);
+    if (refilled) {
+        // Sampling the peak only on refill keeps the merge off the fast path.
+        raise_peak(classes_[size_class].peak_bytes, class_live_bytes(size_class));
+    }
+    return magazine.items[--magazine.count];
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) return;
+    if (size > MAX_SMALL_SIZE) {
+        large_live_bytes_.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+        ::operator delete(ptr, std::align_val_t(SLAB_ALIGNMENT));
+        return;
+    }
+
+    const size_t size_class = size_class_of(size);
+    ThreadCache* cache = local_cache();
+    if (cache == nullptr) {
+        flush(size_class, &ptr, 1);
+        shared_live_blocks_[size_class].fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ThreadCache::Magazine& magazine = cache->magazines[size_class];
+    const size_t capacity = magazine_capacity(size_class);
+    if (magazine.count == capacity) {
+        // Return the older half to the depot and keep the recently freed,
+        // cache-warm blocks local.
+        const size_t half = capacity / 2;
+        flush(size_class, magazine.items, half);
+        std::copy(magazine.items + half, magazine.items + capacity, magazine.items);
+        magazine.count -= half;
+    }
+    magazine.items[magazine.count++] = ptr;
+    owner_add<int64_t>(cache->live_blocks[size_class], -1);
+}
+
+uint64_t SlabAllocator::class_live_bytes(size_t size_class) const {
+    int64_t live_blocks = shared_live_blocks_[size_class].load(std::memory_order_relaxed);
+    for (const auto& entry : caches_) {
+        if (const ThreadCache* cache = entry.load(std::memory_order_acquire)) {
+            live_blocks += cache->live_blocks[size_class].load(std::memory_order_relaxed);
+        }
+    }
+    return static_cast<uint64_t>(std::max<int64_t>(0, live_blocks)) * CLASS_SIZES[size_class];
+}
+
+std::vector<SlabAllocator::SizeClassStats> SlabAllocator::get_stats() {
+    std::vector<SizeClassStats> stats;
+    stats.reserve(NUM_SIZE_CLASSES + 1);
+
+    int64_t live_blocks[NUM_SIZE_CLASSES];
+    for (size_t c = 0; c < NUM_SIZE_CLASSES; ++c) {
+        live_blocks[c] = shared_live_blocks_[c].load(std::memory_order_relaxed);
+    }
+    for (auto& entry : caches_) {
+        const ThreadCache* cache = entry.load(std::memory_order_acquire);
+        if (cache == nullptr) continue;
+        for (size_t c = 0; c < NUM_SIZE_CLASSES; ++c) {
+            live_blocks[c] += cache->live_blocks[c].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (size_t c = 0; c < NUM_SIZE_CLASSES; ++c) {
+        // Counters from different threads are read at slightly different
+        // times, so a transient negative sum is clamped.
+        const uint64_t live = static_cast<uint64_t>(std::max<int64_t>(0, live_blocks[c])) * CLASS_SIZES[c];
+        raise_peak(classes_[c].peak_bytes, live);
+        stats.push_back({CLASS_SIZES[c], live, classes_[c].peak_bytes.load(std::memory_order_relaxed),
+                         classes_[c].reserved_bytes.load(std::memory_order_relaxed)});
+    }
+
+    const uint64_t large_live = static_cast<uint64_t>(std::max<int64_t>(0, large_live_bytes_.load(std::memory_order_relaxed)));
+    stats.push_back({0, large_live, large_peak_bytes_.load(std::memory_order_relaxed), large_live});
+    return stats;
+}
+
+uint64_t SlabAllocator::get_live_bytes() {
+    uint64_t total = 0;
+    for (const auto& entry : get_stats()) total += entry.live_bytes;
+    return total;
+}
+
+} // namespace AnimeAggressors
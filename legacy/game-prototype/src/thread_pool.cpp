@@ -0,0 +1,289 @@
+/**
+ * Anime Aggressors Performance Engine - Work-stealing thread pool
+ */
+
+#include "thread_pool.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr size_t NODE_POOL_SIZE = 1 << 16;
+constexpr int SPIN_ROUNDS = 64;
+
+struct WorkerIdentity {
+    const ThreadPool* pool = nullptr;
+    int index = -1;
+};
+
+thread_local WorkerIdentity t_worker;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+uint32_t next_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+// WorkDeque Implementation
+bool ThreadPool::WorkDeque::push(TaskNode* node) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) {
+        return false;
+    }
+    buffer_[b & (CAPACITY - 1)].store(node, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+ThreadPool::TaskNode* ThreadPool::WorkDeque::pop() {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    TaskNode* node = buffer_[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last element: race any thief for it.
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            node = nullptr;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+ThreadPool::TaskNode* ThreadPool::WorkDeque::steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+
+    TaskNode* node = buffer_[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return node;
+}
+
+bool ThreadPool::WorkDeque::empty() const {
+    return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+}
+
+// ThreadPool Implementation
+ThreadPool::ThreadPool(size_t thread_count)
+    : node_pool_(sizeof(TaskNode), NODE_POOL_SIZE, alignof(TaskNode)), stop_(false) {
+    if (thread_count == 0) thread_count = 1;
+
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->steal_seed = static_cast<uint32_t>(i * 2654435761u + 1);
+    }
+    // Start threads only once every deque exists, since workers steal from
+    // each other immediately.
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_[i]->thread = std::thread([this, i] { worker_loop(static_cast<int>(i)); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+ThreadPool::TaskNode* ThreadPool::make_node(Task&& task, TaskGroup* group) {
+    if (stop_.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+    }
+    if (void* block = node_pool_.allocate()) {
+        return new (block) TaskNode{std::move(task), group, true};
+    }
+    return new TaskNode{std::move(task), group, false};
+}
+
+void ThreadPool::push(TaskNode* node) {
+    const int self = current_worker_index();
+    if (self < 0 || !workers_[static_cast<size_t>(self)]->deque.push(node)) {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        injection_.push(node);
+        injected_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        condition_.notify_one();
+    }
+}
+
+ThreadPool::TaskNode* ThreadPool::find_work(int self) {
+    if (self >= 0) {
+        if (TaskNode* node = workers_[static_cast<size_t>(self)]->deque.pop()) {
+            return node;
+        }
+    }
+
+    if (injected_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        if (!injection_.empty()) {
+            TaskNode* node = injection_.front();
+            injection_.pop();
+            injected_.fetch_sub(1, std::memory_order_relaxed);
+            return node;
+        }
+    }
+
+    const size_t count = workers_.size();
+    uint32_t seed_storage = 0x9e3779b9u;
+    uint32_t& seed = self >= 0 ? workers_[static_cast<size_t>(self)]->steal_seed : seed_storage;
+    const size_t start = next_random(seed) % count;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t victim = (start + i) % count;
+        if (static_cast<int>(victim) == self) continue;
+        if (TaskNode* node = workers_[victim]->deque.steal()) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::run(TaskNode* node) {
+    TaskGroup* group = node->group;
+    try {
+        node->task();
+    } catch (...) {
+        // Recorded before the count drops, since the group may be gone after.
+        if (group != nullptr) {
+            std::lock_guard<std::mutex> lock(group->error_mutex_);
+            if (!group->error_) group->error_ = std::current_exception();
+        }
+    }
+
+    if (node->pooled) {
+        node->~TaskNode();
+        node_pool_.deallocate(node);
+    } else {
+        delete node;
+    }
+
+    if (group != nullptr) {
+        group->pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+    const int self = current_worker_index();
+    while (!group.done()) {
+        if (TaskNode* node = find_work(self)) {
+            run(node);
+        } else {
+            cpu_relax();
+        }
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(group.error_mutex_);
+        error = std::exchange(group.error_, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::worker_loop(int index) {
+    t_worker.pool = this;
+    t_worker.index = index;
+
+    while (true) {
+        if (TaskNode* node = find_work(index)) {
+            run(node);
+            continue;
+        }
+
+        // Spin phase: cheap re-polls catch work submitted a few microseconds
+        // later without parking.
+        TaskNode* found = nullptr;
+        for (int spin = 0; spin < SPIN_ROUNDS && found == nullptr; ++spin) {
+            cpu_relax();
+            found = find_work(index);
+        }
+        if (found != nullptr) {
+            run(found);
+            continue;
+        }
+
+        // Park phase. Snapshot the epoch, re-check, then sleep until it moves.
+        const uint64_t epoch = work_epoch_.load(std::memory_order_seq_cst);
+        if (TaskNode* node = find_work(index)) {
+            run(node);
+            continue;
+        }
+        if (stop_.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        condition_.wait(lock, [this, epoch] {
+            return stop_.load(std::memory_order_acquire) ||
+                   work_epoch_.load(std::memory_order_seq_cst) != epoch;
+        });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // Anything still queued after the workers exit was submitted during
+    // shutdown; run it here so futures are not left broken.
+    while (TaskNode* node = find_work(-1)) {
+        run(node);
+    }
+}
+
+size_t ThreadPool::get_thread_count() const {
+    return workers_.size();
+}
+
+int ThreadPool::current_worker_index() const {
+    return t_worker.pool == this ? t_worker.index : -1;
+}
+
+} // namespace AnimeAggressors
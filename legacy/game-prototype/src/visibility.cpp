@@ -0,0 +1,516 @@
+/**
+ * Anime Aggressors Performance Engine - Visibility
+ */
+
+#include "visibility.h"
+#include "stage_timing.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace AnimeAggressors {
+
+namespace {
+
+constexpr uint32_t NO_CULLING_ITEM = UINT32_MAX;
+constexpr uint32_t LOOSE_ITEM = 1u << 31;
+constexpr uint32_t SLOT_INDEX_MASK = SlotMap<uint32_t>::MAX_SLOTS - 1;
+constexpr size_t REBUILD_MIN_CHANGES = 64;    // loose items and tombstones tolerated in any tree
+constexpr float REBUILD_AREA_GROWTH = 2.0f;
+constexpr size_t FULL_REFIT_RATIO = 8;    // marked leaves per node beyond which refit walks every node
+constexpr uint32_t NO_PARENT = UINT32_MAX;
+constexpr float DEFAULT_LOD_DISTANCES[MAX_LOD_LEVELS - 1] = {25.0f, 50.0f, 100.0f};
+
+void cross(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+float dot(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Plane through `point` with normal a * f + b * side, normalized.
+Plane side_plane(const float f[3], float a, const float side[3], float b, const float point[3]) {
+    Plane plane;
+    for (int axis = 0; axis < 3; ++axis) plane.normal[axis] = a * f[axis] + b * side[axis];
+    normalize3(plane.normal);
+    plane.distance = -dot(plane.normal, point);
+    return plane;
+}
+
+// Squares `distances` into `squared` once they check out.
+void set_lod_table(const float distances[MAX_LOD_LEVELS - 1], float squared[MAX_LOD_LEVELS - 1]) {
+    float previous = 0.0f;
+    for (size_t i = 0; i < MAX_LOD_LEVELS - 1; ++i) {
+        if (!(distances[i] > previous)) {
+            throw std::invalid_argument("LOD distances must be positive and ascending");
+        }
+        previous = distances[i];
+    }
+    for (size_t i = 0; i < MAX_LOD_LEVELS - 1; ++i) squared[i] = distances[i] * distances[i];
+}
+
+uint32_t lod_level(const float center[3], const float eye[3], const float squared[MAX_LOD_LEVELS - 1]) {
+    const float dx = center[0] - eye[0];
+    const float dy = center[1] - eye[1];
+    const float dz = center[2] - eye[2];
+    const float distance_squared = dx * dx + dy * dy + dz * dz;
+    uint32_t lod = 0;
+    for (size_t i = 0; i < MAX_LOD_LEVELS - 1; ++i) lod += distance_squared > squared[i];
+    return lod;
+}
+
+float surface_area(const float min[3], const float max[3]) {
+    const float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+} // namespace
+
+Frustum make_frustum(const float eye[3], const float target[3], const float up[3], float fov_y, float aspect,
+                     float near_distance, float far_distance) {
+    if (!(fov_y > 0.0f) || !(fov_y < 3.14159265f) || !(aspect > 0.0f) || !(near_distance > 0.0f) ||
+        !(far_distance > near_distance)) {
+        throw std::invalid_argument("make_frustum needs 0 < fov_y < pi, aspect > 0 and 0 < near < far");
+    }
+
+    float forward[3] = {target[0] - eye[0], target[1] - eye[1], target[2] - eye[2]};
+    if (!normalize3(forward)) {
+        forward[0] = 0.0f; forward[1] = 0.0f; forward[2] = 1.0f;
+    }
+    float right[3];
+    cross(forward, up, right);
+    if (!normalize3(right)) {
+        // Looking along `up`; any perpendicular will do
+        const bool along_x = std::fabs(forward[0]) > 0.9f;
+        const float fallback[3] = {along_x ? 0.0f : 1.0f, along_x ? 1.0f : 0.0f, 0.0f};
+        cross(forward, fallback, right);
+        normalize3(right);
+    }
+    float camera_up[3];
+    cross(right, forward, camera_up);
+
+    Frustum frustum;
+    for (int axis = 0; axis < 3; ++axis) frustum.eye[axis] = eye[axis];
+    const float tan_y = std::tan(fov_y * 0.5f);
+    const float tan_x = tan_y * aspect;
+
+    frustum.planes[0].normal[0] = forward[0];
+    frustum.planes[0].normal[1] = forward[1];
+    frustum.planes[0].normal[2] = forward[2];
+    frustum.planes[0].distance = -(dot(forward, eye) + near_distance);
+    frustum.planes[1].normal[0] = -forward[0];
+    frustum.planes[1].normal[1] = -forward[1];
+    frustum.planes[1].normal[2] = -forward[2];
+    frustum.planes[1].distance = dot(forward, eye) + far_distance;
+    // A point eye + a * forward + b * right is inside the right plane while
+    // b <= a * tan_x, and so on for the others
+    frustum.planes[2] = side_plane(forward, tan_x, right, 1.0f, eye);
+    frustum.planes[3] = side_plane(forward, tan_x, right, -1.0f, eye);
+    frustum.planes[4] = side_plane(forward, tan_y, camera_up, 1.0f, eye);
+    frustum.planes[5] = side_plane(forward, tan_y, camera_up, -1.0f, eye);
+    return frustum;
+}
+
+// CullingBvh Implementation
+CullingBvh::CullingBvh(size_t capacity) : tombstones_(0), escaped_(0), build_area_(0.0f) {
+    for (int axis = 0; axis < 3; ++axis) {
+        leaf_min_[axis].reserve(capacity);
+        leaf_max_[axis].reserve(capacity);
+    }
+    items_.reserve(capacity);
+    slot_items_.reserve(capacity);
+    leaf_items_.reserve(capacity);
+    leaf_nodes_.reserve(capacity);
+    nodes_.reserve(capacity / CULLING_LEAF_SIZE * 2 + 1);
+    set_lod_distances(DEFAULT_LOD_DISTANCES);
+}
+
+uint32_t CullingBvh::find(SlotHandle entity) const {
+    const uint32_t slot = entity & SLOT_INDEX_MASK;
+    if (slot >= slot_items_.size()) return NO_CULLING_ITEM;
+    const uint32_t item = slot_items_[slot];
+    return item != NO_CULLING_ITEM && items_[item].entity == entity ? item : NO_CULLING_ITEM;
+}
+
+void CullingBvh::set_bounds(SlotHandle entity, const float center[3], const float extent[3]) {
+    uint32_t item = find(entity);
+    if (item == NO_CULLING_ITEM) {
+        item = static_cast<uint32_t>(items_.size());
+        const uint32_t slot = entity & SLOT_INDEX_MASK;
+        if (slot >= slot_items_.size()) slot_items_.resize(slot + 1, NO_CULLING_ITEM);
+        slot_items_[slot] = item;
+        Item added{};    // fattened box set when a build takes it in
+        for (int axis = 0; axis < 3; ++axis) {
+            added.center[axis] = center[axis];
+            added.extent[axis] = std::fabs(extent[axis]);
+        }
+        added.entity = entity;
+        added.place = LOOSE_ITEM | static_cast<uint32_t>(loose_.size());
+        items_.push_back(added);
+        loose_.push_back(item);
+        return;
+    }
+
+    Item& box = items_[item];
+    bool escaped = false;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float c = center[axis], e = std::fabs(extent[axis]);
+        box.center[axis] = c;
+        box.extent[axis] = e;
+        escaped |= (c - e < box.fat_min[axis]) | (c + e > box.fat_max[axis]);
+    }
+    if (escaped && !(box.place & LOOSE_ITEM)) {
+        grow_leaf_box(item);
+        dirty_nodes_.push_back(leaf_nodes_[box.place]);
+        ++escaped_;
+    }
+}
+
+void CullingBvh::grow_leaf_box(uint32_t item) {
+    Item& box = items_[item];
+    const uint32_t leaf = box.place;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float c = box.center[axis], e = box.extent[axis];
+        box.fat_min[axis] = leaf_min_[axis][leaf] = c - e - CULLING_MARGIN;
+        box.fat_max[axis] = leaf_max_[axis][leaf] = c + e + CULLING_MARGIN;
+    }
+}
+
+bool CullingBvh::remove(SlotHandle entity) {
+    const uint32_t item = find(entity);
+    if (item == NO_CULLING_ITEM) return false;
+    slot_items_[entity & SLOT_INDEX_MASK] = NO_CULLING_ITEM;
+
+    const uint32_t place = items_[item].place;
+    if (place & LOOSE_ITEM) {
+        const uint32_t moved = loose_.back();
+        loose_[place & ~LOOSE_ITEM] = moved;
+        items_[moved].place = place;
+        loose_.pop_back();
+    } else {
+        // An inside-out box drops out of node bounds on refit and fails every
+        // plane test
+        leaf_items_[place] = NO_CULLING_ITEM;
+        for (int axis = 0; axis < 3; ++axis) {
+            leaf_min_[axis][place] = FLT_MAX;
+            leaf_max_[axis][place] = -FLT_MAX;
+        }
+        dirty_nodes_.push_back(leaf_nodes_[place]);
+        ++tombstones_;
+    }
+
+    // Swap-remove the record and repoint the moved item
+    const uint32_t last = static_cast<uint32_t>(items_.size() - 1);
+    if (item != last) {
+        items_[item] = items_[last];
+        const Item& moved = items_[item];
+        slot_items_[moved.entity & SLOT_INDEX_MASK] = item;
+        if (moved.place & LOOSE_ITEM) {
+            loose_[moved.place & ~LOOSE_ITEM] = item;
+        } else {
+            leaf_items_[moved.place] = item;
+        }
+    }
+    items_.pop_back();
+    return true;
+}
+
+void CullingBvh::clear() {
+    for (int axis = 0; axis < 3; ++axis) {
+        leaf_min_[axis].clear();
+        leaf_max_[axis].clear();
+    }
+    items_.clear();
+    slot_items_.clear();
+    leaf_items_.clear();
+    leaf_nodes_.clear();
+    loose_.clear();
+    nodes_.clear();
+    dirty_nodes_.clear();
+    tombstones_ = 0;
+    escaped_ = 0;
+    build_area_ = 0.0f;
+}
+
+void CullingBvh::set_lod_distances(const float distances[MAX_LOD_LEVELS - 1]) {
+    set_lod_table(distances, lod_distance_squared_);
+}
+
+void CullingBvh::refit() {
+    const auto start = std::chrono::steady_clock::now();
+
+    stats_.nodes_refit = 0;
+    if (loose_.size() + tombstones_ > std::max(REBUILD_MIN_CHANGES, leaf_items_.size() / 4)) {
+        rebuild();
+    } else if (!dirty_nodes_.empty() && !nodes_.empty()) {
+        // A path costs up to the tree's depth, a full pass every node once
+        if (dirty_nodes_.size() * FULL_REFIT_RATIO > nodes_.size()) {
+            refit_nodes();
+        } else {
+            for (uint32_t node : dirty_nodes_) refit_path(node);
+        }
+        if (surface_area(nodes_[0].min, nodes_[0].max) > build_area_ * REBUILD_AREA_GROWTH) rebuild();
+    }
+    dirty_nodes_.clear();
+    stats_.escaped = escaped_;
+    escaped_ = 0;
+
+    stats_.items = items_.size();
+    stats_.nodes = nodes_.size();
+    stats_.refit_us = elapsed_us(start);
+}
+
+void CullingBvh::rebuild() {
+    // Every item goes in: the loose ones join, tombstones are dropped
+    const uint32_t count = static_cast<uint32_t>(items_.size());
+    loose_.clear();
+    dirty_nodes_.clear();
+    tombstones_ = 0;
+    nodes_.clear();
+    leaf_items_.resize(count);
+    leaf_nodes_.resize(count);
+    for (int axis = 0; axis < 3; ++axis) {
+        leaf_min_[axis].resize(count);
+        leaf_max_[axis].resize(count);
+    }
+    build_area_ = 0.0f;
+    ++stats_.rebuilds;
+    if (count == 0) return;
+
+    for (uint32_t i = 0; i < count; ++i) leaf_items_[i] = i;
+    nodes_.push_back(Node{});
+    nodes_[0].parent = NO_PARENT;
+    build_node(0, 0, count);
+
+    for (uint32_t leaf = 0; leaf < count; ++leaf) {
+        items_[leaf_items_[leaf]].place = leaf;
+        grow_leaf_box(leaf_items_[leaf]);
+    }
+    refit_nodes();
+    build_area_ = surface_area(nodes_[0].min, nodes_[0].max);
+}
+
+void CullingBvh::build_node(uint32_t node, uint32_t begin, uint32_t end) {
+    if (end - begin <= CULLING_LEAF_SIZE) {
+        nodes_[node].begin = begin;
+        nodes_[node].end = end;
+        nodes_[node].left = 0;
+        std::fill(leaf_nodes_.begin() + begin, leaf_nodes_.begin() + end, node);
+        return;
+    }
+
+    // Median split along the widest spread of centers
+    float low[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float high[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (uint32_t k = begin; k < end; ++k) {
+        const Item& box = items_[leaf_items_[k]];
+        for (int axis = 0; axis < 3; ++axis) {
+            low[axis] = std::min(low[axis], box.center[axis]);
+            high[axis] = std::max(high[axis], box.center[axis]);
+        }
+    }
+    int split = 0;
+    for (int axis = 1; axis < 3; ++axis) {
+        if (high[axis] - low[axis] > high[split] - low[split]) split = axis;
+    }
+    const uint32_t mid = begin + (end - begin) / 2;
+    const Item* items = items_.data();
+    std::nth_element(leaf_items_.begin() + begin, leaf_items_.begin() + mid, leaf_items_.begin() + end,
+                     [items, split](uint32_t a, uint32_t b) { return items[a].center[split] < items[b].center[split]; });
+
+    const uint32_t left = static_cast<uint32_t>(nodes_.size());
+    nodes_.resize(nodes_.size() + 2);
+    nodes_[node].begin = begin;
+    nodes_[node].end = end;
+    nodes_[node].left = left;
+    nodes_[left].parent = node;
+    nodes_[left + 1].parent = node;
+    build_node(left, begin, mid);
+    build_node(left + 1, mid, end);
+}
+
+void CullingBvh::refit_nodes() {
+    // Children always follow their parent, so one backwards pass suffices
+    for (size_t n = nodes_.size(); n-- > 0;) {
+        Node& node = nodes_[n];
+        for (int axis = 0; axis < 3; ++axis) {
+            float low = FLT_MAX, high = -FLT_MAX;
+            if (node.left == 0) {
+                for (uint32_t leaf = node.begin; leaf < node.end; ++leaf) {
+                    low = std::min(low, leaf_min_[axis][leaf]);
+                    high = std::max(high, leaf_max_[axis][leaf]);
+                }
+            } else {
+                low = std::min(nodes_[node.left].min[axis], nodes_[node.left + 1].min[axis]);
+                high = std::max(nodes_[node.left].max[axis], nodes_[node.left + 1].max[axis]);
+            }
+            node.min[axis] = low;
+            node.max[axis] = high;
+        }
+    }
+    stats_.nodes_refit += nodes_.size();
+}
+
+void CullingBvh::refit_path(uint32_t n) {
+    // Ancestors were computed from the old bounds, so the walk can stop at
+    // the first node whose bounds come out the same
+    while (n != NO_PARENT) {
+        Node& node = nodes_[n];
+        float low[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+        float high[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (int axis = 0; axis < 3; ++axis) {
+            if (node.left == 0) {
+                for (uint32_t leaf = node.begin; leaf < node.end; ++leaf) {
+                    low[axis] = std::min(low[axis], leaf_min_[axis][leaf]);
+                    high[axis] = std::max(high[axis], leaf_max_[axis][leaf]);
+                }
+            } else {
+                low[axis] = std::min(nodes_[node.left].min[axis], nodes_[node.left + 1].min[axis]);
+                high[axis] = std::max(nodes_[node.left].max[axis], nodes_[node.left + 1].max[axis]);
+            }
+        }
+        ++stats_.nodes_refit;
+        bool same = true;
+        for (int axis = 0; axis < 3; ++axis) {
+            same &= node.min[axis] == low[axis] && node.max[axis] == high[axis];
+            node.min[axis] = low[axis];
+            node.max[axis] = high[axis];
+        }
+        if (same) return;
+        n = node.parent;
+    }
+}
+
+void CullingBvh::cull(const Frustum& frustum, std::vector<VisibleEntity>& visible) {
+    const auto start = std::chrono::steady_clock::now();
+    visible.clear();
+    stats_.nodes_visited = 0;
+    stats_.items_tested = 0;
+
+    stack_.clear();
+    if (!nodes_.empty()) stack_.push_back(0);
+    while (!stack_.empty()) {
+        const Node& node = nodes_[stack_.back()];
+        stack_.pop_back();
+        ++stats_.nodes_visited;
+
+        // Halves taken separately so an emptied node's bounds stay finite
+        float center[3], half[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            center[axis] = node.max[axis] * 0.5f + node.min[axis] * 0.5f;
+            half[axis] = node.max[axis] * 0.5f - node.min[axis] * 0.5f;
+        }
+        bool outside = false, inside = true;
+        for (const Plane& plane : frustum.planes) {
+            const float distance = dot(plane.normal, center) + plane.distance;
+            const float reach = std::fabs(plane.normal[0]) * half[0] + std::fabs(plane.normal[1]) * half[1] +
+                                std::fabs(plane.normal[2]) * half[2];
+            if (distance + reach < 0.0f) {
+                outside = true;
+                break;
+            }
+            inside &= distance - reach >= 0.0f;
+        }
+        if (outside) continue;
+
+        if (inside) {
+            accept(node.begin, node.end, frustum.eye, visible);
+        } else if (node.left == 0) {
+            test(leaf_items_.data() + node.begin, node.end - node.begin, frustum, visible);
+        } else {
+            stack_.push_back(node.left + 1);
+            stack_.push_back(node.left);
+        }
+    }
+    test(loose_.data(), loose_.size(), frustum, visible);
+
+    stats_.visible = visible.size();
+    stats_.culled = items_.size() - visible.size();
+    stats_.cull_us = elapsed_us(start);
+}
+
+void CullingBvh::accept(uint32_t begin, uint32_t end, const float eye[3],
+                        std::vector<VisibleEntity>& visible) const {
+    for (uint32_t leaf = begin; leaf < end; ++leaf) {
+        const uint32_t item = leaf_items_[leaf];
+        if (item == NO_CULLING_ITEM) continue;
+        visible.push_back(VisibleEntity{items_[item].entity, lod_for(item, eye)});
+    }
+}
+
+void CullingBvh::test(const uint32_t* items, size_t count, const Frustum& frustum,
+                      std::vector<VisibleEntity>& visible) {
+    if (count == 0) return;
+    if (gathered_.size() < count * 7) gathered_.resize(count * 7);
+    float* streams = gathered_.data();
+    const Vec3SoA center{streams, streams + count, streams + count * 2};
+    const Vec3SoA extent{streams + count * 3, streams + count * 4, streams + count * 5};
+    float* distances = streams + count * 6;
+
+    // Exact boxes, so the result does not depend on the margins; a
+    // tombstone gets one that fails every plane
+    for (size_t k = 0; k < count; ++k) {
+        const uint32_t item = items[k];
+        if (item == NO_CULLING_ITEM) {
+            center.x[k] = center.y[k] = center.z[k] = 0.0f;
+            extent.x[k] = extent.y[k] = extent.z[k] = -FLT_MAX;
+            continue;
+        }
+        const Item& box = items_[item];
+        center.x[k] = box.center[0];
+        center.y[k] = box.center[1];
+        center.z[k] = box.center[2];
+        extent.x[k] = box.extent[0];
+        extent.y[k] = box.extent[1];
+        extent.z[k] = box.extent[2];
+    }
+    batch_plane_distance(distances, frustum.planes, 6, center, extent, count);
+    stats_.items_tested += count;
+
+    // Write every live item, advance past the visible ones
+    size_t out = visible.size();
+    visible.resize(out + count);
+    for (size_t k = 0; k < count; ++k) {
+        if (items[k] == NO_CULLING_ITEM) continue;
+        visible[out] = VisibleEntity{items_[items[k]].entity, lod_for(items[k], frustum.eye)};
+        out += distances[k] >= 0.0f;
+    }
+    visible.resize(out);
+}
+
+uint32_t CullingBvh::lod_for(uint32_t item, const float eye[3]) const {
+    return lod_level(items_[item].center, eye, lod_distance_squared_);
+}
+
+// BatchCuller Implementation
+BatchCuller::BatchCuller() {
+    set_lod_distances(DEFAULT_LOD_DISTANCES);
+}
+
+void BatchCuller::set_lod_distances(const float distances[MAX_LOD_LEVELS - 1]) {
+    set_lod_table(distances, lod_distance_squared_);
+}
+
+size_t BatchCuller::cull(const Frustum& frustum, const SlotHandle* entities, ConstVec3SoA center,
+                         ConstVec3SoA extent, size_t count, std::vector<VisibleEntity>& visible) {
+    if (count == 0) return 0;
+    if (distances_.size() < count) distances_.resize(count);
+    batch_plane_distance(distances_.data(), frustum.planes, 6, center, extent, count);
+
+    // Few boxes pass in a wide scene, so only those get a LOD level
+    const size_t first = visible.size();
+    for (size_t k = 0; k < count; ++k) {
+        if (distances_[k] < 0.0f) continue;
+        const float box_center[3] = {center.x[k], center.y[k], center.z[k]};
+        visible.push_back(VisibleEntity{entities[k], lod_level(box_center, frustum.eye, lod_distance_squared_)});
+    }
+    return visible.size() - first;
+}
+
+} // namespace AnimeAggressors
@@ -0,0 +1,99 @@
+// Spectator relay fan-out under load with in-process fake subscribers.
+//
+//   aa_engine_relay_fanout_bench [subscribers] [frames] [sender_threads]
+//
+// The publisher pushes `frames` simulated states as fast as it can while
+// sender threads drain every subscriber; one in ten subscribers is slow and
+// is only drained on every 32nd pass. Reports encode cost, delivery
+// throughput, frames per batch (a proxy for syscalls saved) and the
+// per-subscriber queue memory high-water mark.
+
+#include "aa/relay.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+  const int subscriber_count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5000;
+  const int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3600;
+  const int sender_threads =
+      argc > 3 ? std::max(1, std::atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+
+  aa::GameConfig config;
+  config.player_count = 4;
+  aa::SpectatorRelay relay;
+
+  std::vector<aa::SpectatorRelay::SubscriberId> ids;
+  ids.reserve(static_cast<size_t>(subscriber_count));
+  for (int i = 0; i < subscriber_count; ++i) ids.push_back(relay.subscribe());
+
+  std::atomic<bool> publishing{true};
+  std::atomic<size_t> peak_subscriber_bytes{0};
+  std::vector<std::thread> senders;
+  for (int t = 0; t < sender_threads; ++t) {
+    senders.emplace_back([&, t] {
+      std::vector<aa::RelayFramePtr> batch;
+      for (uint64_t pass = 0;; ++pass) {
+        const bool done = !publishing.load();
+        size_t drained = 0;
+        for (size_t i = static_cast<size_t>(t); i < ids.size(); i += static_cast<size_t>(sender_threads)) {
+          const bool slow = i % 10 == 0;
+          if (slow && !done && pass % 32 != 0) continue;
+          batch.clear();
+          drained += relay.drain(ids[i], batch);
+        }
+        if (done && drained == 0) return;
+        if (drained == 0) std::this_thread::yield();
+      }
+    });
+  }
+
+  auto state = aa::create_initial_state(config);
+  std::vector<aa::InputFrame> inputs(static_cast<size_t>(config.player_count));
+  double publish_seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; ++f) {
+    for (int p = 0; p < config.player_count; ++p) {
+      aa::InputFrame& in = inputs[static_cast<size_t>(p)];
+      in = aa::InputFrame{};
+      in.player_id = p;
+      in.right = ((f / 45) + p) % 2 == 0;
+      in.left = !in.right;
+      in.jump = (f + p * 11) % 70 == 0;
+    }
+    state = aa::simulate_frame(state, inputs);
+
+    const auto publish_start = std::chrono::steady_clock::now();
+    relay.publish(state);
+    publish_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - publish_start).count();
+
+    if (f % 60 == 0) {
+      for (size_t i = 0; i < ids.size(); i += 10) {
+        peak_subscriber_bytes = std::max(peak_subscriber_bytes.load(), relay.subscriber_memory(ids[i]));
+      }
+    }
+  }
+  publishing = false;
+  for (auto& sender : senders) sender.join();
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  const auto stats = relay.stats();
+  std::printf("subscribers          %d\n", subscriber_count);
+  std::printf("sender_threads       %d\n", sender_threads);
+  std::printf("frames_published     %llu\n", static_cast<unsigned long long>(stats.frames_published));
+  std::printf("encoded_bytes/frame  %.1f\n", static_cast<double>(stats.bytes_encoded) / stats.frames_published);
+  std::printf("publish_us/frame     %.2f\n", publish_seconds * 1e6 / stats.frames_published);
+  std::printf("delivered_frames/s   %.0f\n", stats.frames_delivered / seconds);
+  std::printf("delivered_MB/s       %.2f\n", stats.bytes_delivered / seconds / 1e6);
+  std::printf("frames/batch         %.2f\n",
+              stats.batches ? static_cast<double>(stats.frames_delivered) / stats.batches : 0.0);
+  std::printf("frames_dropped       %llu\n", static_cast<unsigned long long>(stats.frames_dropped));
+  std::printf("resyncs              %llu\n", static_cast<unsigned long long>(stats.resyncs));
+  std::printf("peak_sub_queue_bytes %zu\n", peak_subscriber_bytes.load());
+  return 0;
+}
@@ -0,0 +1,91 @@
+// Seek latency for an hour-long replay across keyframe spacings.
+//
+//   aa_engine_replay_seek_bench [seeks]
+//
+// Records 216000 frames (60 min at SIM_HZ) once per spacing, then seeks to
+// pseudo-random frames and reports file size, mean/max latency and the mean
+// number of simulate_frame calls per seek.
+
+#include "aa/replay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int MATCH_FRAMES = 60 * 60 * aa::SIM_HZ;
+
+uint32_t next_random(uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+std::vector<uint8_t> record_match(const aa::GameConfig& config, int keyframe_interval) {
+  aa::ReplayOptions options;
+  options.keyframe_interval = keyframe_interval;
+  aa::ReplayWriter writer(config, options);
+
+  uint32_t rng = 0x9e3779b9u;
+  auto state = aa::create_initial_state(config);
+  std::vector<aa::InputFrame> inputs(static_cast<size_t>(config.player_count));
+  for (int f = 1; f <= MATCH_FRAMES; ++f) {
+    for (int p = 0; p < config.player_count; ++p) {
+      const uint32_t r = next_random(rng);
+      aa::InputFrame& in = inputs[static_cast<size_t>(p)];
+      in = aa::InputFrame{};
+      in.frame = f;
+      in.player_id = p;
+      in.left = (r & 3u) == 0;
+      in.right = (r & 3u) == 1;
+      in.jump = (r >> 8) % 45 == 0;
+      in.attack = (r >> 16) % 7 == 0;
+    }
+    state = aa::simulate_frame(state, inputs);
+    writer.append_frame(inputs, state);
+  }
+  return writer.finish();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int seeks = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+  aa::GameConfig config;
+  config.player_count = 2;
+
+  std::printf("%-10s %12s %12s %12s %14s\n", "interval", "bytes", "mean_us", "max_us", "mean_sim_frames");
+  for (int interval : {0, 30, 60, 300, 900, 3600}) {
+    auto encoded = record_match(config, interval);
+    const size_t bytes = encoded.size();
+    aa::ReplayReader reader(std::move(encoded));
+
+    uint32_t rng = 12345u;
+    double total_us = 0.0;
+    double max_us = 0.0;
+    long long simulated = 0;
+    // The unindexed replay costs a full resimulation per seek; sample fewer.
+    const int runs = interval == 0 ? std::max(1, seeks / 20) : seeks;
+    for (int i = 0; i < runs; ++i) {
+      const int target = static_cast<int>(next_random(rng) % (MATCH_FRAMES + 1));
+      const auto start = std::chrono::steady_clock::now();
+      const auto state = reader.seek(target);
+      const auto end = std::chrono::steady_clock::now();
+      if (state.frame != target) return 1;
+      const double us = std::chrono::duration<double, std::micro>(end - start).count();
+      total_us += us;
+      max_us = std::max(max_us, us);
+      simulated += reader.last_seek_simulated_frames();
+    }
+
+    std::printf("%-10d %12zu %12.1f %12.1f %14.1f\n", interval, bytes,
+                total_us / runs, max_us, static_cast<double>(simulated) / runs);
+  }
+  return 0;
+}
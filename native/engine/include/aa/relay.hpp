@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "aa/simulation.hpp"
+
+namespace aa {
+
+// Spectator fan-out for one match. Each published GameState is encoded once
+// into an immutable, ref-counted RelayFrame; every subscriber queue holds a
+// shared_ptr to the same bytes, so fan-out cost is one refcount increment per
+// subscriber instead of one encode or copy.
+//
+// Frames are either keyframes (full state) or deltas (players that changed
+// since the previous published frame). A subscriber whose queue backs up past
+// max_queued_frames is dropped to keyframes only: its backlog is discarded
+// and deltas are skipped until the next keyframe resynchronises it.
+
+struct RelayFrame {
+  int frame = 0;
+  bool keyframe = false;
+  std::vector<uint8_t> bytes;
+};
+
+using RelayFramePtr = std::shared_ptr<const RelayFrame>;
+
+struct RelayOptions {
+  int keyframe_interval = 60;       // a full state every N published frames
+  size_t max_queued_frames = 120;   // backlog that marks a subscriber as slow
+  size_t batch_bytes = 1400;        // drain() coalesces frames up to one MTU
+};
+
+struct RelayStats {
+  uint64_t frames_published = 0;
+  uint64_t bytes_encoded = 0;
+  uint64_t frames_enqueued = 0;
+  uint64_t frames_dropped = 0;   // discarded backlog plus skipped deltas
+  uint64_t frames_delivered = 0;
+  uint64_t bytes_delivered = 0;
+  uint64_t batches = 0;          // drain() calls that returned frames
+  uint64_t resyncs = 0;          // times a subscriber fell back to keyframes
+  size_t subscribers = 0;
+};
+
+class SpectatorRelay {
+ public:
+  using SubscriberId = uint32_t;
+
+  explicit SpectatorRelay(const RelayOptions& options = {});
+
+  SubscriberId subscribe();
+  void unsubscribe(SubscriberId id);
+
+  // Encodes `state` once and enqueues it for every subscriber. Called from
+  // the simulation thread; drain() may run concurrently on sender threads.
+  RelayFramePtr publish(const GameState& state);
+
+  // Moves queued frames for `id` into `batch` until their encoded size
+  // reaches batch_bytes (always at least one frame if any are queued), so a
+  // sender can write them with a single gathered syscall. Returns the number
+  // of frames appended.
+  size_t drain(SubscriberId id, std::vector<RelayFramePtr>& batch);
+
+  RelayStats stats() const;
+
+  // Approximate bytes owned by one subscriber's queue bookkeeping, excluding
+  // the shared frame payloads.
+  size_t subscriber_memory(SubscriberId id) const;
+
+ private:
+  struct Subscriber {
+    std::mutex mutex;
+    std::deque<RelayFramePtr> queue;
+    bool awaiting_keyframe = false;
+  };
+
+  RelayOptions options_;
+
+  mutable std::mutex subscribers_mutex_;
+  std::unordered_map<SubscriberId, std::shared_ptr<Subscriber>> subscribers_;
+  SubscriberId next_id_ = 1;
+
+  // Only touched by publish(), which is single-producer.
+  GameState previous_;
+  bool has_previous_ = false;
+  int published_since_keyframe_ = 0;
+  std::vector<std::shared_ptr<Subscriber>> fanout_;  // subscribers snapshot, kept for its capacity
+
+  // Relaxed counters: drain() runs on many sender threads and must not
+  // serialise on a shared stats lock.
+  std::atomic<uint64_t> frames_published_{0};
+  std::atomic<uint64_t> bytes_encoded_{0};
+  std::atomic<uint64_t> frames_enqueued_{0};
+  std::atomic<uint64_t> frames_dropped_{0};
+  std::atomic<uint64_t> frames_delivered_{0};
+  std::atomic<uint64_t> bytes_delivered_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> resyncs_{0};
+
+  RelayFramePtr encode(const GameState& state);
+};
+
+// Rebuilds GameState from relay frames on the spectator side.
+class SpectatorDecoder {
+ public:
+  // Applies a frame; returns false if it is a delta the decoder cannot apply
+  // (no keyframe yet, or a gap since the last applied frame).
+  bool apply(const RelayFrame& frame);
+
+  bool synced() const { return synced_; }
+  const GameState& state() const { return state_; }
+
+ private:
+  GameState state_;
+  bool synced_ = false;
+};
+
+}  // namespace aa
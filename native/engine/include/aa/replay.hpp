@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aa/simulation.hpp"
+
+namespace aa {
+
+// Binary replay container: header, one record per simulated frame, and an
+// optional keyframe index footer. With keyframes every K frames a seek
+// restores the nearest preceding GameState and resimulates at most K frames;
+// with keyframe_interval == 0 every seek replays from frame 0.
+constexpr uint32_t REPLAY_MAGIC = 0x50524141u;        // "AARP"
+constexpr uint32_t REPLAY_INDEX_MAGIC = 0x58444941u;  // "AIDX"
+constexpr uint32_t REPLAY_VERSION = 1;
+
+struct ReplayOptions {
+  // Frames between embedded GameState keyframes. Smaller values make seeks
+  // cheaper and files larger; 0 disables keyframes and the index.
+  int keyframe_interval = 0;
+};
+
+struct ReplayKeyframe {
+  int frame = 0;
+  uint64_t offset = 0;  // byte offset of the keyframe record
+};
+
+class ReplayWriter {
+ public:
+  ReplayWriter(const GameConfig& config, const ReplayOptions& options = {});
+
+  // Appends the inputs that produced `state` (the post-simulate_frame state).
+  // Frames must be appended in order starting at frame 1.
+  void append_frame(const std::vector<InputFrame>& inputs, const GameState& state);
+
+  // Writes the index footer and returns the encoded replay. The writer must
+  // not be appended to afterwards.
+  std::vector<uint8_t> finish();
+
+  int frame_count() const { return frame_count_; }
+
+ private:
+  ReplayOptions options_;
+  std::vector<uint8_t> bytes_;
+  std::vector<ReplayKeyframe> index_;
+  int frame_count_ = 0;
+  bool finished_ = false;
+};
+
+class ReplayReader {
+ public:
+  // Parses the header and index footer; throws std::runtime_error on a
+  // malformed buffer. Replays without a footer (e.g. a recording cut short)
+  // are indexed by a linear scan of the frame records.
+  explicit ReplayReader(std::vector<uint8_t> bytes);
+
+  const GameConfig& config() const { return config_; }
+  int keyframe_interval() const { return keyframe_interval_; }
+  int frame_count() const { return frame_count_; }
+  const std::vector<ReplayKeyframe>& keyframes() const { return index_; }
+
+  // Returns the state after `frame` has been simulated (0 = initial state).
+  GameState seek(int frame);
+
+  // Number of simulate_frame calls performed by the last seek().
+  int last_seek_simulated_frames() const { return last_seek_simulated_; }
+
+ private:
+  std::vector<uint8_t> bytes_;
+  GameConfig config_;
+  int keyframe_interval_ = 0;
+  int frame_count_ = 0;
+  uint64_t records_begin_ = 0;
+  uint64_t records_end_ = 0;
+  std::vector<ReplayKeyframe> index_;
+
+  // Last sought state and the offset of the record that follows it, so
+  // forward scrubbing continues from there instead of the keyframe.
+  GameState cursor_;
+  uint64_t cursor_offset_ = 0;
+  bool has_cursor_ = false;
+  int last_seek_simulated_ = 0;
+
+  void scan_records();
+};
+
+}  // namespace aa
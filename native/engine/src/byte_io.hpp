@@ -0,0 +1,123 @@
+#pragma once
+
+// Little-endian byte encoding shared by the replay and relay wire formats.
+// Internal to aa_engine; not installed with the public headers.
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "aa/simulation.hpp"
+
+namespace aa::detail {
+
+// All multi-byte fields are little-endian regardless of host order so encoded
+// data can be shared between platforms.
+inline void put_u8(std::vector<uint8_t>& out, uint8_t v) { out.push_back(v); }
+
+inline void put_u16(std::vector<uint8_t>& out, uint16_t v) {
+  out.push_back(static_cast<uint8_t>(v));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+inline void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+  for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+inline void put_i32(std::vector<uint8_t>& out, int v) { put_u32(out, static_cast<uint32_t>(v)); }
+
+inline void put_u64(std::vector<uint8_t>& out, uint64_t v) {
+  for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+class ByteCursor {
+ public:
+  ByteCursor(const std::vector<uint8_t>& bytes, uint64_t offset, uint64_t end)
+      : bytes_(bytes), offset_(offset), end_(end) {}
+
+  uint64_t offset() const { return offset_; }
+  bool at_end() const { return offset_ >= end_; }
+  bool has(uint64_t n) const { return offset_ + n <= end_; }
+
+  uint8_t u8() {
+    require(1);
+    return bytes_[offset_++];
+  }
+
+  uint16_t u16() {
+    require(2);
+    const uint16_t v = static_cast<uint16_t>(bytes_[offset_] | (bytes_[offset_ + 1] << 8));
+    offset_ += 2;
+    return v;
+  }
+
+  uint32_t u32() {
+    require(4);
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(bytes_[offset_ + i]) << (8 * i);
+    offset_ += 4;
+    return v;
+  }
+
+  int i32() { return static_cast<int>(u32()); }
+
+  uint64_t u64() {
+    require(8);
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(bytes_[offset_ + i]) << (8 * i);
+    offset_ += 8;
+    return v;
+  }
+
+ private:
+  const std::vector<uint8_t>& bytes_;
+  uint64_t offset_;
+  uint64_t end_;
+
+  void require(uint64_t n) const {
+    if (!has(n)) throw std::runtime_error("aa: truncated record");
+  }
+};
+
+inline void write_player(std::vector<uint8_t>& out, const PlayerState& p) {
+  put_i32(out, p.id);
+  put_i32(out, p.x);
+  put_i32(out, p.y);
+  put_i32(out, p.vx);
+  put_i32(out, p.vy);
+  put_i32(out, p.facing);
+  put_i32(out, p.damage);
+  put_i32(out, p.stocks);
+  put_u8(out, p.on_ground ? 1 : 0);
+}
+
+inline PlayerState read_player(ByteCursor& in) {
+  PlayerState p;
+  p.id = in.i32();
+  p.x = in.i32();
+  p.y = in.i32();
+  p.vx = in.i32();
+  p.vy = in.i32();
+  p.facing = in.i32();
+  p.damage = in.i32();
+  p.stocks = in.i32();
+  p.on_ground = in.u8() != 0;
+  return p;
+}
+
+inline void write_state(std::vector<uint8_t>& out, const GameState& state) {
+  put_i32(out, state.frame);
+  put_u16(out, static_cast<uint16_t>(state.players.size()));
+  for (const auto& p : state.players) write_player(out, p);
+}
+
+inline GameState read_state(ByteCursor& in) {
+  GameState state;
+  state.frame = in.i32();
+  const uint16_t count = in.u16();
+  state.players.resize(count);
+  for (auto& p : state.players) p = read_player(in);
+  return state;
+}
+
+}  // namespace aa::detail
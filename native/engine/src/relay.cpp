@@ -0,0 +1,207 @@
+#include "aa/relay.hpp"
+
+#include <stdexcept>
+
+#include "byte_io.hpp"
+
+namespace aa {
+
+namespace {
+using namespace detail;
+
+constexpr uint8_t FRAME_KEY = 'K';
+constexpr uint8_t FRAME_DELTA = 'D';
+
+bool same_player(const PlayerState& a, const PlayerState& b) {
+  return a.id == b.id && a.x == b.x && a.y == b.y && a.vx == b.vx && a.vy == b.vy &&
+         a.facing == b.facing && a.damage == b.damage && a.stocks == b.stocks &&
+         a.on_ground == b.on_ground;
+}
+
+constexpr auto relaxed = std::memory_order_relaxed;
+}  // namespace
+
+SpectatorRelay::SpectatorRelay(const RelayOptions& options) : options_(options) {
+  if (options_.keyframe_interval <= 0) {
+    throw std::invalid_argument("relay: keyframe_interval must be > 0");
+  }
+}
+
+SpectatorRelay::SubscriberId SpectatorRelay::subscribe() {
+  auto subscriber = std::make_shared<Subscriber>();
+  // New spectators need a full state before any delta makes sense.
+  subscriber->awaiting_keyframe = true;
+
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  const SubscriberId id = next_id_++;
+  subscribers_.emplace(id, std::move(subscriber));
+  return id;
+}
+
+void SpectatorRelay::unsubscribe(SubscriberId id) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  subscribers_.erase(id);
+}
+
+RelayFramePtr SpectatorRelay::encode(const GameState& state) {
+  auto frame = std::make_shared<RelayFrame>();
+  frame->frame = state.frame;
+
+  const bool delta_possible = has_previous_ && previous_.players.size() == state.players.size() &&
+                              published_since_keyframe_ < options_.keyframe_interval;
+  if (delta_possible) {
+    std::vector<uint16_t> changed;
+    for (size_t i = 0; i < state.players.size(); ++i) {
+      if (!same_player(previous_.players[i], state.players[i])) changed.push_back(static_cast<uint16_t>(i));
+    }
+    put_u8(frame->bytes, FRAME_DELTA);
+    put_i32(frame->bytes, state.frame);
+    put_i32(frame->bytes, previous_.frame);
+    put_u16(frame->bytes, static_cast<uint16_t>(changed.size()));
+    for (uint16_t index : changed) {
+      put_u16(frame->bytes, index);
+      write_player(frame->bytes, state.players[index]);
+    }
+    ++published_since_keyframe_;
+  } else {
+    frame->keyframe = true;
+    put_u8(frame->bytes, FRAME_KEY);
+    write_state(frame->bytes, state);
+    published_since_keyframe_ = 1;
+  }
+
+  previous_ = state;
+  has_previous_ = true;
+  return frame;
+}
+
+RelayFramePtr SpectatorRelay::publish(const GameState& state) {
+  RelayFramePtr frame = encode(state);
+  frames_published_.fetch_add(1, relaxed);
+  bytes_encoded_.fetch_add(frame->bytes.size(), relaxed);
+
+  // Snapshot the subscribers so drain() and subscribe() never wait on the
+  // fan-out; one unsubscribed meanwhile just gets a frame nobody reads.
+  {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    fanout_.clear();
+    for (const auto& [id, subscriber] : subscribers_) fanout_.push_back(subscriber);
+  }
+
+  uint64_t enqueued = 0;
+  uint64_t dropped = 0;
+  uint64_t resyncs = 0;
+  for (const auto& subscriber : fanout_) {
+    std::lock_guard<std::mutex> sub_lock(subscriber->mutex);
+    if (!subscriber->awaiting_keyframe && subscriber->queue.size() >= options_.max_queued_frames) {
+      dropped += subscriber->queue.size();
+      subscriber->queue.clear();
+      subscriber->awaiting_keyframe = true;
+      ++resyncs;
+    }
+    if (subscriber->awaiting_keyframe) {
+      if (!frame->keyframe) {
+        ++dropped;
+        continue;
+      }
+      subscriber->awaiting_keyframe = false;
+    }
+    subscriber->queue.push_back(frame);
+    ++enqueued;
+  }
+  fanout_.clear();
+
+  frames_enqueued_.fetch_add(enqueued, relaxed);
+  frames_dropped_.fetch_add(dropped, relaxed);
+  resyncs_.fetch_add(resyncs, relaxed);
+  return frame;
+}
+
+size_t SpectatorRelay::drain(SubscriberId id, std::vector<RelayFramePtr>& batch) {
+  std::shared_ptr<Subscriber> subscriber;
+  {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    auto it = subscribers_.find(id);
+    if (it == subscribers_.end()) return 0;
+    subscriber = it->second;
+  }
+
+  size_t count = 0;
+  size_t bytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(subscriber->mutex);
+    while (!subscriber->queue.empty() && (count == 0 || bytes < options_.batch_bytes)) {
+      const size_t size = subscriber->queue.front()->bytes.size();
+      if (count > 0 && bytes + size > options_.batch_bytes) break;
+      bytes += size;
+      batch.push_back(std::move(subscriber->queue.front()));
+      subscriber->queue.pop_front();
+      ++count;
+    }
+  }
+
+  if (count > 0) {
+    frames_delivered_.fetch_add(count, relaxed);
+    bytes_delivered_.fetch_add(bytes, relaxed);
+    batches_.fetch_add(1, relaxed);
+  }
+  return count;
+}
+
+RelayStats SpectatorRelay::stats() const {
+  RelayStats stats;
+  stats.frames_published = frames_published_.load(relaxed);
+  stats.bytes_encoded = bytes_encoded_.load(relaxed);
+  stats.frames_enqueued = frames_enqueued_.load(relaxed);
+  stats.frames_dropped = frames_dropped_.load(relaxed);
+  stats.frames_delivered = frames_delivered_.load(relaxed);
+  stats.bytes_delivered = bytes_delivered_.load(relaxed);
+  stats.batches = batches_.load(relaxed);
+  stats.resyncs = resyncs_.load(relaxed);
+
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  stats.subscribers = subscribers_.size();
+  return stats;
+}
+
+size_t SpectatorRelay::subscriber_memory(SubscriberId id) const {
+  std::shared_ptr<Subscriber> subscriber;
+  {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    auto it = subscribers_.find(id);
+    if (it == subscribers_.end()) return 0;
+    subscriber = it->second;
+  }
+  std::lock_guard<std::mutex> lock(subscriber->mutex);
+  // Control block + map node are amortised into sizeof(Subscriber); each
+  // queued entry is one shared_ptr.
+  return sizeof(Subscriber) + subscriber->queue.size() * sizeof(RelayFramePtr);
+}
+
+bool SpectatorDecoder::apply(const RelayFrame& frame) {
+  ByteCursor in(frame.bytes, 0, frame.bytes.size());
+  const uint8_t tag = in.u8();
+  if (tag == FRAME_KEY) {
+    state_ = read_state(in);
+    synced_ = true;
+    return true;
+  }
+  if (tag != FRAME_DELTA) throw std::runtime_error("relay: unknown frame type");
+
+  const int frame_number = in.i32();
+  const int base_frame = in.i32();
+  if (!synced_ || state_.frame != base_frame) {
+    synced_ = false;
+    return false;
+  }
+  const uint16_t changed = in.u16();
+  for (uint16_t i = 0; i < changed; ++i) {
+    const uint16_t index = in.u16();
+    if (index >= state_.players.size()) throw std::runtime_error("relay: player index out of range");
+    state_.players[index] = read_player(in);
+  }
+  state_.frame = frame_number;
+  return true;
+}
+
+}  // namespace aa
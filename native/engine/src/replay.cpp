@@ -0,0 +1,211 @@
+#include "aa/replay.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "byte_io.hpp"
+
+namespace aa {
+
+namespace {
+using namespace detail;
+
+constexpr uint8_t RECORD_FRAME = 'F';
+constexpr uint8_t RECORD_KEYFRAME = 'K';
+constexpr size_t HEADER_SIZE = 6 * sizeof(uint32_t);
+constexpr size_t TRAILER_SIZE = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+uint16_t pack_buttons(const InputFrame& in) {
+  const bool bits[] = {in.left, in.right,  in.up,      in.down,   in.jump,
+                       in.attack, in.special, in.shield, in.dodge, in.grab};
+  uint16_t mask = 0;
+  for (int i = 0; i < 10; ++i) {
+    if (bits[i]) mask |= static_cast<uint16_t>(1u << i);
+  }
+  return mask;
+}
+
+void unpack_buttons(uint16_t mask, InputFrame& in) {
+  bool* bits[] = {&in.left,   &in.right,   &in.up,     &in.down,  &in.jump,
+                  &in.attack, &in.special, &in.shield, &in.dodge, &in.grab};
+  for (int i = 0; i < 10; ++i) *bits[i] = (mask >> i) & 1u;
+}
+
+int read_inputs(ByteCursor& in, std::vector<InputFrame>& inputs) {
+  const int frame = in.i32();
+  const uint16_t count = in.u16();
+  inputs.resize(count);
+  for (auto& input : inputs) {
+    input = InputFrame{};
+    input.frame = in.i32();
+    input.player_id = in.i32();
+    unpack_buttons(in.u16(), input);
+  }
+  return frame;
+}
+}  // namespace
+
+ReplayWriter::ReplayWriter(const GameConfig& config, const ReplayOptions& options)
+    : options_(options) {
+  if (options_.keyframe_interval < 0) {
+    throw std::invalid_argument("replay: keyframe_interval must be >= 0");
+  }
+  put_u32(bytes_, REPLAY_MAGIC);
+  put_u32(bytes_, REPLAY_VERSION);
+  put_i32(bytes_, config.player_count);
+  put_i32(bytes_, config.stocks);
+  put_i32(bytes_, config.seed);
+  put_i32(bytes_, options_.keyframe_interval);
+}
+
+void ReplayWriter::append_frame(const std::vector<InputFrame>& inputs, const GameState& state) {
+  if (finished_) throw std::logic_error("replay: append after finish");
+  if (state.frame != frame_count_ + 1) throw std::logic_error("replay: frames must be appended in order");
+
+  put_u8(bytes_, RECORD_FRAME);
+  put_i32(bytes_, state.frame);
+  put_u16(bytes_, static_cast<uint16_t>(inputs.size()));
+  for (const auto& input : inputs) {
+    put_i32(bytes_, input.frame);
+    put_i32(bytes_, input.player_id);
+    put_u16(bytes_, pack_buttons(input));
+  }
+  frame_count_ = state.frame;
+
+  if (options_.keyframe_interval > 0 && state.frame % options_.keyframe_interval == 0) {
+    index_.push_back({state.frame, bytes_.size()});
+    put_u8(bytes_, RECORD_KEYFRAME);
+    write_state(bytes_, state);
+  }
+}
+
+std::vector<uint8_t> ReplayWriter::finish() {
+  if (finished_) throw std::logic_error("replay: finish called twice");
+  finished_ = true;
+
+  const uint64_t index_offset = bytes_.size();
+  put_u32(bytes_, static_cast<uint32_t>(index_.size()));
+  for (const auto& keyframe : index_) {
+    put_i32(bytes_, keyframe.frame);
+    put_u64(bytes_, keyframe.offset);
+  }
+  put_u64(bytes_, index_offset);
+  put_i32(bytes_, frame_count_);
+  put_u32(bytes_, REPLAY_INDEX_MAGIC);
+  return std::move(bytes_);
+}
+
+ReplayReader::ReplayReader(std::vector<uint8_t> bytes) : bytes_(std::move(bytes)) {
+  ByteCursor header(bytes_, 0, bytes_.size());
+  if (!header.has(HEADER_SIZE) || header.u32() != REPLAY_MAGIC) {
+    throw std::runtime_error("replay: bad magic");
+  }
+  if (header.u32() != REPLAY_VERSION) throw std::runtime_error("replay: unsupported version");
+  config_.player_count = header.i32();
+  config_.stocks = header.i32();
+  config_.seed = header.i32();
+  keyframe_interval_ = header.i32();
+  records_begin_ = header.offset();
+
+  if (bytes_.size() >= HEADER_SIZE + TRAILER_SIZE) {
+    ByteCursor trailer(bytes_, bytes_.size() - TRAILER_SIZE, bytes_.size());
+    const uint64_t index_offset = trailer.u64();
+    const int frame_count = trailer.i32();
+    if (trailer.u32() == REPLAY_INDEX_MAGIC && index_offset >= records_begin_ &&
+        index_offset <= bytes_.size() - TRAILER_SIZE) {
+      ByteCursor index(bytes_, index_offset, bytes_.size() - TRAILER_SIZE);
+      const uint32_t count = index.u32();
+      index_.reserve(count);
+      for (uint32_t i = 0; i < count; ++i) {
+        ReplayKeyframe keyframe;
+        keyframe.frame = index.i32();
+        keyframe.offset = index.u64();
+        if (keyframe.offset < records_begin_ || keyframe.offset >= index_offset) {
+          throw std::runtime_error("replay: keyframe offset out of range");
+        }
+        index_.push_back(keyframe);
+      }
+      records_end_ = index_offset;
+      frame_count_ = frame_count;
+      return;
+    }
+  }
+
+  scan_records();
+}
+
+void ReplayReader::scan_records() {
+  ByteCursor in(bytes_, records_begin_, bytes_.size());
+  std::vector<InputFrame> scratch;
+  records_end_ = records_begin_;
+  try {
+    while (!in.at_end()) {
+      const uint64_t record_offset = in.offset();
+      const uint8_t tag = in.u8();
+      if (tag == RECORD_FRAME) {
+        frame_count_ = read_inputs(in, scratch);
+      } else if (tag == RECORD_KEYFRAME) {
+        const GameState state = read_state(in);
+        index_.push_back({state.frame, record_offset});
+      } else {
+        break;
+      }
+      records_end_ = in.offset();
+    }
+  } catch (const std::runtime_error&) {
+    // A partially written trailing record is dropped; everything before it
+    // is still seekable.
+  }
+  // A keyframe after the last complete frame record cannot be reached.
+  while (!index_.empty() && index_.back().offset >= records_end_) index_.pop_back();
+}
+
+GameState ReplayReader::seek(int frame) {
+  if (frame < 0 || frame > frame_count_) throw std::out_of_range("replay: seek past end");
+
+  const auto next = std::upper_bound(index_.begin(), index_.end(), frame,
+                                     [](int f, const ReplayKeyframe& k) { return f < k.frame; });
+
+  GameState state;
+  uint64_t offset = records_begin_;
+  if (next != index_.begin()) {
+    const ReplayKeyframe& keyframe = *(next - 1);
+    ByteCursor in(bytes_, keyframe.offset, records_end_);
+    if (in.u8() != RECORD_KEYFRAME) throw std::runtime_error("replay: index points at non-keyframe");
+    state = read_state(in);
+    offset = in.offset();
+  } else {
+    state = create_initial_state(config_);
+  }
+
+  // Resume from the previous seek when it lies between the keyframe and the
+  // target, which keeps frame-by-frame scrubbing at one simulate_frame call.
+  if (has_cursor_ && cursor_.frame <= frame && cursor_.frame >= state.frame) {
+    state = cursor_;
+    offset = cursor_offset_;
+  }
+
+  ByteCursor in(bytes_, offset, records_end_);
+  std::vector<InputFrame> inputs;
+  int simulated = 0;
+  while (state.frame < frame) {
+    const uint8_t tag = in.u8();
+    if (tag == RECORD_KEYFRAME) {
+      read_state(in);
+      continue;
+    }
+    if (tag != RECORD_FRAME) throw std::runtime_error("replay: unknown record");
+    read_inputs(in, inputs);
+    state = simulate_frame(state, inputs);
+    ++simulated;
+  }
+
+  last_seek_simulated_ = simulated;
+  cursor_ = state;
+  cursor_offset_ = in.offset();
+  has_cursor_ = true;
+  return state;
+}
+
+}  // namespace aa
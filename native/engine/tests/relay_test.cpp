@@ -0,0 +1,89 @@
+// The checks below must also run in Release builds, which define NDEBUG.
+#undef NDEBUG
+
+#include "aa/relay.hpp"
+
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+std::vector<aa::InputFrame> scripted_inputs(int frame) {
+  std::vector<aa::InputFrame> inputs;
+  aa::InputFrame in;
+  in.frame = frame;
+  in.player_id = 0;
+  in.right = (frame / 30) % 2 == 0;
+  in.jump = frame % 50 == 0;
+  inputs.push_back(in);
+  return inputs;
+}
+
+}  // namespace
+
+int main() {
+  aa::GameConfig config;
+  config.player_count = 2;
+
+  aa::RelayOptions options;
+  options.keyframe_interval = 20;
+  options.max_queued_frames = 16;
+  options.batch_bytes = 256;
+  aa::SpectatorRelay relay(options);
+
+  const auto fast = relay.subscribe();
+  const auto slow = relay.subscribe();
+  aa::SpectatorDecoder fast_decoder;
+  aa::SpectatorDecoder slow_decoder;
+
+  auto state = aa::create_initial_state(config);
+  std::vector<aa::RelayFramePtr> batch;
+  for (int f = 0; f < 200; ++f) {
+    if (f > 0) state = aa::simulate_frame(state, scripted_inputs(f));
+    const aa::RelayFramePtr published = relay.publish(state);
+    // Encoded once: the relay's handle plus one per subscriber queue.
+    assert(published.use_count() >= 2);
+
+    batch.clear();
+    while (relay.drain(fast, batch) > 0) {
+    }
+    for (const auto& frame : batch) {
+      const bool applied = fast_decoder.apply(*frame);
+      assert(applied);
+    }
+    assert(aa::hash_state(fast_decoder.state()) == aa::hash_state(state));
+
+    // The slow spectator only reads every 50 frames and falls behind.
+    if (f % 50 == 49) {
+      batch.clear();
+      while (relay.drain(slow, batch) > 0) {
+      }
+      for (const auto& frame : batch) slow_decoder.apply(*frame);
+    }
+  }
+
+  // Backlog never grows past the limit for the slow spectator.
+  assert(relay.subscriber_memory(slow) <= relay.subscriber_memory(fast) + 16 * sizeof(aa::RelayFramePtr));
+
+  const auto stats = relay.stats();
+  assert(stats.frames_published == 200);
+  assert(stats.resyncs > 0);
+  assert(stats.frames_dropped > 0);
+  assert(stats.subscribers == 2);
+  // Deltas are far smaller than keyframes, so batching delivers several
+  // frames per drain.
+  assert(stats.batches < stats.frames_delivered);
+
+  // After resyncing on a keyframe the slow decoder tracks the match again.
+  assert(slow_decoder.synced());
+  assert(slow_decoder.state().frame <= state.frame);
+
+  relay.unsubscribe(slow);
+  assert(relay.stats().subscribers == 1);
+  const size_t drained = relay.drain(slow, batch);
+  assert(drained == 0);
+
+  std::cout << "native spectator relay ok delivered=" << stats.frames_delivered
+            << " dropped=" << stats.frames_dropped << std::endl;
+  return 0;
+}
@@ -0,0 +1,109 @@
+// The checks below must also run in Release builds, which define NDEBUG.
+#undef NDEBUG
+
+#include "aa/replay.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+std::vector<aa::InputFrame> scripted_inputs(int frame) {
+  std::vector<aa::InputFrame> inputs;
+  for (int player = 0; player < 2; ++player) {
+    aa::InputFrame in;
+    in.frame = frame;
+    in.player_id = player;
+    in.left = (frame / 40 + player) % 3 == 0;
+    in.right = (frame / 40 + player) % 3 == 1;
+    in.jump = (frame + player * 17) % 90 == 0;
+    inputs.push_back(in);
+  }
+  return inputs;
+}
+
+std::vector<uint8_t> record(const aa::GameConfig& config, int frames, int keyframe_interval,
+                            std::vector<std::string>& hashes) {
+  aa::ReplayOptions options;
+  options.keyframe_interval = keyframe_interval;
+  aa::ReplayWriter writer(config, options);
+
+  auto state = aa::create_initial_state(config);
+  hashes.assign(1, aa::hash_state(state));
+  for (int f = 1; f <= frames; ++f) {
+    const auto inputs = scripted_inputs(f);
+    state = aa::simulate_frame(state, inputs);
+    writer.append_frame(inputs, state);
+    hashes.push_back(aa::hash_state(state));
+  }
+  return writer.finish();
+}
+
+}  // namespace
+
+int main() {
+  aa::GameConfig config;
+  config.player_count = 2;
+  config.stocks = 3;
+
+  constexpr int FRAMES = 1000;
+  constexpr int K = 64;
+
+  std::vector<std::string> hashes;
+  const auto keyed = record(config, FRAMES, K, hashes);
+  aa::ReplayReader reader(keyed);
+  assert(reader.frame_count() == FRAMES);
+  assert(reader.keyframe_interval() == K);
+  assert(reader.keyframes().size() == FRAMES / K);
+
+  // Random-order seeks land on the recorded state and never resimulate more
+  // than one keyframe interval.
+  const int targets[] = {0, 999, 1, 640, 63, 64, 65, 1000, 500, 128, 127, 7};
+  for (int target : targets) {
+    const auto state = reader.seek(target);
+    assert(state.frame == target);
+    assert(aa::hash_state(state) == hashes[static_cast<size_t>(target)]);
+    assert(reader.last_seek_simulated_frames() < K);
+  }
+
+  // Stepping forward one frame at a time continues from the previous seek.
+  reader.seek(300);
+  for (int f = 301; f <= 310; ++f) {
+    const auto state = reader.seek(f);
+    assert(aa::hash_state(state) == hashes[static_cast<size_t>(f)]);
+    assert(reader.last_seek_simulated_frames() == 1);
+  }
+
+  // Without keyframes every seek replays from frame 0, and the file is smaller.
+  std::vector<std::string> plain_hashes;
+  const auto plain = record(config, FRAMES, 0, plain_hashes);
+  assert(plain.size() < keyed.size());
+  aa::ReplayReader plain_reader(plain);
+  assert(plain_reader.keyframes().empty());
+  const auto plain_state = plain_reader.seek(777);
+  assert(aa::hash_state(plain_state) == hashes[777]);
+  assert(plain_reader.last_seek_simulated_frames() == 777);
+
+  // A recording cut off before the footer is still seekable up to the last
+  // complete frame.
+  std::vector<uint8_t> truncated(keyed.begin(), keyed.begin() + static_cast<long>(keyed.size() / 2));
+  aa::ReplayReader truncated_reader(truncated);
+  assert(truncated_reader.frame_count() > 0 && truncated_reader.frame_count() < FRAMES);
+  const int last = truncated_reader.frame_count();
+  const auto truncated_state = truncated_reader.seek(last);
+  assert(aa::hash_state(truncated_state) == hashes[static_cast<size_t>(last)]);
+  assert(truncated_reader.last_seek_simulated_frames() < K);
+
+  bool threw = false;
+  try {
+    reader.seek(FRAMES + 1);
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  assert(threw);
+
+  std::cout << "native replay seek ok keyed_bytes=" << keyed.size() << " plain_bytes=" << plain.size()
+            << std::endl;
+  return 0;
+}